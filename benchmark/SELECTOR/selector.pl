@@ -0,0 +1,309 @@
+#!/usr/bin/perl
+
+#
+# Measures the cost of issue selection versus the scheduler window size.
+#
+# Each workload is simulated in the Simulation mode with the @WindowCapacity
+# of all schedulers set to each size in the sweep. The capacities of the
+# InorderList, the checkpoints, the op array and the register files are
+# enlarged with a window so that the window can be filled.
+# The following metrics are written to a CSV file:
+#   scheduler_ticks_per_cycle : host ticks spent in the Evaluate phase of
+#                 all schedulers (wake-up and selection) per simulated cycle,
+#                 which is measured by HostProfiler
+#   ticks_per_cycle : host ticks of the whole simulation per simulated cycle
+# When a reference binary is given, it is measured in the same way and the
+# ratio 'current / reference' of scheduler_ticks_per_cycle is written.
+#
+
+use strict;
+use FindBin;
+use File::Basename;
+use File::Path;
+use File::Spec;
+
+my @g_columns = (
+	'workload', 'window', 'cycles',
+	'scheduler_ticks_per_cycle', 'ticks_per_cycle',
+	'reference_scheduler_ticks_per_cycle', 'reference_ticks_per_cycle', 'ratio'
+);
+
+
+#
+# --- Exception & terminating
+#
+
+sub Throw
+{
+	print STDERR shift;
+	exit 1;
+}
+
+
+#
+# --- Option
+#
+
+sub Initialize()
+{
+	my $option =
+	{
+		'onikiri'   => "$FindBin::Bin/../../project/gcc/onikiri2/a.out",
+		'reference' => '',
+		'param'     => "$FindBin::Bin/../THROUGHPUT/param.xml",
+		'workloads' => "$FindBin::Bin/../THROUGHPUT/workloads.txt",
+		'output'    => "$FindBin::Bin/result.csv",
+		'work'      => "$FindBin::Bin/tmp",
+		'windows'   => [ 16, 32, 64, 128, 256, 512 ],
+		'insns'     => 1000000,
+	};
+
+	foreach my $arg (@ARGV){
+		if($arg =~ /^--onikiri=(.+)$/){
+			$option->{'onikiri'} = $1;
+		}
+		elsif($arg =~ /^--reference=(.+)$/){
+			$option->{'reference'} = $1;
+		}
+		elsif($arg =~ /^--workloads=(.+)$/){
+			$option->{'workloads'} = $1;
+		}
+		elsif($arg =~ /^--output=(.+)$/){
+			$option->{'output'} = $1;
+		}
+		elsif($arg =~ /^--windows=([0-9,]+)$/){
+			$option->{'windows'} = [ split(/,/, $1) ];
+		}
+		elsif($arg =~ /^--insns=([0-9]+)$/){
+			$option->{'insns'} = $1;
+		}
+		else{
+			Throw(
+				"Usage: perl selector.pl [--onikiri=path] [--reference=path] [--workloads=file]\n" .
+				"    [--output=file] [--windows=16,32,...] [--insns=n]\n"
+			);
+		}
+	}
+
+	foreach my $binary ($option->{'onikiri'}, $option->{'reference'}){
+		if( $binary ne '' && !-x $binary ){
+			Throw("'$binary' is not found. Build onikiri2 first.\n");
+		}
+	}
+	return $option;
+}
+
+sub LoadWorkloads($)
+{
+	my $fileName = shift;
+	my @workloads;
+
+	open(my $file, '<', $fileName) or Throw("Cannot open '$fileName'.\n");
+	while(my $line = <$file>){
+		$line =~ s/#.*$//;
+		$line =~ s/^\s+|\s+$//g;
+		next if($line eq '');
+
+		my @fields = split(/\s+/, $line);
+		if($#fields != 4){
+			Throw("Invalid workload '$line' in '$fileName'.\n");
+		}
+		my $command = File::Spec->rel2abs($fields[2], dirname($fileName));
+		if( !-f $command ){
+			Throw("'$command' is not found. Build the workloads first.\n");
+		}
+		push(@workloads, {
+			'name'    => $fields[0],
+			'arch'    => $fields[1],
+			'command' => $command,
+			'skip'    => $fields[3],
+		});
+	}
+	close($file);
+	return @workloads;
+}
+
+
+#
+# --- Running
+#
+
+# Writes parameters of a window size to 'fileName'.
+# Elements in 'Parameter' overwrite those in DefaultParam.xml in order,
+# so the four schedulers are listed in the same order as DefaultParam.xml.
+sub WriteWindowParam($$)
+{
+	my ($fileName, $window) = @_;
+	my $capacity = $window * 2 > 128 ? $window * 2 : 128;
+	my $opArray  = $capacity + 32;
+
+	open(my $file, '>', $fileName) or Throw("Cannot open '$fileName'.\n");
+	print $file <<"END";
+<?xml version='1.0' encoding='utf-8'?>
+<Session>
+  <Simulator>
+    <Configurations>
+      <DefaultConfiguration>
+        <Parameter>
+          <CheckpointMaster Capacity = "$capacity" />
+          <Core OpArrayCapacity = "$opArray" />
+          <InorderList Capacity = "$capacity" />
+          <Scheduler WindowCapacity = "$window" />
+          <Scheduler WindowCapacity = "$window" />
+          <Scheduler WindowCapacity = "$window" />
+          <Scheduler WindowCapacity = "$window" />
+          <RegisterFile Capacity = "$capacity,$capacity,4098,8" />
+        </Parameter>
+      </DefaultConfiguration>
+    </Configurations>
+  </Simulator>
+</Session>
+END
+	close($file);
+}
+
+# Returns a list of hashes of attributes of elements named 'name'.
+sub GetAllAttributes($$)
+{
+	my ($xml, $name) = @_;
+	my @elements;
+	while($xml =~ /<$name\s([^>]*)>/sg){
+		my $body = $1;
+		my %attributes;
+		while($body =~ /(\w+)\s*=\s*["']([^"']*)["']/g){
+			$attributes{$1} = $2;
+		}
+		push(@elements, \%attributes);
+	}
+	return @elements;
+}
+
+# Runs a binary once and returns the results.
+sub RunOnikiri($$$$$)
+{
+	my ($option, $binary, $label, $workload, $window) = @_;
+
+	my $workPath = "$option->{'work'}/$workload->{'name'}/$label/$window";
+	mkpath($workPath);
+	my $resultFile = "$workPath/result.xml";
+	my $windowFile = "$workPath/window.xml";
+	unlink($resultFile);
+	WriteWindowParam($windowFile, $window);
+
+	my @command = (
+		$binary,
+		$option->{'param'},
+		$windowFile,
+		'-x', "/Session/Emulator/\@TargetArchitecture=$workload->{'arch'}",
+		'-x', "/Session/Emulator/Processes/Process/\@TargetBasePath=" . dirname($workload->{'command'}),
+		'-x', "/Session/Emulator/Processes/Process/\@Command=" . basename($workload->{'command'}),
+		'-x', "/Session/Emulator/Processes/Process/\@STDOUT=$workPath/stdout.txt",
+		'-x', "/Session/Simulator/System/\@Mode=Simulation",
+		'-x', "/Session/Simulator/System/\@SkipInsns=$workload->{'skip'}",
+		'-x', "/Session/Simulator/System/\@SimulationInsns=$option->{'insns'}",
+		'-x', "/Session/Environment/OutputXML/\@FileName=$resultFile",
+		'-x', "/Session/Environment/HostProfiler/\@Enable=1",
+	);
+
+	my $pid = fork();
+	if($pid == 0){
+		open(STDOUT, '>', "$workPath/onikiri.log");
+		open(STDERR, '>&', \*STDOUT);
+		exec(@command) or exit(127);
+	}
+	waitpid($pid, 0);
+	if($? != 0){
+		Throw("onikiri2 failed in $workload->{'name'}/$label/$window. See '$workPath/onikiri.log'.\n");
+	}
+
+	open(my $file, '<', $resultFile) or Throw("Cannot open '$resultFile'.\n");
+	my $xml = do { local $/; <$file> };
+	close($file);
+	$xml = $1 if($xml =~ /<Result\b(.*)<\/Result>/s);
+
+	my ($system)  = GetAllAttributes($xml, 'System');
+	my ($profile) = GetAllAttributes($xml, 'HostProfile');
+	my $cycles = $system->{'ExecutedCycles'};
+	if(!defined($cycles) || $cycles <= 0 || !defined($profile->{'TotalTicks'})){
+		Throw("No valid profile in '$resultFile'.\n");
+	}
+
+	# Scheduler resources are named "<name>[<rid>]", e.g. "intScheduler[0]".
+	my $schedulerTicks = 0;
+	foreach my $resource (GetAllAttributes($xml, 'Resource')){
+		if($resource->{'Name'} =~ /Scheduler\[[0-9]+\]$/){
+			$schedulerTicks += $resource->{'Evaluate'};
+		}
+	}
+
+	return {
+		'cycles'         => $cycles,
+		'schedulerTicks' => $schedulerTicks / $cycles,
+		'ticks'          => $profile->{'TotalTicks'} / $cycles,
+	};
+}
+
+sub Measure($$$)
+{
+	my ($option, $workload, $window) = @_;
+
+	my $current = RunOnikiri($option, $option->{'onikiri'}, 'current', $workload, $window);
+	my %row = (
+		'workload' => $workload->{'name'},
+		'window'   => $window,
+		'cycles'   => $current->{'cycles'},
+		'scheduler_ticks_per_cycle' => sprintf("%.1f", $current->{'schedulerTicks'}),
+		'ticks_per_cycle'           => sprintf("%.1f", $current->{'ticks'}),
+		'reference_scheduler_ticks_per_cycle' => '',
+		'reference_ticks_per_cycle' => '',
+		'ratio'    => '',
+	);
+
+	if($option->{'reference'} ne ''){
+		my $reference = RunOnikiri($option, $option->{'reference'}, 'reference', $workload, $window);
+		$row{'reference_scheduler_ticks_per_cycle'} = sprintf("%.1f", $reference->{'schedulerTicks'});
+		$row{'reference_ticks_per_cycle'} = sprintf("%.1f", $reference->{'ticks'});
+		if($reference->{'schedulerTicks'} > 0){
+			$row{'ratio'} = sprintf("%.3f", $current->{'schedulerTicks'} / $reference->{'schedulerTicks'});
+		}
+	}
+	return \%row;
+}
+
+
+#
+# --- Main
+#
+
+sub Main()
+{
+	my $option = Initialize();
+	my @workloads = LoadWorkloads($option->{'workloads'});
+
+	my @rows;
+	foreach my $workload (@workloads){
+		foreach my $window (@{$option->{'windows'}}){
+			print "Running $workload->{'name'} with a window of $window ...\n";
+			push(@rows, Measure($option, $workload, $window));
+		}
+	}
+
+	open(my $file, '>', $option->{'output'}) or Throw("Cannot open '$option->{'output'}'.\n");
+	print $file join(',', @g_columns) . "\n";
+	foreach my $row (@rows){
+		print $file join(',', map { $row->{$_} } @g_columns) . "\n";
+	}
+	close($file);
+
+	printf("%-12s %8s %12s %12s %8s\n", 'workload', 'window', 'sched/cycle', 'reference', 'ratio');
+	foreach my $row (@rows){
+		printf(
+			"%-12s %8s %12s %12s %8s\n", $row->{'workload'}, $row->{'window'},
+			$row->{'scheduler_ticks_per_cycle'}, $row->{'reference_scheduler_ticks_per_cycle'}, $row->{'ratio'}
+		);
+	}
+	print "Results are written to '$option->{'output'}'.\n";
+	return 0;
+}
+
+exit(Main());
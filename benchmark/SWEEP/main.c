@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * Reads 'input.bin' through STDIN and open() before and after a loop.
+ * The skip phase in param.xml ends in the loop, so each sweep configuration
+ * reads the rest of the file from its own forked process.
+ */
+
+#define FILE_SIZE  65536
+#define HEAD_SIZE  4096
+#define LOOP_COUNT 1000000
+
+/* Reads up to 'size' bytes from 'fd' and checks that the i-th byte is i % 251. */
+static int Check(int fd, long* pos, long size)
+{
+	unsigned char buf[1024];
+	int ok = 1;
+	while (*pos < size) {
+		long request = size - *pos < (long)sizeof(buf) ? size - *pos : (long)sizeof(buf);
+		long n = read(fd, buf, request);
+		long i;
+		if (n <= 0)
+			break;
+		for (i = 0; i < n; i++) {
+			if (buf[i] != (unsigned char)((*pos + i) % 251))
+				ok = 0;
+		}
+		*pos += n;
+	}
+	return ok;
+}
+
+int main(int argc, char* argv[])
+{
+	long stdinPos = 0;
+	long filePos = 0;
+	int stdinOK, fileOK;
+	volatile long sum = 0;
+	long i;
+
+	int fd = open("input.bin", O_RDONLY);
+	if (fd < 0) {
+		printf("file: NG (cannot open input.bin)\n");
+		return 1;
+	}
+
+	stdinOK = Check(0, &stdinPos, HEAD_SIZE);
+	fileOK  = Check(fd, &filePos, HEAD_SIZE);
+
+	for (i = 0; i < LOOP_COUNT; i++) {
+		sum += i;
+	}
+
+	/* An extra byte is requested for detecting the end of the file. */
+	stdinOK = Check(0, &stdinPos, FILE_SIZE + 1) && stdinOK && stdinPos == FILE_SIZE;
+	fileOK  = Check(fd, &filePos, FILE_SIZE + 1) && fileOK && filePos == FILE_SIZE;
+	close(fd);
+
+	printf("stdin: %s (%ld bytes)\n", stdinOK ? "OK" : "NG", stdinPos);
+	printf("file: %s (%ld bytes)\n", fileOK ? "OK" : "NG", filePos);
+	return 0;
+}
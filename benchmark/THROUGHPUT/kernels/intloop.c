@@ -0,0 +1,24 @@
+#include <stdio.h>
+
+// Integer ALU operations and data dependent branches.
+// About 5*10^8 insns are executed.
+int main(int argc, char* argv[])
+{
+	unsigned long x = 88172645463325252UL;
+	unsigned long sum = 0;
+	long i;
+
+	for(i = 0; i < 50000000; i++){
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		if(x & 1){
+			sum += x >> 32;
+		}
+		else{
+			sum ^= x;
+		}
+	}
+	printf("%lu\n", sum);
+	return 0;
+}
@@ -0,0 +1,33 @@
+#include <stdio.h>
+
+// Floating point multiply-adds on 128x128 matrices.
+// About 5*10^8 insns are executed.
+#define N 128
+
+static double a[N][N], b[N][N], c[N][N];
+
+int main(int argc, char* argv[])
+{
+	int i, j, k, r;
+
+	for(i = 0; i < N; i++){
+		for(j = 0; j < N; j++){
+			a[i][j] = (double)(i + j) / N;
+			b[i][j] = (double)(i - j) / N;
+			c[i][j] = 0.0;
+		}
+	}
+
+	for(r = 0; r < 64; r++){
+		for(i = 0; i < N; i++){
+			for(k = 0; k < N; k++){
+				double aik = a[i][k];
+				for(j = 0; j < N; j++){
+					c[i][j] += aik * b[k][j];
+				}
+			}
+		}
+	}
+	printf("%f\n", c[N/2][N/2]);
+	return 0;
+}
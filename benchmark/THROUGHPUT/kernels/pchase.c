@@ -0,0 +1,33 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+// Dependent loads on a cyclic list larger than the caches.
+// Most of the cycles are spent waiting for the memory.
+// About 10^8 insns are executed.
+#define NODES (1 << 20)
+#define STRIDE 393241	// An odd stride visits all the nodes.
+
+struct Node
+{
+	struct Node* next;
+	long pad[7];	// A node occupies a 64B line.
+};
+
+int main(int argc, char* argv[])
+{
+	struct Node* nodes = (struct Node*)malloc(sizeof(struct Node) * NODES);
+	struct Node* p;
+	long i;
+
+	for(i = 0; i < NODES; i++){
+		nodes[(i * STRIDE) % NODES].next = &nodes[((i + 1) * STRIDE) % NODES];
+	}
+
+	p = &nodes[0];
+	for(i = 0; i < 30000000; i++){
+		p = p->next;
+	}
+	printf("%ld\n", (long)(p - nodes));
+	free(nodes);
+	return 0;
+}
@@ -0,0 +1,406 @@
+#!/usr/bin/perl
+
+#
+# Measures the throughput of onikiri2 itself.
+#
+# Each workload in the workload list is run in each mode, and the following
+# metrics are written to a CSV file:
+#   seconds     : host wall time of the simulation, which is reported by 
+#                 onikiri2 as 'Result/System/@RunSeconds' and excludes 
+#                 the startup and the finalization of the process
+#   kips/mips   : executed (skipped + simulated) insns per 'seconds'
+#   wall_seconds : host wall time of the whole process
+#   peak_rss_kb : peak resident set size of the simulator process
+#   ticks_per_cycle : host time stamp counter ticks per simulated cycle in 
+#                 SimulationSystem, which is measured by HostProfiler in 
+#                 a separate run. 
+# The results are compared with a baseline file when it exists, and this
+# script exits with 1 when any metric regresses beyond thresholds.
+#
+
+use strict;
+use FindBin;
+use File::Basename;
+use File::Path;
+use File::Spec;
+use Time::HiRes qw( time );
+
+my @g_modes = ( 'Emulation', 'Inorder', 'SkipByInorder', 'Simulation' );
+
+# Modes in which SimulationSystem runs.
+my %g_cycleModes = ( 'SkipByInorder' => 1, 'Simulation' => 1 );
+
+my @g_columns = ( 
+	'workload', 'mode', 'insns', 'cycles', 'seconds', 
+	'kips', 'mips', 'wall_seconds', 'peak_rss_kb', 'ticks_per_cycle' 
+);
+
+
+#
+# --- Exception & terminating
+#
+
+sub Throw
+{
+	print STDERR shift;
+	exit 1;
+}
+
+
+#
+# --- Option
+#
+
+sub Initialize()
+{
+	my $option = 
+	{
+		'onikiri'   => "$FindBin::Bin/../../project/gcc/onikiri2/a.out",
+		'param'     => "$FindBin::Bin/param.xml",
+		'workloads' => "$FindBin::Bin/workloads.txt",
+		'baseline'  => "$FindBin::Bin/baseline.csv",
+		'output'    => "$FindBin::Bin/result.csv",
+		'work'      => "$FindBin::Bin/tmp",
+		'threshold'    => 5,	# % of KIPS and ticks per cycle
+		'rssThreshold' => 10,	# % of peak RSS
+		'repeat'    => 3,
+		'modes'     => [ @g_modes ],
+		'update'    => 0,
+	};
+
+	foreach my $arg (@ARGV){
+		if($arg =~ /^--onikiri=(.+)$/){
+			$option->{'onikiri'} = $1;
+		}
+		elsif($arg =~ /^--workloads=(.+)$/){
+			$option->{'workloads'} = $1;
+		}
+		elsif($arg =~ /^--baseline=(.+)$/){
+			$option->{'baseline'} = $1;
+		}
+		elsif($arg =~ /^--output=(.+)$/){
+			$option->{'output'} = $1;
+		}
+		elsif($arg =~ /^--threshold=([0-9.]+)$/){
+			$option->{'threshold'} = $1;
+		}
+		elsif($arg =~ /^--rss-threshold=([0-9.]+)$/){
+			$option->{'rssThreshold'} = $1;
+		}
+		elsif($arg =~ /^--repeat=([0-9]+)$/){
+			$option->{'repeat'} = $1 > 0 ? $1 : 1;
+		}
+		elsif($arg =~ /^--modes=(.+)$/){
+			$option->{'modes'} = [ split(/,/, $1) ];
+		}
+		elsif($arg =~ /^--update-baseline$/){
+			$option->{'update'} = 1;
+		}
+		else{
+			Throw(
+				"Usage: perl throughput.pl [--onikiri=path] [--workloads=file] [--baseline=file]\n" .
+				"    [--output=file] [--threshold=%] [--rss-threshold=%] [--repeat=n]\n" .
+				"    [--modes=Emulation,Inorder,SkipByInorder,Simulation] [--update-baseline]\n"
+			);
+		}
+	}
+
+	if( !-x $option->{'onikiri'} ){
+		Throw("'$option->{'onikiri'}' is not found. Build onikiri2 first.\n");
+	}
+	return $option;
+}
+
+sub LoadWorkloads($)
+{
+	my $fileName = shift;
+	my @workloads;
+
+	open(my $file, '<', $fileName) or Throw("Cannot open '$fileName'.\n");
+	while(my $line = <$file>){
+		$line =~ s/#.*$//;
+		$line =~ s/^\s+|\s+$//g;
+		next if($line eq '');
+
+		my @fields = split(/\s+/, $line);
+		if($#fields != 4){
+			Throw("Invalid workload '$line' in '$fileName'.\n");
+		}
+		my $command = File::Spec->rel2abs($fields[2], dirname($fileName));
+		if( !-f $command ){
+			Throw("'$command' is not found. Build the workloads first.\n");
+		}
+		push(@workloads, {
+			'name'    => $fields[0],
+			'arch'    => $fields[1],
+			'command' => $command,
+			'skip'    => $fields[3],
+			'insns'   => $fields[4],
+		});
+	}
+	close($file);
+	return @workloads;
+}
+
+
+#
+# --- Running
+#
+
+# Returns a hash of attributes of the first element named 'name'.
+sub GetAttributes($$)
+{
+	my ($xml, $name) = @_;
+	my %attributes;
+	if($xml =~ /<$name\s([^>]*)>/s){
+		my $body = $1;
+		while($body =~ /(\w+)\s*=\s*["']([^"']*)["']/g){
+			$attributes{$1} = $2;
+		}
+	}
+	return %attributes;
+}
+
+sub SumValues($)
+{
+	my $values = shift;
+	my $sum = 0;
+	foreach my $value (split(/,/, $values)){
+		$sum += $value;
+	}
+	return $sum;
+}
+
+# Runs onikiri2 once and returns the results.
+sub RunOnikiri($$$$)
+{
+	my ($option, $workload, $mode, $profile) = @_;
+
+	my $workPath = "$option->{'work'}/$workload->{'name'}/$mode";
+	mkpath($workPath);
+	my $resultFile = "$workPath/result.xml";
+	my $timeFile   = "$workPath/time.txt";
+	unlink($resultFile, $timeFile);
+
+	my $skip = $mode eq 'Emulation' ? 0 : $workload->{'skip'};
+	my @args = (
+		$option->{'param'},
+		'-x', "/Session/Emulator/\@TargetArchitecture=$workload->{'arch'}",
+		'-x', "/Session/Emulator/Processes/Process/\@TargetBasePath=" . dirname($workload->{'command'}),
+		'-x', "/Session/Emulator/Processes/Process/\@Command=" . basename($workload->{'command'}),
+		'-x', "/Session/Emulator/Processes/Process/\@STDOUT=$workPath/stdout.txt",
+		'-x', "/Session/Simulator/System/\@Mode=$mode",
+		'-x', "/Session/Simulator/System/\@SkipInsns=$skip",
+		'-x', "/Session/Simulator/System/\@SimulationInsns=$workload->{'insns'}",
+		'-x', "/Session/Environment/OutputXML/\@FileName=$resultFile",
+		'-x', "/Session/Environment/HostProfiler/\@Enable=$profile",
+	);
+
+	# GNU time reports the peak RSS in KB.
+	my @command = ( $option->{'onikiri'}, @args );
+	if( -x '/usr/bin/time' ){
+		@command = ( '/usr/bin/time', '-f', '%M', '-o', $timeFile, @command );
+	}
+
+	my $begin = time();
+	my $pid = fork();
+	if($pid == 0){
+		open(STDOUT, '>', "$workPath/onikiri.log");
+		open(STDERR, '>&', \*STDOUT);
+		exec(@command) or exit(127);
+	}
+	waitpid($pid, 0);
+	my $wallSeconds = time() - $begin;
+	if($? != 0){
+		Throw("onikiri2 failed in $workload->{'name'}/$mode. See '$workPath/onikiri.log'.\n");
+	}
+
+	open(my $file, '<', $resultFile) or Throw("Cannot open '$resultFile'.\n");
+	my $xml = do { local $/; <$file> };
+	close($file);
+	$xml = $1 if($xml =~ /<Result\b(.*)<\/Result>/s);
+
+	my %system  = GetAttributes($xml, 'System');
+	my %profile = GetAttributes($xml, 'HostProfile');
+
+	my $rss = '';
+	if(open(my $time, '<', $timeFile)){
+		while(my $line = <$time>){
+			$rss = $1 if($line =~ /^\s*([0-9]+)\s*$/);
+		}
+		close($time);
+	}
+
+	if(!defined($system{'RunSeconds'}) || $system{'RunSeconds'} <= 0){
+		Throw("No valid 'RunSeconds' in '$resultFile'.\n");
+	}
+
+	return {
+		'insns'   => SumValues($system{'SkippedInsns'}) + SumValues($system{'ExecutedInsns'}),
+		'cycles'  => $system{'ExecutedCycles'},
+		'seconds' => $system{'RunSeconds'},
+		'wallSeconds' => $wallSeconds,
+		'rss'     => $rss,
+		'ticks'   => $profile{'TotalTicks'},
+	};
+}
+
+# Runs a workload in a mode 'repeat' times and returns the best results.
+sub Measure($$$)
+{
+	my ($option, $workload, $mode) = @_;
+	my $best;
+	for(my $i = 0; $i < $option->{'repeat'}; $i++){
+		my $result = RunOnikiri($option, $workload, $mode, 0);
+		if(!defined($best) || $result->{'seconds'} < $best->{'seconds'}){
+			$best = $result;
+		}
+	}
+
+	my %row = (
+		'workload' => $workload->{'name'},
+		'mode'     => $mode,
+		'insns'    => $best->{'insns'},
+		'cycles'   => $best->{'cycles'},
+		'seconds'  => sprintf("%.3f", $best->{'seconds'}),
+		'kips'     => sprintf("%.1f", $best->{'insns'} / $best->{'seconds'} / 1000),
+		'mips'     => sprintf("%.3f", $best->{'insns'} / $best->{'seconds'} / 1000000),
+		'wall_seconds'    => sprintf("%.3f", $best->{'wallSeconds'}),
+		'peak_rss_kb'     => $best->{'rss'},
+		'ticks_per_cycle' => '',
+	);
+
+	# The profiler slows the simulation down, so ticks are measured in a 
+	# separate run and are compared only with those measured in the same way.
+	if($g_cycleModes{$mode}){
+		my $result = RunOnikiri($option, $workload, $mode, 1);
+		if($result->{'cycles'} > 0 && $result->{'ticks'} ne ''){
+			$row{'ticks_per_cycle'} = sprintf("%.1f", $result->{'ticks'} / $result->{'cycles'});
+		}
+	}
+	return \%row;
+}
+
+
+#
+# --- CSV
+#
+
+sub WriteCSV($$)
+{
+	my ($fileName, $rows) = @_;
+	open(my $file, '>', $fileName) or Throw("Cannot open '$fileName'.\n");
+	print $file join(',', @g_columns) . "\n";
+	foreach my $row (@$rows){
+		print $file join(',', map { $row->{$_} } @g_columns) . "\n";
+	}
+	close($file);
+}
+
+sub ReadCSV($)
+{
+	my $fileName = shift;
+	my %rows;
+	open(my $file, '<', $fileName) or return %rows;
+	my $header = <$file>;
+	chomp($header);
+	my @columns = split(/,/, $header);
+	while(my $line = <$file>){
+		chomp($line);
+		my @fields = split(/,/, $line, -1);
+		my %row;
+		@row{@columns} = @fields;
+		$rows{"$row{'workload'}/$row{'mode'}"} = \%row;
+	}
+	close($file);
+	return %rows;
+}
+
+
+#
+# --- Comparing
+#
+
+# Returns the change from 'base' to 'value' in %.
+sub Change($$)
+{
+	my ($base, $value) = @_;
+	return 0 if($base eq '' || $value eq '' || $base == 0);
+	return ($value - $base) / $base * 100;
+}
+
+# Returns the number of regressions.
+sub Compare($$)
+{
+	my ($option, $rows) = @_;
+	my %baseline = ReadCSV($option->{'baseline'});
+	if(!%baseline){
+		print "No baseline '$option->{'baseline'}'. Run with --update-baseline to create it.\n";
+		return 0;
+	}
+
+	# Higher KIPS is better, and lower RSS and ticks are better.
+	my @metrics = (
+		[ 'kips',            -1, $option->{'threshold'} ],
+		[ 'peak_rss_kb',      1, $option->{'rssThreshold'} ],
+		[ 'ticks_per_cycle',  1, $option->{'threshold'} ],
+	);
+
+	my $regressions = 0;
+	printf("%-24s %-16s %10s %10s %8s\n", 'workload/mode', 'metric', 'baseline', 'current', 'change');
+	foreach my $row (@$rows){
+		my $key = "$row->{'workload'}/$row->{'mode'}";
+		my $base = $baseline{$key};
+		next if(!defined($base));
+
+		foreach my $metric (@metrics){
+			my ($name, $sign, $threshold) = @$metric;
+			next if($base->{$name} eq '' || $row->{$name} eq '');
+			my $change = Change($base->{$name}, $row->{$name});
+			my $regressed = $change * $sign > $threshold;
+			$regressions++ if($regressed);
+			printf(
+				"%-24s %-16s %10s %10s %+7.1f%% %s\n", 
+				$key, $name, $base->{$name}, $row->{$name}, $change, $regressed ? 'NG' : 'OK'
+			);
+		}
+	}
+	return $regressions;
+}
+
+
+#
+# --- Main
+#
+
+sub Main()
+{
+	my $option = Initialize();
+	my @workloads = LoadWorkloads($option->{'workloads'});
+
+	my @rows;
+	foreach my $workload (@workloads){
+		foreach my $mode (@{$option->{'modes'}}){
+			print "Running $workload->{'name'} in $mode ...\n";
+			push(@rows, Measure($option, $workload, $mode));
+		}
+	}
+	WriteCSV($option->{'output'}, \@rows);
+	print "Results are written to '$option->{'output'}'.\n";
+
+	if($option->{'update'}){
+		WriteCSV($option->{'baseline'}, \@rows);
+		print "The baseline '$option->{'baseline'}' is updated.\n";
+		return 0;
+	}
+
+	my $regressions = Compare($option, \@rows);
+	if($regressions > 0){
+		print "==== $regressions regression(s) (throughput) ====\n";
+		return 1;
+	}
+	print "==== No regression (throughput) ====\n";
+	return 0;
+}
+
+exit(Main());
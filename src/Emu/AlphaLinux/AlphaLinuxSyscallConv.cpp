@@ -416,6 +416,7 @@ namespace {
     const int ALPHA_MREMAP_MAYMOVE = 1;
     const int ALPHA_MAP_NORESERVE = 0x10000;
     const int ALPHA_MAP_ANONYMOUS = 0x10;
+    const int ALPHA_MAP_PRIVATE = 0x02;
 }
 
 
@@ -465,6 +466,11 @@ int AlphaLinuxSyscallConv::Get_MAP_ANONYMOUS()
     return ALPHA_MAP_ANONYMOUS;
 }
 
+int AlphaLinuxSyscallConv::Get_MAP_PRIVATE()
+{
+    return ALPHA_MAP_PRIVATE;
+}
+
 int AlphaLinuxSyscallConv::Get_MREMAP_MAYMOVE()
 {
     return ALPHA_MREMAP_MAYMOVE;
@@ -63,6 +63,7 @@ namespace Onikiri {
             // consts / conversion
             //virtual void write_stat64(u64 dest, const EmulatorUtility::HostStat &src);
             virtual int Get_MAP_ANONYMOUS();
+            virtual int Get_MAP_PRIVATE();
             virtual int Get_MREMAP_MAYMOVE();
             virtual int Get_CLK_TCK();
 
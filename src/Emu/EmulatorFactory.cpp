@@ -35,9 +35,70 @@
 #include "Emu/PPC64Linux/PPC64LinuxEmulator.h"
 #include "Emu/RISCV32Linux/RISCV32LinuxEmulator.h"
 #include "Emu/RISCV64Linux/RISCV64LinuxEmulator.h"
+#include "Emu/AlphaLinux/Alpha64Info.h"
+#include "Emu/PPC64Linux/PPC64Info.h"
+#include "Emu/RISCV32Linux/RISCV32Info.h"
+#include "Emu/RISCV64Linux/RISCV64Info.h"
+#include "Emu/EmulatorISALimits.h"
 
 using namespace Onikiri;
 
+// The limits in EmulatorISALimits.h must be the maxima of the traits of 
+// the target ISAs.
+namespace
+{
+    template < int lhs, int rhs >
+    struct StaticMax
+    {
+        static const int value = lhs > rhs ? lhs : rhs;
+    };
+
+    template < typename ISA0, typename ISA1 = ISA0, typename ISA2 = ISA0, typename ISA3 = ISA0 >
+    struct ISALimits
+    {
+        static const int MAX_SRC_REG_COUNT = 
+            StaticMax< 
+                StaticMax< ISA0::MaxSrcRegCount, ISA1::MaxSrcRegCount >::value,
+                StaticMax< ISA2::MaxSrcRegCount, ISA3::MaxSrcRegCount >::value
+            >::value;
+
+        static const int MAX_DST_REG_COUNT = 
+            StaticMax< 
+                StaticMax< ISA0::MaxDstRegCount, ISA1::MaxDstRegCount >::value,
+                StaticMax< ISA2::MaxDstRegCount, ISA3::MaxDstRegCount >::value
+            >::value;
+
+        static const int MAX_REG_COUNT = 
+            StaticMax< 
+                StaticMax< ISA0::RegisterCount, ISA1::RegisterCount >::value,
+                StaticMax< ISA2::RegisterCount, ISA3::RegisterCount >::value
+            >::value;
+    };
+
+#if defined( ONIKIRI_TARGET_ISA_ALPHA )
+    typedef ISALimits< AlphaLinux::Alpha64Info > TargetISALimits;
+#elif defined( ONIKIRI_TARGET_ISA_PPC64 )
+    typedef ISALimits< PPC64Linux::PPC64Info > TargetISALimits;
+#elif defined( ONIKIRI_TARGET_ISA_RISCV32 )
+    typedef ISALimits< RISCV32Linux::RISCV32Info > TargetISALimits;
+#elif defined( ONIKIRI_TARGET_ISA_RISCV64 )
+    typedef ISALimits< RISCV64Linux::RISCV64Info > TargetISALimits;
+#else
+    typedef 
+        ISALimits< 
+            AlphaLinux::Alpha64Info, 
+            PPC64Linux::PPC64Info, 
+            RISCV32Linux::RISCV32Info, 
+            RISCV64Linux::RISCV64Info 
+        > 
+        TargetISALimits;
+#endif
+
+    BOOST_STATIC_ASSERT( EmulatorISALimits::MAX_SRC_REG_COUNT == TargetISALimits::MAX_SRC_REG_COUNT );
+    BOOST_STATIC_ASSERT( EmulatorISALimits::MAX_DST_REG_COUNT == TargetISALimits::MAX_DST_REG_COUNT );
+    BOOST_STATIC_ASSERT( EmulatorISALimits::MAX_REG_COUNT     == TargetISALimits::MAX_REG_COUNT );
+}
+
 EmulatorFactory::EmulatorFactory()
 {
 }
@@ -71,3 +132,27 @@ EmulatorIF* EmulatorFactory::Create(const String& systemName, SystemIF* simSyste
     return 0;
 }
 
+ISAInfoIF* EmulatorFactory::CreateISAInfo(const String& systemName)
+{
+    if (systemName == "AlphaLinux") {
+        return new AlphaLinux::Alpha64Info();
+    }
+    else if (systemName == "PPC64Linux") {
+        return new PPC64Linux::PPC64Info();
+    }
+    else if (systemName == "RISCV32Linux") {
+        return new RISCV32Linux::RISCV32Info();
+    }
+    else if (systemName == "RISCV64Linux") {
+        return new RISCV64Linux::RISCV64Info();
+    }
+
+    THROW_RUNTIME_ERROR(
+        "Unknown system name specified.\n"
+        "This parameter must be one of the following strings : \n"
+        "[AlphaLinux,PPC64Linux,RISCV32Linux,RISCV64Linux]"
+    );
+
+    return 0;
+}
+
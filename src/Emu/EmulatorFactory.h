@@ -45,6 +45,10 @@ namespace Onikiri {
         // その際にメモリ確保などの Notify を system に投げるために，
         // この時点でsystem を渡しておく必要がある．
         EmulatorIF* Create(const String& systemName, SystemIF* simSystem);
+
+        // Create the ISA information of 'systemName' without creating 
+        // an emulator. A caller must delete the returned object.
+        ISAInfoIF* CreateISAInfo(const String& systemName);
     };
 
 } // namespace Onikiri
@@ -0,0 +1,72 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+
+
+#ifndef EMU_EMULATOR_ISA_LIMITS_H
+#define EMU_EMULATOR_ISA_LIMITS_H
+
+//
+// Compile-time upper bounds of the register operands/counts of 
+// the ISAs that EmulatorFactory creates.
+// The simulator section uses them for sizing fixed arrays (see Sim/ISAInfo.h).
+// This header does not include the headers of each ISA, and 
+// EmulatorFactory.cpp checks that the bounds are computed from the 
+// traits of the ISAs.
+//
+// By default, the bounds cover all ISAs. When one of the following macros is 
+// defined, the bounds are exactly those of the specified ISA and emulators of 
+// the other ISAs are rejected by SimISAInfo::TestISAInfo.
+//   ONIKIRI_TARGET_ISA_ALPHA
+//   ONIKIRI_TARGET_ISA_PPC64
+//   ONIKIRI_TARGET_ISA_RISCV32
+//   ONIKIRI_TARGET_ISA_RISCV64
+//
+
+namespace Onikiri
+{
+    struct EmulatorISALimits
+    {
+#if defined( ONIKIRI_TARGET_ISA_ALPHA ) || defined( ONIKIRI_TARGET_ISA_RISCV32 ) || defined( ONIKIRI_TARGET_ISA_RISCV64 )
+        static const int MAX_SRC_REG_COUNT = 3;
+        static const int MAX_DST_REG_COUNT = 2;
+        static const int MAX_REG_COUNT     = 66;
+#else
+        // PPC64 has the largest limits of all ISAs.
+        static const int MAX_SRC_REG_COUNT = 4;
+        static const int MAX_DST_REG_COUNT = 3;
+        static const int MAX_REG_COUNT     = 77;
+#endif
+    };
+
+} // namespace Onikiri
+
+#endif // EMU_EMULATOR_ISA_LIMITS_H
@@ -381,6 +381,7 @@ namespace {
     const int PPC64_MREMAP_MAYMOVE = 1;
     const int PPC64_MAP_NORESERVE = 0x00040;
     const int PPC64_MAP_ANONYMOUS = 0x20;
+    const int PPC64_MAP_PRIVATE = 0x02;
 }
 
 int PPC64LinuxSyscallConv::Get_MAP_ANONYMOUS()
@@ -388,6 +389,11 @@ int PPC64LinuxSyscallConv::Get_MAP_ANONYMOUS()
     return PPC64_MAP_ANONYMOUS;
 }
 
+int PPC64LinuxSyscallConv::Get_MAP_PRIVATE()
+{
+    return PPC64_MAP_PRIVATE;
+}
+
 int PPC64LinuxSyscallConv::Get_MREMAP_MAYMOVE()
 {
     return PPC64_MREMAP_MAYMOVE;
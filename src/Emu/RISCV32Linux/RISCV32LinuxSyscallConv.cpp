@@ -497,6 +497,7 @@ namespace {
     const int RISCV32_CLK_TCK = 100;
     const int RISCV32_MREMAP_MAYMOVE = 1;
     const int RISCV32_MAP_ANONYMOUS = 0x20;
+    const int RISCV32_MAP_PRIVATE = 0x02;
 }
 
 int RISCV32LinuxSyscallConv::Get_MAP_ANONYMOUS()
@@ -504,6 +505,11 @@ int RISCV32LinuxSyscallConv::Get_MAP_ANONYMOUS()
     return RISCV32_MAP_ANONYMOUS;
 }
 
+int RISCV32LinuxSyscallConv::Get_MAP_PRIVATE()
+{
+    return RISCV32_MAP_PRIVATE;
+}
+
 int RISCV32LinuxSyscallConv::Get_MREMAP_MAYMOVE()
 {
     return RISCV32_MREMAP_MAYMOVE;
@@ -322,9 +322,10 @@ RISCV64Converter::OpDef RISCV64Converter::m_OpDefsBase[] =
 
     // System
     //{Name,    Mask,       Opcode,         nOp,{ OpClassCode,          Dst[],      Src[],              OpInfoType::EmulationFunc}[]}
-    {"ecall",   MASK_EXACT, OPCODE_ECALL(),   2,  {
+    {"ecall",   MASK_EXACT, OPCODE_ECALL(),   3,  {
         {OpClassCode::syscall,          {17, -1}, {17, 10, 11, -1}, RISCV64SyscallSetArg} ,
-        {OpClassCode::syscall_branch,   {10, -1}, {17, 12, 13, -1}, RISCV64SyscallCore},
+        {OpClassCode::syscall,          {17, -1}, {17, 12, 13, -1}, RISCV64SyscallSetArg2} ,
+        {OpClassCode::syscall_branch,   {10, -1}, {17, 14, 15, -1}, RISCV64SyscallCore},
     }},
     // Fence Instructions
     // It is not always necessary to stop all the instructions
@@ -586,6 +586,7 @@ namespace {
     const int RISCV64_CLK_TCK = 100;
     const int RISCV64_MREMAP_MAYMOVE = 1;
     const int RISCV64_MAP_ANONYMOUS = 0x20;
+    const int RISCV64_MAP_PRIVATE = 0x02;
 }
 
 int RISCV64LinuxSyscallConv::Get_MAP_ANONYMOUS()
@@ -593,6 +594,11 @@ int RISCV64LinuxSyscallConv::Get_MAP_ANONYMOUS()
     return RISCV64_MAP_ANONYMOUS;
 }
 
+int RISCV64LinuxSyscallConv::Get_MAP_PRIVATE()
+{
+    return RISCV64_MAP_PRIVATE;
+}
+
 int RISCV64LinuxSyscallConv::Get_MREMAP_MAYMOVE()
 {
     return RISCV64_MREMAP_MAYMOVE;
@@ -797,13 +797,20 @@ namespace Onikiri {
                 DstOperand<0>::SetOperand(opState, SrcOperand<0>()(opState));
             }
 
-            // invoke syscall, get result&error and branch if any
-            void RISCV64SyscallCore(EmulatorUtility::OpEmulationState* opState)
+            void RISCV64SyscallSetArg2(EmulatorUtility::OpEmulationState* opState)
             {
                 EmulatorUtility::SyscallConvIF* syscallConv = opState->GetProcessState()->GetSyscallConv();
                 syscallConv->SetArg(3, SrcOperand<1>()(opState));
                 syscallConv->SetArg(4, SrcOperand<2>()(opState));
-                //syscallConv->SetArg(5, SrcOperand<2>()(opState));
+                DstOperand<0>::SetOperand(opState, SrcOperand<0>()(opState));
+            }
+
+            // invoke syscall, get result&error and branch if any
+            void RISCV64SyscallCore(EmulatorUtility::OpEmulationState* opState)
+            {
+                EmulatorUtility::SyscallConvIF* syscallConv = opState->GetProcessState()->GetSyscallConv();
+                syscallConv->SetArg(5, SrcOperand<1>()(opState));
+                syscallConv->SetArg(6, SrcOperand<2>()(opState));
                 syscallConv->Execute(opState);
 
                 u64 error = (u64)syscallConv->GetResult(EmulatorUtility::SyscallConvIF::ErrorFlagIndex);
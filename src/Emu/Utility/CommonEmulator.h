@@ -47,6 +47,7 @@
 #include "Emu/Utility/OpEmulationState.h"
 #include "Emu/Utility/SkipOp.h"
 #include "Emu/Utility/GenericOperation.h"
+#include "Emu/Utility/TranslationCache.h"
 
 namespace Onikiri {
     class SystemIF;
@@ -89,9 +90,12 @@ namespace Onikiri {
             virtual PC GetEntryPoint(int pid) const;
             virtual u64 GetInitialRegValue(int pid, int index) const;
             virtual ISAInfoIF* GetISAInfo();
-            virtual PC Skip(PC pc, u64 skipCount, u64* regArray, u64* executedInsnCount, u64* executedOpCount);
+            virtual PC Skip(PC pc, u64 skipCount, u64* regArray, u64* executedInsnCount, u64* executedOpCount, SkipObserverIF* observer);
             virtual void TerminateSkip();
             virtual void SetExtraOpDecoder( ExtraOpDecoderIF* extraOpDecoder );
+            virtual void SaveProcessState( int pid, CheckpointWriter* writer );
+            virtual void RestoreProcessState( int pid, CheckpointReader* reader );
+            virtual void ReopenHostFiles();
 
             // MemIF の実装
             virtual void Read( MemAccess* access );
@@ -150,6 +154,19 @@ namespace Onikiri {
                 return result;
             }
 
+            // Translation cache for Skip()
+            typedef TranslationCache<OpInfoType> TranslationCacheType;
+            typedef typename TranslationCacheType::Block TranslatedBlock;
+            bool m_enableTranslationCache;
+            std::vector<TranslationCacheType*> m_translationCaches;
+
+            // Translate a basic block starting at 'pc'.
+            // NULL is returned if 'pc' is out of the code range.
+            TranslatedBlock* Translate(PC pc);
+
+            // Invalidate translated/decoded code in [addr, addr+size).
+            void InvalidateCode(int pid, u64 addr, u64 size);
+
             // Request for skip termination
             bool m_reqSkipTermination;
         public:
@@ -157,6 +174,7 @@ namespace Onikiri {
             BEGIN_PARAM_MAP( "" )
                 BEGIN_PARAM_PATH( "/Session/Emulator/" )
                     PARAM_ENTRY( "@EnableResultCRC32Calculation", m_enableResultCRC )
+                    PARAM_ENTRY( "@EnableTranslationCache", m_enableTranslationCache )
                     BEGIN_PARAM_PATH("Processes/")
                         PARAM_ENTRY("count(Process)", m_processCount)
                     END_PARAM_PATH()
@@ -170,6 +188,7 @@ namespace Onikiri {
             :   m_opInfoArrayPool(sizeof(OpInfo*)),
                 m_extraOpDecoder(0),
                 m_enableResultCRC( false ),
+                m_enableTranslationCache( false ),
                 m_reqSkipTermination(false)
         {
             // param, プロセス情報読み込み
@@ -186,6 +205,9 @@ namespace Onikiri {
             for (std::vector<ProcessState*>::iterator e = m_processes.begin(); e != m_processes.end(); ++e) {
                 delete *e;
             }
+            for (size_t i = 0; i < m_translationCaches.size(); i++) {
+                delete m_translationCaches[i];
+            }
 
             ReleaseParam();
         }
@@ -210,6 +232,7 @@ namespace Onikiri {
                 processState->Init<Traits>( createParam, simSystem );
                 m_processes.push_back(processState);
                 m_ProcessOpInfoCache[i].resize( processState->GetCodeRange().second, OpInfoArray((OpInfo**)NULL, 0));
+                m_translationCaches.push_back( new TranslationCacheType() );
             }
             
             return true;
@@ -359,7 +382,7 @@ namespace Onikiri {
         }
 
         template <class Traits>
-        PC CommonEmulator<Traits>::Skip(PC pc, u64 skipCount, u64* regArray, u64* executedInsnCount, u64* executedOpCount)
+        PC CommonEmulator<Traits>::Skip(PC pc, u64 skipCount, u64* regArray, u64* executedInsnCount, u64* executedOpCount, SkipObserverIF* observer)
         {
             if (skipCount == 0) {
                 if (executedInsnCount)
@@ -375,8 +398,70 @@ namespace Onikiri {
             VirtualSystem* virtualSystem = process->GetVirtualSystem();
             bool enableResultCRC = m_enableResultCRC;
 
+            TranslationCacheType* translationCache = 
+                m_enableTranslationCache ? m_translationCaches[pc.pid] : NULL;
+            TranslatedBlock* block = NULL;
+            const u64 insnBytes = ISAInfoType::InstructionWordBitSize/8;
+
             SkipOp op(this);
-            while (skipCount-- != 0 && pc.address != 0 && !m_reqSkipTermination) {
+            while (skipCount != 0 && pc.address != 0 && !m_reqSkipTermination) {
+
+                // Execute a translated block if it is available.
+                if (translationCache) {
+                    if (translationCache->IsFlushRequested()) {
+                        translationCache->Flush();
+                        block = NULL;
+                    }
+                    block = block ? translationCache->GetSuccessor(block, pc.address) : translationCache->Find(pc.address);
+                    if (!block) {
+                        block = Translate(pc);
+                    }
+                }
+
+                if (block) {
+                    size_t blockOpCount = block->ops.size();
+                    for (size_t opIndex = 0; opIndex < blockOpCount; opIndex++) {
+                        const typename TranslationCacheType::TranslatedOp& translatedOp = block->ops[opIndex];
+                        totalOpCount++;
+
+                        OpEmulationState opState(&op, translatedOp, process, pc, regArray);
+                        translatedOp.func(&opState);
+                        opState.ApplyTranslatedStateToRegArray(translatedOp, regArray);
+
+                        if( enableResultCRC ){
+                            u64 dst = translatedOp.dstRegCount > 0 ? opState.GetDst(0) : 0;
+                            CalcCRC( pc, dst );
+                        }
+                        if( observer ){
+                            observer->OnSkippedOp( 
+                                pc, 
+                                translatedOp.opInfo,
+                                opState.GetTaken(), 
+                                PC( pc.pid, pc.tid, opState.GetTakenPC() ),
+                                op.GetLastAccess()
+                            );
+                            op.ClearLastAccess();
+                        }
+                        virtualSystem->AddInsnTick();
+
+                        if (translatedOp.lastInInsn) {
+                            skipCount--;
+                            if (opState.GetTaken()) {
+                                pc.address = opState.GetTakenPC();
+                                break;
+                            }
+                            pc.address += insnBytes;
+
+                            // Leave the block when code is overwritten in it.
+                            if (skipCount == 0 || m_reqSkipTermination || translationCache->IsFlushRequested()) {
+                                break;
+                            }
+                        }
+                    }
+                    continue;
+                }
+
+                skipCount--;
                 std::pair<OpInfo**, int> ops_pair = GetOpBody(pc);
                 OpInfo** opInfoArray = ops_pair.first;
                 int opCount = ops_pair.second;
@@ -394,20 +479,30 @@ namespace Onikiri {
                         u64 dst = opInfo->GetDstNum() > 0 ? opState.GetDst(0) : 0;
                         CalcCRC( pc, dst );
                     }
+                    if( observer ){
+                        observer->OnSkippedOp( 
+                            pc, 
+                            opInfo,
+                            opState.GetTaken(), 
+                            PC( pc.pid, pc.tid, opState.GetTakenPC() ),
+                            op.GetLastAccess()
+                        );
+                        op.ClearLastAccess();
+                    }
                     virtualSystem->AddInsnTick();
     
                     if (opIndex == opCount-1) {
                         if (opState.GetTaken())
                             pc.address = opState.GetTakenPC();
                         else
-                            pc.address += ISAInfoType::InstructionWordBitSize/8;
+                            pc.address += insnBytes;
                         break;
                     }
                 }
             }
 
             // Reset a termination request flag
-            m_reqSkipTermination = true;
+            m_reqSkipTermination = false;
 
             if (executedInsnCount)
                 *executedInsnCount = initialSkipCount - skipCount;
@@ -416,12 +511,103 @@ namespace Onikiri {
             return pc;
         }
 
+        template <class Traits>
+        typename CommonEmulator<Traits>::TranslatedBlock* CommonEmulator<Traits>::Translate(PC pc)
+        {
+            ProcessState* process = m_processes[pc.pid];
+            const std::pair<u64, size_t> codeRange = process->GetCodeRange();
+            const u64 codeEnd = codeRange.first + codeRange.second;
+            const u64 insnBytes = ISAInfoType::InstructionWordBitSize/8;
+
+            if (pc.address < codeRange.first || pc.address + insnBytes > codeEnd) {
+                return NULL;
+            }
+
+            // A block ends at a branch or a system call, which may change the control flow.
+            TranslatedBlock* block = new TranslatedBlock(pc.address);
+            PC insnPC = pc;
+            for (int i = 0; i < TranslationCacheType::MaxBlockInsns && insnPC.address + insnBytes <= codeEnd; i++) {
+                std::pair<OpInfo**, int> ops_pair = GetOpBody(insnPC);
+                int opCount = ops_pair.second;
+                if (opCount == 0) {
+                    break;
+                }
+
+                bool blockEnd = false;
+                for (int opIndex = 0; opIndex < opCount; opIndex++) {
+                    OpInfoType* opInfo = static_cast<OpInfoType*>( ops_pair.first[opIndex] );
+                    block->AddOp(opInfo, opIndex == opCount - 1);
+
+                    const OpClass& opClass = opInfo->GetOpClass();
+                    blockEnd |= opClass.IsBranch() || opClass.IsSyscall();
+                }
+
+                insnPC.address += insnBytes;
+                block->endAddress = insnPC.address;
+                if (blockEnd) {
+                    break;
+                }
+            }
+
+            if (block->ops.empty()) {
+                delete block;
+                return NULL;
+            }
+
+            m_translationCaches[pc.pid]->Add(block);
+            return block;
+        }
+
+        // Invalidate translated/decoded code when the code is overwritten.
+        template <class Traits>
+        void CommonEmulator<Traits>::InvalidateCode(int pid, u64 addr, u64 size)
+        {
+            const std::pair<u64, size_t> codeRange = m_processes[pid]->GetCodeRange();
+            const u64 codeEnd = codeRange.first + codeRange.second;
+            if (addr >= codeEnd || addr + size <= codeRange.first) {
+                return;
+            }
+
+            // Reset the decoded ops of instructions overlapping the range.
+            const u64 insnBytes = ISAInfoType::InstructionWordBitSize/8;
+            u64 begin = std::max( codeRange.first, addr - (insnBytes - 1) );
+            u64 end   = std::min( codeEnd, addr + size );
+            for (u64 i = begin; i < end; i++) {
+                m_ProcessOpInfoCache[pid][static_cast<size_t>(i - codeRange.first)] = OpInfoArray((OpInfo**)NULL, 0);
+            }
+
+            m_translationCaches[pid]->RequestFlush();
+        }
+
         template <class Traits>
         void CommonEmulator<Traits>::TerminateSkip()
         {
             m_reqSkipTermination = true;
         }
 
+        template <class Traits>
+        void CommonEmulator<Traits>::SaveProcessState( int pid, CheckpointWriter* writer )
+        {
+            ASSERT((size_t)pid < m_processes.size());
+            m_processes[pid]->SaveState( writer );
+        }
+
+        template <class Traits>
+        void CommonEmulator<Traits>::RestoreProcessState( int pid, CheckpointReader* reader )
+        {
+            ASSERT((size_t)pid < m_processes.size());
+            m_processes[pid]->RestoreState( reader );
+            m_translationCaches[pid]->RequestFlush();
+        }
+
+        template <class Traits>
+        void CommonEmulator<Traits>::ReopenHostFiles()
+        {
+            for (size_t pid = 0; pid < m_processes.size(); pid++) {
+                m_processes[pid]->GetVirtualSystem()->ReopenFiles();
+            }
+        }
+
         template <class Traits>
         void CommonEmulator<Traits>::Read( MemAccess* access )
         {
@@ -436,6 +622,7 @@ namespace Onikiri {
             int pid = access->address.pid;
             ProcessState* process = m_processes[pid];
             process->GetMemorySystem()->WriteMemory(access);
+            InvalidateCode( pid, access->address.address, access->size );
         }
 
     } // namespace EmulatorUtility
@@ -142,6 +142,27 @@ namespace Onikiri {
                 InitOperands<TOpInfo, RegFromRegArray<TOpInfo> >( RegFromRegArray<TOpInfo>(opInfo, regArray) );
             }
 
+            // For the translation cache.
+            // Operands are read from regArray with indices resolved at translation time.
+            template<typename TTranslatedOp>
+            OpEmulationState(Onikiri::OpStateIF* opState, const TTranslatedOp& op, EmulatorUtility::ProcessState* processState, PC pc, u64* regArray)
+                : m_opState(opState), m_opInfo(op.opInfo), m_processState(processState)
+            {
+                m_takenPC = pc.address+4;
+                m_taken = false;
+                m_pid = pc.pid;
+                m_tid = pc.tid;
+
+                m_PC = pc.address;
+
+                for (int i = 0; i < op.immCount; i ++) {
+                    m_src[ op.imms[i].slot ] = op.imms[i].value;
+                }
+                for (int i = 0; i < op.srcRegCount; i ++) {
+                    m_src[ op.srcRegs[i].slot ] = regArray[ op.srcRegs[i].reg ];
+                }
+            }
+
             // OpState に結果を反映させる
             template<typename TOpInfo>
             void ApplyEmulationState()
@@ -171,6 +192,15 @@ namespace Onikiri {
                 }
             }
 
+            // For the translation cache.
+            template<typename TTranslatedOp>
+            void ApplyTranslatedStateToRegArray(const TTranslatedOp& op, u64* regArray)
+            {
+                for (int i = 0; i < op.dstRegCount; i ++) {
+                    regArray[ op.dstRegs[i].reg ] = m_dst[ op.dstRegs[i].slot ];
+                }
+            }
+
             void SetDst(int index, u64 value)
             {
                 m_dst[index] = value;
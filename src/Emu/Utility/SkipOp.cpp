@@ -37,7 +37,7 @@
 using namespace std;
 using namespace Onikiri;
 
-SkipOp::SkipOp(MemIF* mainMem) : m_mainMem(mainMem)
+SkipOp::SkipOp(MemIF* mainMem) : m_mainMem(mainMem), m_accessed(false)
 {
 }
 
@@ -96,6 +96,8 @@ bool SkipOp::GetTaken() const
 void SkipOp::Read( MemAccess* access )
 {
     m_mainMem->Read(access);
+    m_lastAccess = *access;
+    m_accessed = true;
     if( access->result != MemAccess::MAR_SUCCESS ){
         RUNTIME_WARNING( "An access violation occurs.\n%s", access->ToString().c_str() );
     }
@@ -104,6 +106,8 @@ void SkipOp::Read( MemAccess* access )
 void SkipOp::Write( MemAccess* access )
 {
     m_mainMem->Write(access);
+    m_lastAccess = *access;
+    m_accessed = true;
     if( access->result != MemAccess::MAR_SUCCESS ){
         RUNTIME_WARNING( "An access violation occurs.\n%s", access->ToString().c_str() );
     }
@@ -41,10 +41,25 @@ namespace Onikiri {
     {
     private:
         MemIF* m_mainMem;
+
+        // The last memory access, which is recorded for SkipObserverIF.
+        MemAccess m_lastAccess;
+        bool m_accessed;
     public:
         SkipOp(MemIF* mainMem);
         virtual ~SkipOp();
 
+        // Returns the memory access after the last ClearLastAccess()
+        // or NULL if there is no access.
+        const MemAccess* GetLastAccess() const
+        {
+            return m_accessed ? &m_lastAccess : NULL;
+        }
+        void ClearLastAccess()
+        {
+            m_accessed = false;
+        }
+
         // OpStateIF
         virtual PC GetPC() const;
         virtual const u64 GetSrc(const int index) const;
@@ -32,6 +32,7 @@
 #include <pch.h>
 
 #include "Emu/Utility/System/Memory/HeapAllocator.h"
+#include "Utility/CheckpointStream.h"
 
 using namespace std;
 using namespace Onikiri;
@@ -252,6 +253,39 @@ void HeapAllocator::IntegrateFreeBlocks()
     }
 }
 
+void HeapAllocator::SaveState(CheckpointWriter* writer) const
+{
+    SaveBlockList(writer, m_freeList);
+    SaveBlockList(writer, m_allocList);
+}
+
+void HeapAllocator::RestoreState(CheckpointReader* reader)
+{
+    RestoreBlockList(reader, &m_freeList);
+    RestoreBlockList(reader, &m_allocList);
+}
+
+void HeapAllocator::SaveBlockList(CheckpointWriter* writer, const BlockList& blockList)
+{
+    writer->Write((u64)blockList.size());
+    typedef list<MemoryBlock>::const_iterator const_iterator;
+    for (const_iterator e = blockList.begin(); e != blockList.end(); ++e) {
+        writer->Write(e->Addr);
+        writer->Write(e->Bytes);
+    }
+}
+
+void HeapAllocator::RestoreBlockList(CheckpointReader* reader, BlockList* blockList)
+{
+    blockList->clear();
+    u64 count = reader->Read<u64>();
+    for (u64 i = 0; i < count; i++) {
+        u64 addr = reader->Read<u64>();
+        u64 bytes = reader->Read<u64>();
+        blockList->push_back(MemoryBlock(addr, bytes));
+    }
+}
+
 //void HeapAllocator::Dump() const
 //{
 //  for (iterator e = m_allocList.begin(); e != m_allocList.end(); ++e) {
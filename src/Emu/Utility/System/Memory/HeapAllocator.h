@@ -77,6 +77,10 @@ namespace Onikiri {
 
             u64 GetPageSize() const { return m_pageSize; }
 
+            // Save/restore the free/allocated block lists for checkpointing.
+            void SaveState(CheckpointWriter* writer) const;
+            void RestoreState(CheckpointReader* reader);
+
         private:
             struct MemoryBlock
             {
@@ -102,6 +106,8 @@ namespace Onikiri {
 
             // m_freeList中の隙間なく隣接しているメモリ領域を1つにまとめる
             void IntegrateFreeBlocks();
+            static void SaveBlockList(CheckpointWriter* writer, const BlockList& blockList);
+            static void RestoreBlockList(CheckpointReader* reader, BlockList* blockList);
             BlockList::iterator FindMemoryBlock(BlockList& blockList, u64 addr);
             BlockList::const_iterator FindMemoryBlock(const BlockList& blockList, u64 addr) const;
 
@@ -33,10 +33,13 @@
 #include "Emu/Utility/System/Memory/MemorySystem.h"
 #include "Emu/Utility/System/Memory/MemoryUtility.h"
 #include "SysDeps/Endian.h"
+#include "Utility/CheckpointStream.h"
+#include "SysDeps/posix.h"
 
 using namespace std;
 using namespace Onikiri;
 using namespace EmulatorUtility;
+using namespace Onikiri::POSIX;
 
 // Enable copy-on-write scheme in the mmap implement.
 #define ENABLE_MEMORY_SYSTEM_COPY_ON_WRITE
@@ -148,13 +151,7 @@ u64 MemorySystem::MMap(u64 addr, u64 length)
     CheckValueOnPageBoundary( result, "mmap:address" );
 
     if (result) {
-#ifdef ENABLE_MEMORY_SYSTEM_COPY_ON_WRITE
-        u64 zeroPageAddr = RESERVED_PAGE_ZERO_FILLED * GetPageSize();
-        m_virtualMemory.SetPhysicalMemoryMapping( result, zeroPageAddr, length, VIRTUAL_MEMORY_ATTR_READ|VIRTUAL_MEMORY_ATTR_WRITE );
-#else
-        m_virtualMemory.AssignPhysicalMemory(result, length, VIRTUAL_MEMORY_ATTR_READ);
-        TargetMemset(result, 0, length);
-#endif
+        AssignZeroFilledMemory(result, length);
         return result;
     }
     else{
@@ -162,6 +159,48 @@ u64 MemorySystem::MMap(u64 addr, u64 length)
     }
 }
 
+u64 MemorySystem::MMapFile(u64 addr, u64 length, int hostFD, u64 offset)
+{
+    if (addr != 0)
+        return (u64)-1;
+    if (length <= 0)
+        return (u64)-1;
+
+    u64 pageMask = GetPageSize() - 1;
+    if ((offset & pageMask) != 0)
+        return (u64)-1;
+
+    posix_struct_stat st;
+    if (posix_fstat(hostFD, &st) == -1)
+        return (u64)-1;
+    u64 fileSize = (u64)st.st_size;
+
+    u64 result = m_heapAlloc.Alloc(addr, length);
+    CheckValueOnPageBoundary( result, "mmap:address" );
+    if (!result)
+        return (u64)-1;
+
+    // Pages past the end of the file are zero-filled like anonymous ones.
+    u64 fileLength = offset < fileSize ? std::min(length, fileSize - offset) : 0;
+    u64 filePages  = (fileLength + pageMask) & ~pageMask;
+    if (fileLength > 0 && 
+        !m_virtualMemory.MapHostFile( result, fileLength, hostFD, offset, VIRTUAL_MEMORY_ATTR_READ|VIRTUAL_MEMORY_ATTR_WRITE )
+    ) {
+        // The host cannot map the file, so its contents are copied.
+        AssignZeroFilledMemory(result, filePages);
+        if (!ReadHostFile(result, fileLength, hostFD, offset)) {
+            // Only the pages of the file are assigned at this point.
+            m_virtualMemory.FreePhysicalMemory(result, filePages);
+            m_heapAlloc.Free(result, length);
+            return (u64)-1;
+        }
+    }
+    if (filePages < length) {
+        AssignZeroFilledMemory(result + filePages, length - filePages);
+    }
+    return result;
+}
+
 u64 MemorySystem::MRemap(u64 old_addr, u64 old_size, u64 new_size, bool mayMove)
 {
     // Debug
@@ -265,6 +304,56 @@ int MemorySystem::MUnmap(u64 addr, u64 length)
         return -1;
 }
 
+void MemorySystem::SaveState( CheckpointWriter* writer )
+{
+    writer->Write( m_currentBrk );
+    m_heapAlloc.SaveState( writer );
+    m_virtualMemory.SaveState( writer );
+}
+
+void MemorySystem::RestoreState( CheckpointReader* reader )
+{
+    m_currentBrk = reader->Read<u64>();
+    m_heapAlloc.RestoreState( reader );
+    m_virtualMemory.RestoreState( reader );
+}
+
+void MemorySystem::AssignZeroFilledMemory( u64 addr, u64 length )
+{
+#ifdef ENABLE_MEMORY_SYSTEM_COPY_ON_WRITE
+    u64 zeroPageAddr = RESERVED_PAGE_ZERO_FILLED * GetPageSize();
+    m_virtualMemory.SetPhysicalMemoryMapping( addr, zeroPageAddr, length, VIRTUAL_MEMORY_ATTR_READ|VIRTUAL_MEMORY_ATTR_WRITE );
+#else
+    m_virtualMemory.AssignPhysicalMemory(addr, length, VIRTUAL_MEMORY_ATTR_READ);
+    TargetMemset(addr, 0, length);
+#endif
+}
+
+bool MemorySystem::ReadHostFile( u64 addr, u64 length, int hostFD, u64 offset )
+{
+    s64 current = posix_lseek( hostFD, 0, POSIX_SEEK_CUR );
+    if( current == -1 || posix_lseek( hostFD, (s64)offset, POSIX_SEEK_SET ) == -1 ){
+        return false;
+    }
+
+    vector<u8> buf( (size_t)GetPageSize() );
+    bool success = true;
+    while( length > 0 ){
+        unsigned int count = (unsigned int)std::min( length, (u64)buf.size() );
+        int bytesRead = posix_read( hostFD, &buf[0], count );
+        if( bytesRead <= 0 ){
+            success = bytesRead == 0;   // Data past the end of the file is zero.
+            break;
+        }
+        MemCopyToTarget( addr, &buf[0], (u64)bytesRead );
+        addr   += bytesRead;
+        length -= bytesRead;
+    }
+
+    posix_lseek( hostFD, current, POSIX_SEEK_SET );
+    return success;
+}
+
 // Check whether an address is aligned on a page boundary.
 // An address passed to munmap/mremap must be aligned to a page boundary.
 void MemorySystem::CheckValueOnPageBoundary( u64 addr, const char* signature  )
@@ -63,6 +63,9 @@ namespace Onikiri {
             void SetInitialBrk(u64 initialBrk);
             u64 Brk(u64 addr);
             u64 MMap(u64 addr, u64 length);
+            // Map [offset, offset+length) of a host file privately.
+            // The contents of the file are shared with a host mapping and copied on write.
+            u64 MMapFile(u64 addr, u64 length, int hostFD, u64 offset);
             u64 MRemap(u64 old_addr, u64 old_size, u64 new_size, bool mayMove = false);
             int MUnmap(u64 addr, u64 length);
 
@@ -118,11 +121,21 @@ namespace Onikiri {
                 m_virtualMemory.MemCopyToTarget( dst, src, size );
             }
 
+            // Save/restore the heap, the program break and the memory image for checkpointing.
+            void SaveState( CheckpointWriter* writer );
+            void RestoreState( CheckpointReader* reader );
+
         private:
 
             // Cehck a value is aligned on a page boundary.
             void CheckValueOnPageBoundary( u64 addr, const char* signature );
 
+            // Assign zero-filled pages to [addr, addr+length) allocated by m_heapAlloc.
+            void AssignZeroFilledMemory( u64 addr, u64 length );
+
+            // Read [offset, offset+length) of a host file to 'addr' without moving the file offset.
+            bool ReadHostFile( u64 addr, u64 length, int hostFD, u64 offset );
+
             VirtualMemory m_virtualMemory;
             HeapAllocator m_heapAlloc;
 
@@ -32,10 +32,13 @@
 #include <pch.h>
 #include "Emu/Utility/System/Memory/VirtualMemory.h"
 #include "SysDeps/Endian.h"
+#include "Utility/CheckpointStream.h"
+#include "SysDeps/posix.h"
 
 using namespace std;
 using namespace Onikiri;
 using namespace EmulatorUtility;
+using namespace Onikiri::POSIX;
 
 // PageTable を引く際に TLB を使用するかどうか
 #define ENABLED_EMULATOR_UTILITY_TLB 1
@@ -44,27 +47,18 @@ using namespace EmulatorUtility;
 // 高速な実装を使用するかどうか
 #define ENABLED_VIRTUAL_MEMORY_FAST_HELPER 1
 
-// The initial bucket count of the unordered_map used in PageTable.
-// Note: Too large bucket count (ex. 4096) makes the finalize 
-// of the unordered_map very slow in VS 2010.
-static const int PAGE_TABLE_MAP_INITIAL_BUCKET_COUNT = 16;
-
-
 //
 // Memory helper function
 //
 
 //
-// 1-entry TLB
+// Direct-mapped TLB
 //
 TLB::TLB( int offsetBits )
 {
-    memset( &m_body, 0, sizeof(m_body) );
-    m_addr = 0;
-    m_valid = false;
-
     m_offsetBits = offsetBits;
     m_addrMask = shttl::mask( m_offsetBits, 64 - m_offsetBits );
+    Flush();
 }
 
 TLB::~TLB()
@@ -73,28 +67,37 @@ TLB::~TLB()
 
 bool TLB::Lookup( u64 addr, PageTableEntry* entry ) const
 {
-#ifndef ENABLED_EMULATOR_UTILITY_TLB
-    return false;
-#endif
-
-    if( m_valid && m_addr == ( addr & m_addrMask ) ){
-        *entry = m_body;
+    const PageTableEntry* body = Lookup( addr );
+    if( body ){
+        *entry = *body;
         return true;
     }
-
     return false;
 }
 
 void TLB::Write( u64 addr, const PageTableEntry& entry )
 {
-    m_addr = addr & m_addrMask;
-    m_body = entry;
-    m_valid = true;
+#ifdef ENABLED_EMULATOR_UTILITY_TLB
+    Entry& tlbEntry = m_entries[ ( addr >> m_offsetBits ) & ( TLB_ENTRY_COUNT - 1 ) ];
+    tlbEntry.addr = addr & m_addrMask;
+    tlbEntry.body = entry;
+#endif
+}
+
+void TLB::Invalidate( u64 addr )
+{
+    Entry& tlbEntry = m_entries[ ( addr >> m_offsetBits ) & ( TLB_ENTRY_COUNT - 1 ) ];
+    if( tlbEntry.addr == ( addr & m_addrMask ) ){
+        tlbEntry.addr = 1;  // Offset bits are not zero, so this never matches.
+    }
 }
 
 void TLB::Flush()
 {
-    m_valid = false;
+    for( int i = 0; i < TLB_ENTRY_COUNT; i++ ){
+        m_entries[i].addr = 1;
+        memset( &m_entries[i].body, 0, sizeof(m_entries[i].body) );
+    }
 }
 
 
@@ -102,10 +105,9 @@ void TLB::Flush()
 //
 //
 PageTable::PageTable(int offsetBits)    : 
-    m_map(
-        PAGE_TABLE_MAP_INITIAL_BUCKET_COUNT, 
-        AddrHash(offsetBits)
-    ), 
+    m_levelBits( (64 - offsetBits + PAGE_TABLE_LEVELS - 1) / PAGE_TABLE_LEVELS ),
+    m_root( NULL ),
+    m_mappedCount( 0 ),
     m_offsetBits(offsetBits), 
     m_offsetMask(~(u64)0 << offsetBits),
     m_tlb(offsetBits),
@@ -115,16 +117,102 @@ PageTable::PageTable(int offsetBits)    :
 
 PageTable::~PageTable()
 {
-    // Release PhysicalMemoryPage instances.
-    for( map_type::iterator i = m_map.begin(); i != m_map.end(); ++i ){
-        PageTableEntry&     logPage = i->second;
-        PhysicalMemoryPage* phyPage = logPage.phyPage;
-        phyPage->refCount--;
-        if( phyPage->refCount == 0 ){
-            m_phyPagePool.free( phyPage );
+    if( m_root ){
+        ReleaseNode( m_root, 0 );
+        m_root = NULL;
+    }
+}
+
+// Release nodes and PhysicalMemoryPage instances under 'node'.
+void PageTable::ReleaseNode( void** node, int level )
+{
+    size_t nodeSize = (size_t)1 << m_levelBits;
+    if( level == PAGE_TABLE_LEVELS - 1 ){
+        PageTableEntry* leaf = reinterpret_cast<PageTableEntry*>( node );
+        for( size_t i = 0; i < nodeSize; i++ ){
+            PhysicalMemoryPage* phyPage = leaf[i].phyPage;
+            if( phyPage ){
+                phyPage->refCount--;
+                if( phyPage->refCount == 0 ){
+                    m_phyPagePool.free( phyPage );
+                }
+            }
+        }
+        delete[] leaf;
+        return;
+    }
+
+    for( size_t i = 0; i < nodeSize; i++ ){
+        if( node[i] ){
+            ReleaseNode( static_cast<void**>( node[i] ), level + 1 );
+        }
+    }
+    delete[] node;
+}
+
+PageTableEntry* PageTable::FindEntry( u64 targetAddr ) const
+{
+    void** node = m_root;
+    for( int level = 0; level < PAGE_TABLE_LEVELS - 1; level++ ){
+        if( !node ){
+            return NULL;
+        }
+        node = static_cast<void**>( node[ GetNodeIndex( targetAddr, level ) ] );
+    }
+    if( !node ){
+        return NULL;
+    }
+    return &reinterpret_cast<PageTableEntry*>( node )[ GetNodeIndex( targetAddr, PAGE_TABLE_LEVELS - 1 ) ];
+}
+
+PageTableEntry* PageTable::GetEntry( u64 targetAddr )
+{
+    size_t nodeSize = (size_t)1 << m_levelBits;
+    if( !m_root ){
+        m_root = new void*[ nodeSize ];
+        memset( m_root, 0, sizeof(void*) * nodeSize );
+    }
+
+    void** node = m_root;
+    for( int level = 0; level < PAGE_TABLE_LEVELS - 1; level++ ){
+        void*& child = node[ GetNodeIndex( targetAddr, level ) ];
+        if( !child ){
+            if( level == PAGE_TABLE_LEVELS - 2 ){
+                PageTableEntry* leaf = new PageTableEntry[ nodeSize ];
+                memset( leaf, 0, sizeof(PageTableEntry) * nodeSize );
+                child = leaf;
+            }
+            else{
+                void** interior = new void*[ nodeSize ];
+                memset( interior, 0, sizeof(void*) * nodeSize );
+                child = interior;
+            }
+        }
+        node = static_cast<void**>( child );
+    }
+    return &reinterpret_cast<PageTableEntry*>( node )[ GetNodeIndex( targetAddr, PAGE_TABLE_LEVELS - 1 ) ];
+}
+
+template <typename Visitor>
+void PageTable::VisitEntries( void** node, int level, u64 baseAddr, Visitor* visitor ) const
+{
+    size_t nodeSize = (size_t)1 << m_levelBits;
+    int shift = m_offsetBits + ( PAGE_TABLE_LEVELS - 1 - level ) * m_levelBits;
+    if( level == PAGE_TABLE_LEVELS - 1 ){
+        PageTableEntry* leaf = reinterpret_cast<PageTableEntry*>( node );
+        for( size_t i = 0; i < nodeSize; i++ ){
+            if( leaf[i].phyPage ){
+                (*visitor)( baseAddr | ( (u64)i << shift ), leaf[i] );
+            }
+        }
+        return;
+    }
+
+    for( size_t i = 0; i < nodeSize; i++ ){
+        if( node[i] ){
+            VisitEntries( static_cast<void**>( node[i] ), level + 1, baseAddr | ( (u64)i << shift ), visitor );
         }
     }
-    m_map.clear();
 }
 
 
@@ -147,37 +235,27 @@ size_t PageTable::GetPageSize() const
 void *PageTable::TargetToHost(u64 targetAddr) 
 {
     PageTableEntry entry;
-    if( m_tlb.Lookup( targetAddr, &entry ) ){
-        return static_cast<u8*>(entry.phyPage->ptr) + (targetAddr & ~m_offsetMask);
-    }
-
-    map_type::const_iterator e = m_map.find(targetAddr & m_offsetMask);
-
-    if (e == m_map.end()) {
+    if( !GetMap( targetAddr, &entry ) ){
         THROW_RUNTIME_ERROR("unassigned page referred.");
         return 0;
     }
-    else{
-        // Update TLB
-        entry = e->second;
-        m_tlb.Write( targetAddr, entry );
-        return static_cast<u8*>(entry.phyPage->ptr) + (targetAddr & ~m_offsetMask);
-    }
+    return static_cast<u8*>(entry.phyPage->ptr) + (targetAddr & ~m_offsetMask);
 }
 
 void PageTable::AddMap( u64 targetAddr, u8* hostAddr, VIRTUAL_MEMORY_ATTR_TYPE attr )
 {
-    PageTableEntry      logPage;
     PhysicalMemoryPage* phyPage = (PhysicalMemoryPage*)m_phyPagePool.malloc();
-    
     phyPage->ptr = hostAddr;
     phyPage->refCount = 1;
 
-    logPage.phyPage = phyPage;
-    logPage.attr = attr;
+    PageTableEntry* logPage = GetEntry( targetAddr );
+    if( !logPage->phyPage ){
+        m_mappedCount++;
+    }
+    logPage->phyPage = phyPage;
+    logPage->attr = attr;
     
-    m_map[ targetAddr & m_offsetMask ] = logPage;
-    m_tlb.Flush();
+    m_tlb.Invalidate( targetAddr );
 }
 
 // Copy address mapping for copy-on-write.
@@ -187,15 +265,17 @@ void PageTable::CopyMap( u64 dstTargetAddr, u64 srcTargetAddr, VIRTUAL_MEMORY_AT
         THROW_RUNTIME_ERROR("An unassigned page is copied.");
     }
 
-    map_type::iterator e = m_map.find( srcTargetAddr & m_offsetMask );
-    e->second.phyPage->refCount++;
+    PhysicalMemoryPage* phyPage = FindEntry( srcTargetAddr )->phyPage;
+    phyPage->refCount++;
 
-    PageTableEntry newEntry;
-    newEntry.phyPage = e->second.phyPage;
-    newEntry.attr    = dstAttr; // Set new attribute.
-    m_map[ dstTargetAddr & m_offsetMask ] = newEntry;
+    PageTableEntry* newEntry = GetEntry( dstTargetAddr );
+    if( !newEntry->phyPage ){
+        m_mappedCount++;
+    }
+    newEntry->phyPage = phyPage;
+    newEntry->attr    = dstAttr; // Set new attribute.
 
-    m_tlb.Flush();
+    m_tlb.Invalidate( dstTargetAddr );
 }
 
 bool PageTable::GetMap( u64 targetAddr, PageTableEntry* page ) 
@@ -204,26 +284,26 @@ bool PageTable::GetMap( u64 targetAddr, PageTableEntry* page )
         return true;
     }
 
-    map_type::const_iterator e = m_map.find(targetAddr & m_offsetMask);
-    if (e == m_map.end()){
+    PageTableEntry* e = FindEntry( targetAddr );
+    if( !e || !e->phyPage ){
         return false;
     }
     else{
-        m_tlb.Write( targetAddr, e->second );
-        *page = e->second;
+        m_tlb.Write( targetAddr, *e );
+        *page = *e;
         return true;
     }
 }
 
 bool PageTable::SetMap( u64 targetAddr, const PageTableEntry& page )
 {
-    map_type::iterator e = m_map.find(targetAddr & m_offsetMask);
-    if (e == m_map.end()){
+    PageTableEntry* e = FindEntry( targetAddr );
+    if( !e || !e->phyPage ){
         return false;
     }
     else{
         m_tlb.Write( targetAddr, page );
-        e->second = page;
+        *e = page;
         return true;
     }
 }
@@ -242,31 +322,70 @@ int PageTable::GetPageReferenceCount( u64 targetAddr )
 
 int PageTable::RemoveMap(u64 targetAddr)
 {
-    map_type::iterator e = m_map.find(targetAddr & m_offsetMask);
+    PageTableEntry* e = FindEntry( targetAddr );
     
     int refCount = 0;
-    if( e != m_map.end() ){
-        PhysicalMemoryPage* phyPage = e->second.phyPage;
+    if( e && e->phyPage ){
+        PhysicalMemoryPage* phyPage = e->phyPage;
         phyPage->refCount--;
         refCount = phyPage->refCount;
         if( refCount == 0 ){
             m_phyPagePool.free( phyPage );
         }
-        m_map.erase(e);
-        m_tlb.Flush();
+        e->phyPage = NULL;
+        e->attr = 0;
+        m_mappedCount--;
+        m_tlb.Invalidate( targetAddr );
         return refCount;
     }
     return -1;
 }
 
+PhysicalMemoryPage* PageTable::AddPageReference( u64 targetAddr )
+{
+    PageTableEntry* e = FindEntry( targetAddr );
+    if( !e || !e->phyPage ){
+        THROW_RUNTIME_ERROR( "The specified address is not mapped." );
+    }
+    e->phyPage->refCount++;
+    return e->phyPage;
+}
+
+void PageTable::ReleasePageReference( PhysicalMemoryPage* phyPage )
+{
+    phyPage->refCount--;
+    if( phyPage->refCount == 0 ){
+        m_phyPagePool.free( phyPage );
+    }
+}
+
+namespace {
+    struct MappedAddressCollector
+    {
+        std::vector<u64>* addrs;
+        void operator()( u64 addr, const PageTableEntry& ){ addrs->push_back( addr ); }
+    };
+}
+
+void PageTable::GetMappedAddresses(std::vector<u64>* addrs) const
+{
+    addrs->clear();
+    addrs->reserve( m_mappedCount );
+    if( m_root ){
+        // The entries are visited in ascending order.
+        MappedAddressCollector collector = { addrs };
+        VisitEntries( m_root, 0, 0, &collector );
+    }
+}
+
 bool PageTable::IsMapped(u64 targetAddr) const
 {
-    PageTableEntry entry;
-    if( m_tlb.Lookup( targetAddr, &entry ) ){
+    if( m_tlb.Lookup( targetAddr ) ){
         return true;
     }
 
-    return (m_map.find(targetAddr & m_offsetMask) != m_map.end());
+    PageTableEntry* e = FindEntry( targetAddr );
+    return e && e->phyPage;
 }
 
 
@@ -315,6 +434,10 @@ VirtualMemory::VirtualMemory( int pid, bool bigEndian, SystemIF* simSystem ) :
 
 VirtualMemory::~VirtualMemory()
 {
+    // PhysicalMemoryPage instances are released with m_pageTbl.
+    for( list<HostFileMapping>::iterator i = m_hostFileMappings.begin(); i != m_hostFileMappings.end(); ++i ){
+        posix_munmap( i->hostAddr, i->hostSize );
+    }
 }
 
 // メモリ管理
@@ -323,7 +446,7 @@ u64 VirtualMemory::GetPageSize() const
     return m_pageTbl.GetPageSize();
 }
 
-void VirtualMemory::ReadMemory( MemAccess* access ) 
+void VirtualMemory::ReadMemoryBody( MemAccess* access ) 
 {
     u64 addr = access->address.address;
     PageTableEntry page;
@@ -348,7 +471,7 @@ void VirtualMemory::ReadMemory( MemAccess* access )
         return;
     }
 
-    void *ptr = m_pageTbl.TargetToHost( addr );
+    void *ptr = page.phyPage->ptr + (addr & ~m_pageTbl.GetOffsetMask());
     u64 result;
     switch (access->size) {
     case 1:
@@ -381,7 +504,7 @@ void VirtualMemory::ReadMemory( MemAccess* access )
     access->value = result;
 }
 
-void VirtualMemory::WriteMemory( MemAccess* access )
+void VirtualMemory::WriteMemoryBody( MemAccess* access )
 {
     PageTableEntry page;
     u64 addr = access->address.address;
@@ -408,7 +531,7 @@ void VirtualMemory::WriteMemory( MemAccess* access )
         m_pageTbl.GetMap( addr, &page );
     }
 
-    void *ptr = m_pageTbl.TargetToHost( addr );
+    void *ptr = page.phyPage->ptr + (addr & ~m_pageTbl.GetOffsetMask());
     switch (access->size) {
     case 1:
         *static_cast<u8*>(ptr) = EndianHostToSpecified((u8)access->value, m_bigEndian);
@@ -550,6 +673,10 @@ void VirtualMemory::FreePhysicalMemory(u64 addr, u64 size)
     for (BlockArray::iterator e = blocks.begin(); e != blocks.end(); ++e){
         FreePhysicalMemory(e->addr);
     }
+
+    if( !m_hostFileMappings.empty() ){
+        ReleaseUnusedHostFileMappings();
+    }
 }
 
 // dstAddr を含むページに srcAddr を含むページに現在割り当てられている物理メモリを割り当てる．
@@ -639,6 +766,73 @@ bool VirtualMemory::CopyPageOnWrite( u64 addr )
     return false;
 }
 
+bool VirtualMemory::MapHostFile( u64 addr, u64 size, int hostFD, u64 offset, VIRTUAL_MEMORY_ATTR_TYPE attr )
+{
+    u64 pageSize = GetPageSize();
+    if( ( offset & ( pageSize - 1 ) ) != 0 ){
+        return false;
+    }
+
+    BlockArray blocks;
+    SplitAtMapUnitBoundary( addr, size, back_inserter(blocks) );
+    for( BlockArray::iterator e = blocks.begin(); e != blocks.end(); ++e ){
+        if( m_pageTbl.IsMapped( e->addr ) ){
+            THROW_RUNTIME_ERROR( "The specified target address is already mapped." );
+        }
+    }
+
+    // A host page may be larger than a target page, and an offset passed to
+    // the host must be aligned to a host page.
+    u64 hostPageSize = (u64)posix_getpagesize();
+    u64 hostOffset = offset & ~( hostPageSize - 1 );
+    size_t hostSize = (size_t)( offset - hostOffset + size );
+    u8* hostAddr = static_cast<u8*>( posix_mmap_private( hostFD, (s64)hostOffset, hostSize ) );
+    if( !hostAddr ){
+        return false;
+    }
+
+    HostFileMapping mapping;
+    mapping.hostAddr = hostAddr;
+    mapping.hostSize = hostSize;
+    mapping.pages.reserve( blocks.size() );
+
+    // Pages are shared with the host mapping, and so the contents of the file 
+    // are not copied until they are written.
+    u8* ptr = hostAddr + ( offset - hostOffset );
+    for( BlockArray::iterator e = blocks.begin(); e != blocks.end(); ++e ){
+        m_pageTbl.AddMap( e->addr, ptr, attr );
+        mapping.pages.push_back( m_pageTbl.AddPageReference( e->addr ) );
+        ptr += pageSize;
+    }
+    m_hostFileMappings.push_back( mapping );
+    return true;
+}
+
+void VirtualMemory::ReleaseUnusedHostFileMappings()
+{
+    list<HostFileMapping>::iterator i = m_hostFileMappings.begin();
+    while( i != m_hostFileMappings.end() ){
+        // A page only referred from the mapping is unmapped or copied on write.
+        bool used = false;
+        for( vector<PhysicalMemoryPage*>::iterator p = i->pages.begin(); p != i->pages.end(); ++p ){
+            if( (*p)->refCount > 1 ){
+                used = true;
+                break;
+            }
+        }
+        if( used ){
+            ++i;
+            continue;
+        }
+
+        for( vector<PhysicalMemoryPage*>::iterator p = i->pages.begin(); p != i->pages.end(); ++p ){
+            m_pageTbl.ReleasePageReference( *p );
+        }
+        posix_munmap( i->hostAddr, i->hostSize );
+        i = m_hostFileMappings.erase( i );
+    }
+}
+
 bool VirtualMemory::IsAssigned(u64 addr, u64 size) const
 {
     // If `size' is large, implementation using SplitAtMapUnitBoundary is very inefficient.
@@ -662,3 +856,82 @@ bool VirtualMemory::IsAssigned(u64 addr, u64 size) const
     }
     return true;
 }
+
+// Each logical page is saved as (address, attribute, physical page index).
+// The contents of a physical page follow its first reference, and
+// the contents of a zero-filled page are omitted.
+void VirtualMemory::SaveState( CheckpointWriter* writer )
+{
+    vector<u64> addrs;
+    m_pageTbl.GetMappedAddresses( &addrs );
+
+    size_t pageSize = (size_t)GetPageSize();
+    map<PhysicalMemoryPage*, u32> phyPageIndex;
+
+    writer->Write( (u64)addrs.size() );
+    for( vector<u64>::iterator i = addrs.begin(); i != addrs.end(); ++i ){
+        PageTableEntry page;
+        m_pageTbl.GetMap( *i, &page );
+        writer->Write( *i );
+        writer->Write( page.attr );
+
+        map<PhysicalMemoryPage*, u32>::iterator e = phyPageIndex.find( page.phyPage );
+        if( e != phyPageIndex.end() ){
+            writer->Write( e->second );
+            continue;
+        }
+
+        u32 index = (u32)phyPageIndex.size();
+        phyPageIndex[ page.phyPage ] = index;
+        writer->Write( index );
+
+        const u8* ptr = page.phyPage->ptr;
+        bool zeroFilled = true;
+        for( size_t offset = 0; offset < pageSize; offset++ ){
+            if( ptr[offset] != 0 ){
+                zeroFilled = false;
+                break;
+            }
+        }
+        writer->Write( (u8)zeroFilled );
+        if( !zeroFilled ){
+            writer->WriteBytes( ptr, pageSize );
+        }
+    }
+}
+
+void VirtualMemory::RestoreState( CheckpointReader* reader )
+{
+    // Release all the pages assigned at the process creation.
+    vector<u64> addrs;
+    m_pageTbl.GetMappedAddresses( &addrs );
+    for( vector<u64>::iterator i = addrs.begin(); i != addrs.end(); ++i ){
+        FreePhysicalMemory( *i );
+    }
+    ReleaseUnusedHostFileMappings();
+
+    // The first logical address of each physical page
+    vector<u64> phyPageAddr;
+
+    u64 count = reader->Read<u64>();
+    for( u64 i = 0; i < count; i++ ){
+        u64 addr = reader->Read<u64>();
+        VIRTUAL_MEMORY_ATTR_TYPE attr = reader->Read<VIRTUAL_MEMORY_ATTR_TYPE>();
+        u32 index = reader->Read<u32>();
+
+        if( index < phyPageAddr.size() ){
+            SetPhysicalMemoryMapping( addr, phyPageAddr[index], attr );
+            continue;
+        }
+        if( index != phyPageAddr.size() ){
+            THROW_RUNTIME_ERROR( "A checkpoint file is broken. An invalid physical page index is found." );
+        }
+
+        phyPageAddr.push_back( addr );
+        AssignPhysicalMemory( addr, attr );
+        bool zeroFilled = reader->Read<u8>() != 0;
+        if( !zeroFilled ){
+            reader->ReadBytes( m_pageTbl.TargetToHost( addr ), (size_t)GetPageSize() );
+        }
+    }
+}
@@ -33,6 +33,7 @@
 #define __EMULATORUTILITY_VIRTUAL_MEMORY_H__
 
 #include "Emu/Utility/System/Memory/HeapAllocator.h"
+#include "SysDeps/Endian.h"
 
 
 namespace Onikiri {
@@ -63,22 +64,37 @@ namespace Onikiri {
             VIRTUAL_MEMORY_ATTR_TYPE attr;      // Page attribute
         };
 
-        // 1-entry TLB
+        // A direct-mapped TLB in front of a page table.
         class TLB
         {
-        protected:
-            u64   m_addr;
-            bool  m_valid;
-            PageTableEntry m_body;
-            u64 m_offsetBits;
-            u64 m_addrMask;
-
         public:
+            // The number of entries, which must be a power of 2.
+            static const int TLB_ENTRY_COUNT = 256;
+
             TLB( int offsetBits );
             ~TLB();
+
+            // Returns a cached entry of a page including 'addr' or NULL on a miss.
+            const PageTableEntry* Lookup( u64 addr ) const
+            {
+                const Entry& entry = m_entries[ ( addr >> m_offsetBits ) & ( TLB_ENTRY_COUNT - 1 ) ];
+                return entry.addr == ( addr & m_addrMask ) ? &entry.body : NULL;
+            }
+
             bool Lookup( u64 addr, PageTableEntry* entry ) const;
             void Write( u64 addr, const PageTableEntry& entry ); 
+            void Invalidate( u64 addr );
             void Flush();
+
+        protected:
+            struct Entry
+            {
+                u64 addr;   // An address of a page. This has non-zero offset bits if invalid.
+                PageTableEntry body;
+            };
+            Entry m_entries[ TLB_ENTRY_COUNT ];
+            u64 m_offsetBits;
+            u64 m_addrMask;
         };
 
         // target のアドレスから host のアドレスへの変換を行うクラス
@@ -114,6 +130,13 @@ namespace Onikiri {
             bool GetMap( u64 targetAddr, PageTableEntry* page );
             bool SetMap( u64 targetAddr, const PageTableEntry& page );
 
+            // Look up an entry in the TLB for the fast path of memory accesses.
+            // NULL is returned on a TLB miss.
+            const PageTableEntry* LookupTLB( u64 targetAddr ) const
+            {
+                return m_tlb.Lookup( targetAddr );
+            }
+
             // Get a reference count of a page including targetAddr
             int GetPageReferenceCount( u64 targetAddr ); 
 
@@ -121,21 +144,44 @@ namespace Onikiri {
             // 返り値は解除後のリファレンスカウント
             int RemoveMap(u64 targetAddr);
 
+            // Add a reference to a physical page of targetAddr that is held outside the page table.
+            // The reference is released by ReleasePageReference.
+            PhysicalMemoryPage* AddPageReference( u64 targetAddr );
+            void ReleasePageReference( PhysicalMemoryPage* phyPage );
+
+            // Get the addresses of all the mapped pages in ascending order.
+            void GetMappedAddresses(std::vector<u64>* addrs) const;
+
         private:
-            class AddrHash
+            // The page table is a radix tree with PAGE_TABLE_LEVELS levels.
+            // A page number is divided into PAGE_TABLE_LEVELS fields of 
+            // m_levelBits bits from the most significant one. Each interior 
+            // node is an array of pointers to its children and each leaf node
+            // is an array of PageTableEntry. Unmapped entries have NULL 'phyPage'.
+            static const int PAGE_TABLE_LEVELS = 4;
+            int m_levelBits;
+            void** m_root;
+
+            // Returns a leaf entry of 'targetAddr' or NULL if its leaf node does not exist.
+            PageTableEntry* FindEntry( u64 targetAddr ) const;
+
+            // Returns a leaf entry of 'targetAddr', creating nodes on the path.
+            PageTableEntry* GetEntry( u64 targetAddr );
+
+            int GetNodeIndex( u64 targetAddr, int level ) const
             {
-            private:
-                int m_offsetBits;
-            public:
-                explicit AddrHash(int offsetBits) : m_offsetBits(offsetBits) {}
-
-                size_t operator()(const u64 value) const
-                {
-                    return (size_t)(value >> m_offsetBits);
-                }
-            };
-            typedef unordered_map<u64, PageTableEntry, AddrHash > map_type;
-            map_type m_map;
+                int shift = m_offsetBits + ( PAGE_TABLE_LEVELS - 1 - level ) * m_levelBits;
+                return (int)( ( targetAddr >> shift ) & ( ( (u64)1 << m_levelBits ) - 1 ) );
+            }
+
+            // Visit the mapped entries under 'node' in ascending order of addresses.
+            template <typename Visitor>
+            void VisitEntries( void** node, int level, u64 baseAddr, Visitor* visitor ) const;
+
+            // Release nodes under 'node'.
+            void ReleaseNode( void** node, int level );
+
+            size_t m_mappedCount;
             int m_offsetBits;
             u64 m_offsetMask;
             TLB m_tlb;
@@ -150,8 +196,77 @@ namespace Onikiri {
             ~VirtualMemory();
 
             // メモリ読み書き
-            void ReadMemory( MemAccess* access );
-            void WriteMemory( MemAccess* access );
+            // Aligned accesses to pages in the TLB are processed inline, and
+            // the others are processed in ReadMemoryBody/WriteMemoryBody.
+            void ReadMemory( MemAccess* access )
+            {
+                u64 addr = access->address.address;
+                const PageTableEntry* page = m_pageTbl.LookupTLB( addr );
+                if( page && 
+                    ( addr & ( access->size - 1 ) ) == 0 &&
+                    ( page->attr & VIRTUAL_MEMORY_ATTR_READ )
+                ){
+                    const u8* ptr = page->phyPage->ptr + ( addr & ~m_pageTbl.GetOffsetMask() );
+                    switch( access->size ){
+                    case 1:
+                        access->value = access->sign ?
+                            (u64)(s64)*(const s8*)ptr : 
+                            (u64)*(const u8*)ptr;
+                        access->result = MemAccess::MAR_SUCCESS;
+                        return;
+                    case 2:
+                        access->value = access->sign ?
+                            (u64)(s64)EndianSpecifiedToHost( *(const s16*)ptr, m_bigEndian ) : 
+                            (u64)EndianSpecifiedToHost( *(const u16*)ptr, m_bigEndian );
+                        access->result = MemAccess::MAR_SUCCESS;
+                        return;
+                    case 4:
+                        access->value = access->sign ?
+                            (u64)(s64)EndianSpecifiedToHost( *(const s32*)ptr, m_bigEndian ) : 
+                            (u64)EndianSpecifiedToHost( *(const u32*)ptr, m_bigEndian );
+                        access->result = MemAccess::MAR_SUCCESS;
+                        return;
+                    case 8:
+                        access->value = EndianSpecifiedToHost( *(const u64*)ptr, m_bigEndian );
+                        access->result = MemAccess::MAR_SUCCESS;
+                        return;
+                    }
+                }
+                ReadMemoryBody( access );
+            }
+
+            // A write to a page shared for copy-on-write is not processed inline.
+            void WriteMemory( MemAccess* access )
+            {
+                u64 addr = access->address.address;
+                const PageTableEntry* page = m_pageTbl.LookupTLB( addr );
+                if( page && 
+                    ( addr & ( access->size - 1 ) ) == 0 &&
+                    ( page->attr & VIRTUAL_MEMORY_ATTR_WRITE ) &&
+                    page->phyPage->refCount == 1
+                ){
+                    u8* ptr = page->phyPage->ptr + ( addr & ~m_pageTbl.GetOffsetMask() );
+                    switch( access->size ){
+                    case 1:
+                        *(u8*)ptr = (u8)access->value;
+                        access->result = MemAccess::MAR_SUCCESS;
+                        return;
+                    case 2:
+                        *(u16*)ptr = EndianHostToSpecified( (u16)access->value, m_bigEndian );
+                        access->result = MemAccess::MAR_SUCCESS;
+                        return;
+                    case 4:
+                        *(u32*)ptr = EndianHostToSpecified( (u32)access->value, m_bigEndian );
+                        access->result = MemAccess::MAR_SUCCESS;
+                        return;
+                    case 8:
+                        *(u64*)ptr = EndianHostToSpecified( (u64)access->value, m_bigEndian );
+                        access->result = MemAccess::MAR_SUCCESS;
+                        return;
+                    }
+                }
+                WriteMemoryBody( access );
+            }
 
             //
             // Helper methods for memory access.
@@ -197,6 +312,12 @@ namespace Onikiri {
             // Return whether copy-on-write is done or not.
             bool CopyPageOnWrite( u64 addr );
 
+            // Map [addr, addr+size) to the contents of a host file from 'offset' without copying them.
+            // The pages share a read-only host mapping of the file and are copied on a first write, 
+            // so writes are private to the target. The file must have data at least [offset, offset+size).
+            // Returns false if the host cannot map the file.
+            bool MapHostFile( u64 addr, u64 size, int hostFD, u64 offset, VIRTUAL_MEMORY_ATTR_TYPE attr );
+
             // ビッグエンディアンかどうか
             bool IsBigEndian() const {
                 return m_bigEndian;
@@ -205,7 +326,16 @@ namespace Onikiri {
             // Returns whether [addr, addr+size) in the target memory space are all assigned or not.
             bool IsAssigned(u64 addr, u64 size) const;
 
+            // Save/restore the page table and the contents of all the pages for checkpointing.
+            // Physical pages shared by copy-on-write are kept shared after restoration.
+            void SaveState( CheckpointWriter* writer );
+            void RestoreState( CheckpointReader* reader );
+
         private:
+            // Memory accesses that are not processed in the fast paths.
+            void ReadMemoryBody( MemAccess* access );
+            void WriteMemoryBody( MemAccess* access );
+
             // addr から size バイトのメモリ領域を，マップ単位境界で分割する
             // 結果は，MemoryBlockのコンテナへのイテレータ Iter を通して格納する
             // 戻り値は分割された個数
@@ -220,6 +350,21 @@ namespace Onikiri {
             };
             typedef std::vector<MemoryBlock> BlockArray;
 
+            // A read-only host mapping of a file mapped by MapHostFile.
+            // The mapping holds an extra reference to each of its physical pages,
+            // so a write to the pages always causes copy-on-write and the pages 
+            // are not returned to m_pool when they are unmapped.
+            struct HostFileMapping
+            {
+                u8* hostAddr;
+                size_t hostSize;
+                std::vector<PhysicalMemoryPage*> pages;
+            };
+            std::list<HostFileMapping> m_hostFileMappings;
+
+            // Unmap host file mappings whose pages are no longer mapped in the target.
+            void ReleaseUnusedHostFileMappings();
+
             // PageTable & FreeList
             PageTable m_pageTbl;
             boost::pool<> m_pool;
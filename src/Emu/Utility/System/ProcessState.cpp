@@ -35,6 +35,7 @@
 
 #include "Env/Env.h"
 #include "SysDeps/posix.h"
+#include "Utility/CheckpointStream.h"
 
 #include "Emu/Utility/System/VirtualPath.h"
 #include "Emu/Utility/System/VirtualSystem.h"
@@ -162,6 +163,43 @@ u64 ProcessState::GetControlRegister(u64 index)
     return m_controlRegs.at((size_t)index);
 }
 
+void ProcessState::SaveState(CheckpointWriter* writer)
+{
+    writer->Write(m_threadUniqueValue);
+
+    // Only non-zero control registers are saved because most of them are 0.
+    u64 count = 0;
+    for (size_t i = 0; i < MAX_CONTROL_REGISTER_NUM; i++) {
+        if (m_controlRegs[i] != 0)
+            count++;
+    }
+    writer->Write(count);
+    for (size_t i = 0; i < MAX_CONTROL_REGISTER_NUM; i++) {
+        if (m_controlRegs[i] != 0) {
+            writer->Write((u64)i);
+            writer->Write(m_controlRegs[i]);
+        }
+    }
+
+    m_memorySystem->SaveState(writer);
+    m_virtualSystem->SaveState(writer);
+}
+
+void ProcessState::RestoreState(CheckpointReader* reader)
+{
+    m_threadUniqueValue = reader->Read<u64>();
+
+    m_controlRegs.fill(0);
+    u64 count = reader->Read<u64>();
+    for (u64 i = 0; i < count; i++) {
+        u64 index = reader->Read<u64>();
+        SetControlRegister(index, reader->Read<u64>());
+    }
+
+    m_memorySystem->RestoreState(reader);
+    m_virtualSystem->RestoreState(reader);
+}
+
 void ProcessState::Init(
     const ProcessCreateParam& pcp, 
     SystemIF* simSystem,
@@ -302,6 +340,7 @@ void ProcessState::InitTargetStdIO(const ProcessCreateParam& pcp)
             m_autoCloseFile.push_back(fp);
             m_virtualSystem->AddFDMap(std_fd[i], posix_fileno(fp), filename, false);
             m_virtualSystem->GetDelayUnlinker()->AddMap(std_fd[i], filename);
+            m_virtualSystem->SetFDOpenFlags(std_fd[i], (i == 0) ? POSIX_O_RDONLY : POSIX_O_WRONLY);
         }
     }
 }
@@ -144,6 +144,12 @@ namespace Onikiri {
             void SetControlRegister(u64 index, u64 value);
             u64 GetControlRegister(u64 index);
 
+            // Save/restore the process state for checkpointing.
+            // RestoreState() must be called on a process initialized 
+            // with the same ProcessCreateParam.
+            void SaveState(CheckpointWriter* writer);
+            void RestoreState(CheckpointReader* reader);
+
         private:
             void Init(const ProcessCreateParam& pcp, SystemIF* simSystem, SyscallConvIF* syscallConv, LoaderIF* loader, bool bigEndian);
             void InitMemoryMap(const ProcessCreateParam& createParam);
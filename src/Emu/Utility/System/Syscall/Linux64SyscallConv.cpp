@@ -247,11 +247,22 @@ void Linux64SyscallConv::syscall_brk(OpEmulationState* opState)
 void Linux64SyscallConv::syscall_mmap(OpEmulationState* opState)
 {
     u64 result;
-    if (!(m_args[4] & Get_MAP_ANONYMOUS())) {
-        result = (u64)-1;
+    if (m_args[4] & Get_MAP_ANONYMOUS()) {
+        result = GetMemorySystem()->MMap(m_args[1], m_args[2]);
+    }
+    else if (m_args[4] & Get_MAP_PRIVATE()) {
+        // A private file mapping shares the file contents with a host mapping
+        // until they are written. A shared file mapping is not supported because 
+        // writes to it must be reflected to the file.
+        int hostFD = GetVirtualSystem()->FDTargetToHost((int)m_args[5]);
+        if (hostFD == FDConv::InvalidFD) {
+            SetResult(false, EBADF);
+            return;
+        }
+        result = GetMemorySystem()->MMapFile(m_args[1], m_args[2], hostFD, m_args[6]);
     }
     else {
-        result = GetMemorySystem()->MMap(m_args[1], m_args[2]);
+        result = (u64)-1;
     }
 
     if (result == (u64)-1)
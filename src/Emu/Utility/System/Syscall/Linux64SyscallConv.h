@@ -181,6 +181,7 @@ namespace Onikiri {
             // concversion
             virtual void write_stat64(u64 dest, const EmulatorUtility::HostStat &src);
             virtual int Get_MAP_ANONYMOUS() = 0;
+            virtual int Get_MAP_PRIVATE() = 0;
             virtual int Get_MREMAP_MAYMOVE() = 0;
             virtual int Get_CLK_TCK() = 0;
 
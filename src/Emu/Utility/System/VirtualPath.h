@@ -74,6 +74,12 @@ namespace EmulatorUtility {
         // 現在の仮想パス上での path の仮想でのパスを返す
         String CompleteInGuest(const String& path) const;
 
+        // 相対仮想パスを返す
+        const String& GetVirtualPath() const
+        {
+            return m_virtualPath;
+        }
+
 
     protected:
         String m_virtualPath;   // e.g. test.txt
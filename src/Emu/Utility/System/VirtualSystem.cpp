@@ -31,6 +31,7 @@
 
 #include <pch.h>
 #include "Emu/Utility/System/VirtualSystem.h"
+#include "Utility/CheckpointStream.h"
 
 using namespace std;
 using namespace boost;
@@ -84,7 +85,7 @@ bool FDConv::AddMap(int targetFD, int hostFD, const String& hostFileName)
         return false;
 
     if ((size_t)targetFD >= m_FDTargetToHostTable.size())
-        ExtendFDMap();
+        ExtendFDMap(std::max(m_FDTargetToHostTable.size()*2, (size_t)targetFD + 1));
 
     m_FDTargetToHostTable[targetFD] = hostFD;
 
@@ -132,6 +133,15 @@ FDConv::FileContext& FDConv::GetContext(int targetFD)
     return m_targetFD_ContextMap[targetFD];
 }
 
+void FDConv::GetMappedTargetFDs(std::vector<int>* targetFDs) const
+{
+    targetFDs->clear();
+    for (size_t i = 0; i < m_FDTargetToHostTable.size(); i++) {
+        if (m_FDTargetToHostTable[i] != InvalidFD)
+            targetFDs->push_back((int)i);
+    }
+}
+
 // m_FDTargetToHostTable のサイズを大きくする
 void FDConv::ExtendFDMap()
 {
@@ -363,6 +373,7 @@ int VirtualSystem::Open(const char* filename, int oflag)
     int targetFD = m_fdConv.GetFirstFreeFD();
     AddFDMap(targetFD, hostFD, hostFileName, true);
     m_delayUnlinker.AddMap(targetFD, hostFileName);
+    m_fdConv.GetContext(targetFD).openFlags = oflag;
 
 
     // Open a directory stream.
@@ -381,8 +392,10 @@ int VirtualSystem::Dup(int fd)
     if (dupHostFD != -1) {
         int targetFD = m_fdConv.GetFirstFreeFD();
         String hostFileName = m_fdConv.GetContext(fd).hostFileName;
+        int openFlags = m_fdConv.GetContext(fd).openFlags;
         AddFDMap(targetFD, dupHostFD, hostFileName, true);
         m_delayUnlinker.AddMap(targetFD, hostFileName);
+        m_fdConv.GetContext(targetFD).openFlags = openFlags;
         return targetFD;
     }
     else {
@@ -554,6 +567,172 @@ int VirtualSystem::GetDents(int targetFD, HostDirent* dirent)
     return 1;
 }
 
+// Whether a target FD is stdout/stderr redirected to a host file or not.
+// Such a file is truncated when a process is created, so its content written
+// before a checkpoint is saved in the checkpoint.
+static bool IsRedirectedOutput(int targetFD, const String& hostFileName, int openFlags, const String& hostIO_Name)
+{
+    return 
+        targetFD < 3 && 
+        hostFileName != hostIO_Name &&
+        (openFlags & (POSIX_O_WRONLY | POSIX_O_RDWR)) != 0;
+}
+
+void VirtualSystem::SaveState(CheckpointWriter* writer)
+{
+    writer->WriteString(m_cwd.GetVirtualPath());
+    writer->Write(m_executedInsnTick);
+
+    vector<int> targetFDs;
+    m_fdConv.GetMappedTargetFDs(&targetFDs);
+    writer->Write((u64)targetFDs.size());
+    for (vector<int>::iterator i = targetFDs.begin(); i != targetFDs.end(); ++i) {
+        int hostFD = m_fdConv.TargetToHost(*i);
+        const FDConv::FileContext& context = m_fdConv.GetContext(*i);
+
+        writer->Write(*i);
+        writer->Write(hostFD);
+        writer->WriteString(context.hostFileName);
+        writer->Write(context.openFlags);
+        // lseek fails (-1) on a terminal or a pipe and such a file is not seeked on restoration.
+        s64 offset = posix_lseek(hostFD, 0, POSIX_SEEK_CUR);
+        writer->Write(offset);
+
+        vector<char> prefix;
+        if (offset > 0 && IsRedirectedOutput(*i, context.hostFileName, context.openFlags, GetHostIO_Name())) {
+            prefix.resize((size_t)offset);
+            int readFD = posix_open(context.hostFileName.c_str(), POSIX_O_RDONLY);
+            size_t size = 0;
+            while (readFD != -1 && size < prefix.size()) {
+                int n = posix_read(readFD, &prefix[size], (unsigned int)std::min(prefix.size() - size, (size_t)INT_MAX));
+                if (n <= 0)
+                    break;
+                size += n;
+            }
+            if (readFD != -1) {
+                posix_close(readFD);
+            }
+            if (size != prefix.size()) {
+                THROW_RUNTIME_ERROR("Cannot read '%s' on saving a checkpoint.", context.hostFileName.c_str());
+            }
+        }
+        writer->WriteVector(prefix);
+
+        writer->Write((u64)context.dirStream.size());
+        for (deque<HostDirent>::const_iterator e = context.dirStream.begin(); e != context.dirStream.end(); ++e) {
+            writer->WriteString(e->name);
+            writer->Write(e->ino);
+            writer->Write(e->isDir);
+        }
+    }
+}
+
+void VirtualSystem::RestoreState(CheckpointReader* reader)
+{
+    m_cwd.SetVirtualPath(reader->ReadString());
+    m_executedInsnTick = reader->Read<u64>();
+
+    // Close files opened after the process creation.
+    vector<int> targetFDs;
+    m_fdConv.GetMappedTargetFDs(&targetFDs);
+    for (vector<int>::iterator i = targetFDs.begin(); i != targetFDs.end(); ++i) {
+        Close(*i);
+    }
+
+    u64 count = reader->Read<u64>();
+    for (u64 i = 0; i < count; i++) {
+        int targetFD = reader->Read<int>();
+        int savedHostFD = reader->Read<int>();
+        String hostFileName = reader->ReadString();
+        int openFlags = reader->Read<int>();
+        s64 offset = reader->Read<s64>();
+        vector<char> prefix;
+        reader->ReadVector(&prefix);
+
+        int hostFD;
+        if (targetFD < 3) {
+            // stdin/stdout/stderr are already connected in ProcessState.
+            hostFD = m_fdConv.TargetToHost(targetFD);
+        }
+        else {
+            if (hostFileName == GetHostIO_Name()) {
+                // A duplicate of host stdin/stdout/stderr
+                hostFD = posix_dup(savedHostFD);
+            }
+            else {
+                int flags = openFlags & ~(POSIX_O_CREAT | POSIX_O_EXCL | POSIX_O_TRUNC);
+                hostFD = posix_open(hostFileName.c_str(), flags, POSIX_S_IWRITE | POSIX_S_IREAD);
+            }
+            if (hostFD == -1) {
+                THROW_RUNTIME_ERROR("Cannot reopen '%s' on restoring a checkpoint.", hostFileName.c_str());
+            }
+            AddFDMap(targetFD, hostFD, hostFileName, true);
+            m_delayUnlinker.AddMap(targetFD, hostFileName);
+        }
+
+        // Redirected stdout/stderr have been truncated on the process creation,
+        // so their content before the checkpoint is written back.
+        if (!prefix.empty() && IsRedirectedOutput(targetFD, m_fdConv.GetContext(targetFD).hostFileName, openFlags, GetHostIO_Name())) {
+            posix_lseek(hostFD, 0, POSIX_SEEK_SET);
+            size_t size = 0;
+            while (size < prefix.size()) {
+                int n = posix_write(hostFD, &prefix[size], (unsigned int)std::min(prefix.size() - size, (size_t)INT_MAX));
+                if (n <= 0) {
+                    THROW_RUNTIME_ERROR("Cannot write '%s' on restoring a checkpoint.", hostFileName.c_str());
+                }
+                size += n;
+            }
+        }
+
+        if (offset >= 0 && hostFileName != GetHostIO_Name()) {
+            posix_lseek(hostFD, offset, POSIX_SEEK_SET);
+        }
+
+        FDConv::FileContext* context = &m_fdConv.GetContext(targetFD);
+        context->openFlags = openFlags;
+        context->dirStream.clear();
+        u64 direntCount = reader->Read<u64>();
+        for (u64 j = 0; j < direntCount; j++) {
+            HostDirent dirent;
+            dirent.name = reader->ReadString();
+            dirent.ino = reader->Read<u64>();
+            dirent.isDir = reader->Read<bool>();
+            context->dirStream.push_back(dirent);
+        }
+    }
+}
+
+void VirtualSystem::ReopenFiles()
+{
+    vector<int> targetFDs;
+    m_fdConv.GetMappedTargetFDs(&targetFDs);
+    for (vector<int>::iterator i = targetFDs.begin(); i != targetFDs.end(); ++i) {
+        int hostFD = m_fdConv.TargetToHost(*i);
+        const FDConv::FileContext& context = m_fdConv.GetContext(*i);
+
+        // Host stdin/stdout/stderr cannot be reopened and are shared.
+        if (context.hostFileName == GetHostIO_Name())
+            continue;
+
+        int flags = context.openFlags & ~(POSIX_O_CREAT | POSIX_O_EXCL | POSIX_O_TRUNC);
+        int newHostFD = posix_open(context.hostFileName.c_str(), flags, POSIX_S_IWRITE | POSIX_S_IREAD);
+        if (newHostFD == -1) {
+            THROW_RUNTIME_ERROR("Cannot reopen '%s' in a forked process.", context.hostFileName.c_str());
+        }
+        s64 offset = posix_lseek(hostFD, 0, POSIX_SEEK_CUR);
+        if (offset >= 0) {
+            posix_lseek(newHostFD, offset, POSIX_SEEK_SET);
+        }
+
+        // The host FD is kept, because redirected stdin/stdout/stderr are 
+        // owned and closed by ProcessState.
+        if (posix_dup2(newHostFD, hostFD) == -1) {
+            THROW_RUNTIME_ERROR("Cannot reopen '%s' in a forked process.", context.hostFileName.c_str());
+        }
+        posix_close(newHostFD);
+    }
+}
+
 String VirtualSystem::GetHostPath(const char* targetPath)
 {
     return m_cwd.CompleteInHost(targetPath);
@@ -61,10 +61,12 @@ namespace Onikiri {
             struct FileContext
             {
                 String hostFileName;
+                int openFlags;  // Flags passed to open()
                 std::deque<HostDirent> dirStream;
                 FileContext()
                 {
                     hostFileName = "";
+                    openFlags = 0;
                 }
             };
 
@@ -86,6 +88,9 @@ namespace Onikiri {
 
             // Get file context from target FD
             FileContext& GetContext(int targetFD);
+
+            // Get all the target FDs that are mapped to host FDs
+            void GetMappedTargetFDs(std::vector<int>* targetFDs) const;
         private:
             void ExtendFDMap();
             void ExtendFDMap(size_t size);
@@ -191,6 +196,10 @@ namespace Onikiri {
             {
                 return m_fdConv.GetContext(targetFD).hostFileName;
             }
+            void SetFDOpenFlags(int targetFD, int openFlags)
+            {
+                m_fdConv.GetContext(targetFD).openFlags = openFlags;
+            }
             String GetHostIO_Name()
             {
                 return "HostIO";
@@ -216,6 +225,15 @@ namespace Onikiri {
                 return &m_delayUnlinker;
             };
 
+            // Save/restore the working directory, the time and opened files for checkpointing.
+            // Opened files are reopened and seeked to the saved offsets on restoration.
+            void SaveState(CheckpointWriter* writer);
+            void RestoreState(CheckpointReader* reader);
+
+            // Reopen opened files and seek them to their current offsets, so that 
+            // a forked process does not share file offsets with other processes.
+            void ReopenFiles();
+
             BEGIN_PARAM_MAP("/Session/Emulator/System/Time/")
                 PARAM_ENTRY( "@UnixTime",    m_unixTime )
                 PARAM_ENTRY( "@EmulationMode", m_timeEmulationModeStr )
@@ -0,0 +1,207 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+//
+// A translation cache for the fast-forward interpreter.
+// Each basic block is translated into a flat array of ops whose 
+// emulation functions, register indices and immediates are resolved 
+// at translation time. Blocks are chained with their successors,
+// so that the interpreter does not look up a block on each branch.
+//
+
+#ifndef EMU_UTILITY_TRANSLATION_CACHE_H
+#define EMU_UTILITY_TRANSLATION_CACHE_H
+
+namespace Onikiri {
+    namespace EmulatorUtility {
+
+        template <class TOpInfo>
+        class TranslationCache
+        {
+        public:
+            typedef typename TOpInfo::EmulationFunc EmulationFunc;
+
+            // The maximum number of instructions in a block.
+            static const int MaxBlockInsns = 64;
+
+            // A register operand. 'slot' is an operand index in OpEmulationState.
+            struct RegOperand
+            {
+                int slot;
+                int reg;
+            };
+
+            // An immediate operand.
+            struct ImmOperand
+            {
+                int slot;
+                u64 value;
+            };
+
+            // An op with pre-resolved operands.
+            struct TranslatedOp
+            {
+                TOpInfo*      opInfo;
+                EmulationFunc func;
+                bool          lastInInsn;   // The last op of an instruction.
+
+                int srcRegCount;
+                int immCount;
+                int dstRegCount;
+                boost::array<RegOperand, TOpInfo::MaxSrcRegCount> srcRegs;
+                boost::array<ImmOperand, TOpInfo::MaxImmCount>    imms;
+                boost::array<RegOperand, TOpInfo::MaxDstRegCount> dstRegs;
+            };
+
+            struct Block
+            {
+                u64 startAddress;
+                u64 endAddress;     // The address next to the last instruction.
+                std::vector<TranslatedOp> ops;
+
+                // Chained successor blocks. 
+                // [0] is a fall-through block and [1] is the last taken target.
+                Block* successors[2];
+                u64    successorAddresses[2];
+
+                Block( u64 address ) : 
+                    startAddress( address ),
+                    endAddress( address )
+                {
+                    successors[0] = successors[1] = NULL;
+                    successorAddresses[0] = successorAddresses[1] = 0;
+                }
+
+                // Append an op with resolving its operands.
+                void AddOp( TOpInfo* opInfo, bool lastInInsn )
+                {
+                    TranslatedOp op;
+                    op.opInfo = opInfo;
+                    op.func = opInfo->GetEmulationFunc();
+                    op.lastInInsn = lastInInsn;
+
+                    op.immCount = opInfo->GetImmNum();
+                    for( int i = 0; i < op.immCount; i++ ){
+                        op.imms[i].slot  = opInfo->GetImmOpMap(i);
+                        op.imms[i].value = opInfo->GetImm(i);
+                    }
+
+                    op.srcRegCount = opInfo->GetSrcRegNum();
+                    for( int i = 0; i < op.srcRegCount; i++ ){
+                        op.srcRegs[i].slot = opInfo->GetSrcRegOpMap(i);
+                        op.srcRegs[i].reg  = opInfo->GetSrcReg(i);
+                    }
+
+                    op.dstRegCount = opInfo->GetDstRegNum();
+                    for( int i = 0; i < op.dstRegCount; i++ ){
+                        op.dstRegs[i].slot = opInfo->GetDstRegOpMap(i);
+                        op.dstRegs[i].reg  = opInfo->GetDstReg(i);
+                    }
+
+                    ops.push_back( op );
+                }
+            };
+
+            TranslationCache() : m_flushRequested( false )
+            {
+            }
+
+            ~TranslationCache()
+            {
+                Flush();
+            }
+
+            // Returns a block starting at 'address' or NULL if it is not translated.
+            Block* Find( u64 address )
+            {
+                typename BlockMap::iterator i = m_blocks.find( address );
+                return i != m_blocks.end() ? i->second : NULL;
+            }
+
+            // Add a translated block. The cache takes its ownership.
+            void Add( Block* block )
+            {
+                ASSERT( m_blocks.find( block->startAddress ) == m_blocks.end() );
+                m_blocks[ block->startAddress ] = block;
+            }
+
+            // Returns a block that follows 'block' and starts at 'address'.
+            // A found block is chained to 'block'.
+            Block* GetSuccessor( Block* block, u64 address )
+            {
+                if( block->successorAddresses[0] == address && block->successors[0] ){
+                    return block->successors[0];
+                }
+                if( block->successorAddresses[1] == address && block->successors[1] ){
+                    return block->successors[1];
+                }
+
+                Block* successor = Find( address );
+                if( successor ){
+                    int index = ( address == block->endAddress ) ? 0 : 1;
+                    block->successors[index] = successor;
+                    block->successorAddresses[index] = address;
+                }
+                return successor;
+            }
+
+            // A flush is requested when code is overwritten. The interpreter
+            // flushes the cache at a block boundary, because the blocks may be 
+            // in use when the request occurs.
+            void RequestFlush()
+            {
+                m_flushRequested = true;
+            }
+
+            bool IsFlushRequested() const
+            {
+                return m_flushRequested;
+            }
+
+            void Flush()
+            {
+                for( typename BlockMap::iterator i = m_blocks.begin(); i != m_blocks.end(); ++i ){
+                    delete i->second;
+                }
+                m_blocks.clear();
+                m_flushRequested = false;
+            }
+
+        private:
+            typedef unordered_map< u64, Block* > BlockMap;
+            BlockMap m_blocks;
+            bool m_flushRequested;
+        };
+
+    } // namespace EmulatorUtility
+} // namespace Onikiri
+
+#endif
@@ -244,6 +244,11 @@ String Environment::GetHostWorkPath()
     return m_hostWorkPath.Get();
 }
 
+String Environment::GetOutputXMLFileName()
+{
+    return m_outputXMLFileName;
+}
+
 String Environment::GetStartupPath()
 {
     return m_startupPath;
@@ -285,3 +290,17 @@ bool Environment::IsSuppressedInternalMessage()
 {
     return m_suppressInternalMessage;
 };
+
+void Environment::FlushPrint()
+{
+    if( m_outputPrintToSTDOUT )
+        fflush( stdout );
+    else
+        m_outputPrintStream.flush();
+}
+
+void Environment::BeginForkedSession( const String& outputXMLFileName )
+{
+    m_outputXMLFileName = outputXMLFileName;
+    BeginExec();
+}
@@ -126,8 +126,16 @@ namespace Onikiri
         const std::vector<String>& GetCfgXmlFiles();
         String GetStartupPath();
         String GetHostWorkPath();
+        String GetOutputXMLFileName();
 
         bool IsSuppressedInternalMessage();
+
+        // Flush printed messages, e.g. before forking this process.
+        void FlushPrint();
+
+        // Restart the execution period and change the result XML file
+        // in a forked process that writes its own result.
+        void BeginForkedSession( const String& outputXMLFileName );
     };
 
     extern Environment g_env;
@@ -44,6 +44,28 @@
 
 namespace Onikiri {
 
+    class CheckpointWriter;
+    class CheckpointReader;
+
+    // An observer of ops executed in EmulatorIF::Skip().
+    // This is used for functional warming of caches and predictors.
+    class SkipObserverIF {
+
+    public:
+        virtual ~SkipObserverIF() {}
+
+        // Called after each op is executed in Skip().
+        // 'memAccess' is the memory access of the op and is NULL when
+        // the op does not access memory.
+        virtual void OnSkippedOp(
+            const PC& pc,
+            OpInfo* opInfo,
+            bool taken,
+            const PC& takenPC,
+            const MemAccess* memAccess
+        ) = 0;
+    };
+
     // エミュレータのインターフェース
     class EmulatorIF {
 
@@ -79,13 +101,24 @@ namespace Onikiri {
         virtual ISAInfoIF* GetISAInfo() = 0;
 
         // pc から skipCount 命令実行する．実行した後のPCを返す．executedInsnCount, executedOpCountに実際に実行できた命令数とOp数を返す (NULL可)
-        virtual PC Skip(PC pc, u64 skipCount, u64* regArray, u64* executedInsnCount, u64* executedOpCount) = 0;
+        // 'observer' is notified of each executed op if it is not NULL.
+        virtual PC Skip(PC pc, u64 skipCount, u64* regArray, u64* executedInsnCount, u64* executedOpCount, SkipObserverIF* observer) = 0;
 
         // Terminate Skip() 
         virtual void TerminateSkip() = 0;
 
         // 外部命令デコーダをセットする
         virtual void SetExtraOpDecoder( ExtraOpDecoderIF* extraOpDecoder ) = 0;
+
+        // Save/restore the state of a process (memory image, heap, opened files, ...)
+        // to/from a checkpoint. A process is restored on a process that is
+        // created from the same configuration.
+        virtual void SaveProcessState( int pid, CheckpointWriter* writer ) = 0;
+        virtual void RestoreProcessState( int pid, CheckpointReader* reader ) = 0;
+
+        // Reopen the host files used by the processes, so that a forked process
+        // reads and writes them at its own offsets.
+        virtual void ReopenHostFiles() = 0;
     };
 
 }; // namespace Onikiri
@@ -63,6 +63,11 @@ namespace Onikiri
         // エミュレータがtaken/not takenを教える 
         virtual void SetTaken(const bool taken) = 0;
         virtual bool GetTaken() const = 0;
+
+        // The retire ID of an op in a simulated pipeline, which is used for 
+        // matching the op with a trace record. Ops outside of a pipeline 
+        // return -1.
+        virtual s64 GetPipelineRetireID() const { return -1; }
         
     };
 
@@ -49,6 +49,17 @@
 //      >
 //  > table_with_large_associativity.
 //
+// --- 'setassoc_table_strage_soa' compares tags of all ways with SIMD instructions.
+// 'setassoc_table_tag_signature' must be specialized for a non-integral tag type.
+//  shttl::setassoc_table<
+//      CachePair, 
+//      CacheHasher,
+//      shttl::lru_list< Addr, u8 >,
+//      shttl::setassoc_table_strage_soa<       
+//          shttl::setassoc_table_line_base< CachePair >
+//      >
+//  > table_with_simd_lookup.
+//
 
 #ifndef SETASSOC_TABLE_H
 #define SETASSOC_TABLE_H
@@ -60,6 +71,17 @@
 #include <vector>
 #include <map>
 
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define SHTTL_SETASSOC_TABLE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SHTTL_SETASSOC_TABLE_SSE2
+#endif
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
 
 #include "shttl_types.h"
 #include "std_hasher.h"
@@ -761,6 +783,371 @@ namespace shttl
 
     };
 
+    //
+    // Signatures of tags compared in 'setassoc_table_strage_soa'.
+    // Equal tags must have equal signatures, and tags are compared with '=='
+    // only when their signatures are equal, so signatures do not need to be 
+    // unique. Specialize this class for a tag type that cannot be converted
+    // to 'u64'.
+    //
+    template < typename tag_type >
+    struct setassoc_table_tag_signature
+    {
+        static u64 get( const tag_type& tag )
+        {
+            return (u64)tag;
+        }
+    };
+
+    // Returns a bit mask of ways whose signatures equal 'signature' in 
+    // 'signatures[0, way_num)'. 'way_num' must be 64 or less.
+    inline u64 setassoc_table_match_signature( 
+        const u64* signatures, 
+        size_t way_num, 
+        u64 signature 
+    ){
+        u64 mask = 0;
+        size_t w = 0;
+
+    #if defined(SHTTL_SETASSOC_TABLE_AVX2)
+        __m256i key = _mm256_set1_epi64x( (long long)signature );
+        for( ; w + 4 <= way_num; w += 4 ){
+            __m256i sig = _mm256_loadu_si256( (const __m256i*)( signatures + w ) );
+            __m256i eq  = _mm256_cmpeq_epi64( sig, key );
+            mask |= (u64)_mm256_movemask_pd( _mm256_castsi256_pd( eq ) ) << w;
+        }
+    #elif defined(SHTTL_SETASSOC_TABLE_SSE2)
+        // SSE2 does not have 64-bit compare, so the results of 32-bit 
+        // compare of both halves are combined.
+        __m128i key = _mm_set1_epi64x( (long long)signature );
+        for( ; w + 2 <= way_num; w += 2 ){
+            __m128i sig = _mm_loadu_si128( (const __m128i*)( signatures + w ) );
+            __m128i eq  = _mm_cmpeq_epi32( sig, key );
+            eq = _mm_and_si128( eq, _mm_shuffle_epi32( eq, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+            mask |= (u64)_mm_movemask_pd( _mm_castsi128_pd( eq ) ) << w;
+        }
+    #endif
+
+        for( ; w < way_num; w++ ){
+            if( signatures[w] == signature ){
+                mask |= (u64)1 << w;
+            }
+        }
+        return mask;
+    }
+
+    // Returns the position of the lowest set bit. 'mask' must not be 0.
+    inline size_t setassoc_table_lowest_bit( u64 mask )
+    {
+    #if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long pos;
+        _BitScanForward64( &pos, mask );
+        return (size_t)pos;
+    #elif defined(__GNUC__)
+        return (size_t)__builtin_ctzll( mask );
+    #else
+        size_t pos = 0;
+        while( !( mask & 1 ) ){
+            mask >>= 1;
+            pos++;
+        }
+        return pos;
+    #endif
+    }
+
+    //
+    // Cache sets in setassoc_table.
+    // 'setassoc_table_set_soa' and 'setassoc_table_strage_soa' 
+    // work cooperatively.
+    // This class is a version that keeps signatures of tags and 
+    // validness of lines in separate contiguous arrays for each set.
+    // 'find()' compares the signatures of all ways with SIMD instructions, 
+    // and thus this class is fast in a table with large associativity.
+    //
+    template <
+        typename line_type, 
+        typename strage_type 
+    >
+    class setassoc_table_set_soa
+    {
+
+    public:
+
+        typedef typename strage_type::size_type size_type;
+        typedef typename line_type::tag_type    tag_type;
+        typedef typename line_type::value_type  value_type;
+
+        static const size_type invalid_index = strage_type::invalid_index;
+        static const size_type invalid_way   = strage_type::invalid_way;
+
+        setassoc_table_set_soa( 
+            strage_type* lines, 
+            size_type way_num, 
+            size_type index, 
+            size_type offset 
+        ) :
+            m_strage ( lines ),
+            m_way_num( way_num ),
+            m_index  ( index ),
+            m_offset ( offset )
+        {
+        }
+
+        // Finds and returns a way number if its tag equals 'tag'.
+        size_type find( const tag_type tag ) const
+        {
+            return m_strage->find( m_index, tag );
+        }
+
+        // Find and returns an invalid way.
+        size_type find_free_way() const
+        {
+            return m_strage->find_free_way( m_index );
+        }
+
+        // Invalidate 'way'th line.
+        void invalidate( const size_type way )
+        {
+            if( way == invalid_way )
+                return;
+
+            assert_valid_way( way );
+            at( way ).valid = false;
+            m_strage->update_line( m_index, way );
+        }
+
+        bool read( size_type way, line_type* line ) const
+        {
+            if( way == invalid_way )
+                return false;
+
+            assert_valid_way( way );
+            if( line ){
+                *line = at( way );
+            }
+            return at( way ).valid;
+        }
+
+        void write(
+            const size_type way,
+            const tag_type  tag, 
+            const value_type &val = value_type()
+        ){
+            if(way == invalid_way)
+                return;
+
+            assert_valid_way(way);
+            SHTTL_ASSERT( find(tag) == invalid_way || find( tag ) == way );
+
+            at( way ) = line_type( tag, val, true );
+            m_strage->update_line( m_index, way );
+        }
+
+        // Invalidate all lines in this set.
+        void clear()
+        {
+            for( size_type w = 0; w < m_way_num; w++ ){
+                at( w ).valid = false;
+                m_strage->update_line( m_index, w );
+            }
+        }
+
+        line_type& at( size_type way )
+        {
+            return m_strage->at( way + m_offset );
+        }
+
+        const line_type& at( size_type way ) const 
+        {
+            return m_strage->at( way + m_offset );
+        }
+
+    protected:
+
+        strage_type* m_strage;
+        size_type m_way_num;
+        size_type m_index;
+        size_type m_offset;
+
+        void assert_valid_way( size_type way ) const
+        {
+            SHTTL_ASSERT( 0 <= way && way < m_way_num );
+        }
+
+    };
+
+    template < typename line_type >
+    class setassoc_table_strage_soa
+    {
+    public:
+
+        typedef setassoc_table_strage_soa< line_type > this_type;
+        typedef size_t size_type;
+        typedef std::vector<line_type> strage_type;
+        typedef typename line_type::tag_type tag_type;
+        typedef setassoc_table_tag_signature< tag_type > signature_type;
+
+        typedef setassoc_table_set_soa<
+            line_type,
+            this_type
+        > set_type;
+        
+        typedef setassoc_table_set_soa< 
+            const line_type, 
+            const this_type 
+        > const_set_type;
+
+        static const size_type invalid_index = ~((size_type)0);
+        static const size_type invalid_way   = ~((size_type)0);
+
+        // The number of ways whose valid bits are packed to a word.
+        static const size_type mask_ways = 64;
+
+        // Tags are compared without SIMD instructions in a set with 
+        // this number of ways or less.
+        static const size_type scalar_ways = 8;
+
+        line_type& at( size_type index )
+        {
+            return m_body.at( index );
+        }
+
+        const line_type& at( size_type index ) const 
+        {
+            return m_body.at( index );
+        }
+
+        set_type get_set( size_type index )
+        {
+            size_type offset = index*m_way_num;
+            return set_type( 
+                this,
+                m_way_num,
+                index,
+                offset
+            );
+        }
+
+        const_set_type get_set( size_type index ) const
+        {
+            size_type offset = index*m_way_num;
+            return const_set_type( 
+                this,
+                m_way_num,
+                index,
+                offset
+            );
+        }
+
+        // Lines are accessed through 'at()' and a valid flag in a line may be 
+        // reset directly, so a valid bit is used only as a hint and the 
+        // valid flag in a line is always checked.
+        size_type find( size_type index, const tag_type& tag ) const
+        {
+            u64 signature = signature_type::get( tag );
+            size_type offset = index*m_way_num;
+
+            // SIMD compare does not pay in a set with small associativity.
+            if( m_way_num <= scalar_ways ){
+                const u64* signatures = &m_signature[ offset ];
+                for( size_type w = 0; w < m_way_num; w++ ){
+                    if( signatures[w] == signature ){
+                        const line_type& line = m_body[ offset + w ];
+                        if( line.valid && line.tag == tag ){
+                            return w;
+                        }
+                    }
+                }
+                return invalid_way;
+            }
+
+            for( size_type m = 0; m < m_mask_num; m++ ){
+                size_type begin = m*mask_ways;
+                size_type ways  = get_mask_ways( begin );
+                u64 mask = 
+                    setassoc_table_match_signature( 
+                        &m_signature[ offset + begin ], ways, signature 
+                    ) & m_valid[ index*m_mask_num + m ];
+
+                while( mask ){
+                    size_type way = begin + setassoc_table_lowest_bit( mask );
+                    const line_type& line = m_body[ offset + way ];
+                    if( line.valid && line.tag == tag ){
+                        return way;
+                    }
+                    mask &= mask - 1;
+                }
+            }
+            return invalid_way;
+        }
+
+        // Valid bits cannot be used here, because the first invalid way must 
+        // be returned even when its valid flag is reset directly.
+        size_type find_free_way( size_type index ) const
+        {
+            size_type offset = index*m_way_num;
+            for( size_type w = 0; w < m_way_num; w++ ){
+                if( !m_body[ offset + w ].valid ){
+                    return w;
+                }
+            }
+            return invalid_way;
+        }
+
+        // Update a signature and a valid bit from a line.
+        void update_line( size_type index, size_type way )
+        {
+            size_type pos = index*m_way_num + way;
+            const line_type& line = m_body[ pos ];
+            u64& valid = m_valid[ index*m_mask_num + way / mask_ways ];
+            u64  bit   = (u64)1 << ( way % mask_ways );
+            if( line.valid ){
+                m_signature[ pos ] = signature_type::get( line.tag );
+                valid |= bit;
+            }
+            else{
+                valid &= ~bit;
+            }
+        }
+
+        void resize( size_type set_num, size_type way_num )
+        {
+            m_set_num = set_num;
+            m_way_num = way_num;
+            m_mask_num = ( way_num + mask_ways - 1 ) / mask_ways;
+
+            m_body.resize( set_num*way_num, line_type() );
+            m_signature.clear();
+            m_signature.resize( set_num*way_num, 0 );
+            m_valid.clear();
+            m_valid.resize( set_num*m_mask_num, 0 );
+
+            for( size_type index = 0; index < set_num; index++ ){
+                for( size_type way = 0; way < way_num; way++ ){
+                    update_line( index, way );
+                }
+            }
+        }
+
+    protected:
+
+        size_type   m_set_num;
+        size_type   m_way_num;
+        size_type   m_mask_num;     // The number of valid masks in a set.
+        strage_type m_body;
+
+        std::vector<u64> m_signature;   // Signatures of tags.
+        std::vector<u64> m_valid;       // Packed valid bits.
+
+        // Returns the number of ways in a mask beginning from 'begin'.
+        size_type get_mask_ways( size_type begin ) const
+        {
+            size_type ways = m_way_num - begin;
+            return ways < mask_ways ? ways : mask_ways;
+        }
+
+    };
+
     // Line data stored in a table.
     template < typename PairType >
     struct setassoc_table_line_base
@@ -41,13 +41,25 @@ using namespace std;
 
 
 Dependency::Dependency()
-: m_readiness(0, false)
+: m_readiness(0),
+  m_fullReadiness(0)
 {
 }
 
 Dependency::Dependency(int numScheduler)
-: m_readiness(numScheduler, false)
+: m_readiness(0),
+  m_fullReadiness(0)
 {
+    if( numScheduler < 0 || numScheduler > MAX_SCHEDULER_COUNT ){
+        THROW_RUNTIME_ERROR( 
+            "The number of schedulers (%d) exceeds the max number (%d).", 
+            numScheduler, MAX_SCHEDULER_COUNT
+        );
+    }
+    m_fullReadiness = 
+        ( numScheduler == MAX_SCHEDULER_COUNT ) ? 
+            ~(ReadinessType)0 : 
+            ( ( (ReadinessType)1 << numScheduler ) - 1 );
 }
 
 Dependency::~Dependency()
@@ -73,16 +85,16 @@ void Dependency::RemoveConsumer(OpIterator op)
 
 void Dependency::Set()
 {
-    m_readiness.set();
+    m_readiness = m_fullReadiness;
 }
 
 void Dependency::Reset()
 {
-    m_readiness.reset();
+    m_readiness = 0;
 }
 
 void Dependency::Clear()
 {
-    m_readiness.reset();
+    m_readiness = 0;
     m_consumer.clear();
 }
@@ -45,7 +45,10 @@ namespace Onikiri {
     class Dependency 
     {
     public:
-        typedef pool_list<OpIterator> ConsumerListType;
+        // Most dependencies have a few consumers, so consumers are held 
+        // in a dependency itself and are moved to a heap only on overflow.
+        static const int INLINE_CONSUMER_COUNT = 4;
+        typedef small_vector<OpIterator, INLINE_CONSUMER_COUNT> ConsumerListType;
         typedef 
             ConsumerListType::iterator
             ConsumerListIterator;
@@ -74,29 +77,37 @@ namespace Onikiri {
 
         bool GetReadiness( const int index) const
         {
-            return m_readiness.test( index );
+            ASSERT( index >= 0 && index < MAX_SCHEDULER_COUNT );
+            return ( m_readiness & ( (ReadinessType)1 << index ) ) != 0;
         }
 
         bool IsFullyReady() const
         {
-            for( size_t i = 0; i < m_readiness.size(); ++i ){
-                if( !m_readiness.test(i) )
-                    return false;
-            }
-            return true;
+            return m_readiness == m_fullReadiness;
         }
 
         void SetReadiness( const bool readiness, const int index )
         {
-            m_readiness.set( index, readiness );
+            ASSERT( index >= 0 && index < MAX_SCHEDULER_COUNT );
+            ReadinessType bit = (ReadinessType)1 << index;
+            if( readiness ){
+                m_readiness |= bit;
+            }
+            else{
+                m_readiness &= ~bit;
+            }
         }
 
     protected:
+        typedef u64 ReadinessType;
+        static const int MAX_SCHEDULER_COUNT = sizeof(ReadinessType) * 8;
 
         // スケジューラごとに ready かどうかのフラグ
-        boost::dynamic_bitset<
-            u32, boost::fast_pool_allocator<u32> 
-        > m_readiness;  
+        // The i-th bit corresponds to the i-th scheduler.
+        ReadinessType m_readiness;
+
+        // A readiness when all schedulers are ready.
+        ReadinessType m_fullReadiness;
 
         // 依存先の命令
         ConsumerListType    m_consumer;
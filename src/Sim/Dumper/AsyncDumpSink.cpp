@@ -0,0 +1,226 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+#include <pch.h>
+
+#include "Sim/Dumper/AsyncDumpSink.h"
+
+using namespace std;
+using namespace Onikiri;
+
+const size_t AsyncDumpSink::CHUNK_SIZE;
+
+//
+// A writer thread and a bounded queue of chunks.
+// A mutex is taken only once per chunk, so the cost of the lock is 
+// negligible compared with formatting and compressing a chunk.
+//
+class AsyncDumpSink::Writer
+{
+public:
+    Writer( const String& fileName, bool gzipEnabled, int gzipLevel, size_t bufferSize );
+    ~Writer();
+
+    void Write( const char* s, size_t n );
+    void Close();
+
+private:
+    boost::iostreams::filtering_ostream m_stream;  // Accessed only by the writer thread.
+
+    deque< string > m_queue;
+    size_t m_queuedBytes;   // Including a chunk being written.
+    size_t m_bufferSize;
+    bool   m_closed;
+
+    mutex m_mutex;
+    condition_variable m_notEmpty;
+    condition_variable m_notFull;
+    exception_ptr m_exception;
+
+    thread m_thread;
+
+    void WriterMain();
+};
+
+AsyncDumpSink::Writer::Writer( 
+    const String& fileName, 
+    bool gzipEnabled, 
+    int gzipLevel, 
+    size_t bufferSize 
+) :
+    m_queuedBytes( 0 ),
+    m_bufferSize( bufferSize ),
+    m_closed( false )
+{
+    OpenDumpStream( &m_stream, fileName, gzipEnabled, gzipLevel, false, 0 );
+    m_thread = thread( &Writer::WriterMain, this );
+}
+
+AsyncDumpSink::Writer::~Writer()
+{
+    try{
+        Close();
+    }
+    catch( ... ){
+    }
+}
+
+void AsyncDumpSink::Writer::Write( const char* s, size_t n )
+{
+    unique_lock<mutex> lock( m_mutex );
+    
+    // A chunk larger than the buffer is accepted when the queue is empty.
+    while( m_queuedBytes > 0 && m_queuedBytes + n > m_bufferSize && !m_exception ){
+        m_notFull.wait( lock );
+    }
+    if( m_exception ){
+        exception_ptr e = m_exception;
+        m_exception = exception_ptr();
+        rethrow_exception( e );
+    }
+
+    m_queue.push_back( string( s, n ) );
+    m_queuedBytes += n;
+    m_notEmpty.notify_one();
+}
+
+void AsyncDumpSink::Writer::Close()
+{
+    {
+        lock_guard<mutex> lock( m_mutex );
+        if( m_closed ){
+            return;
+        }
+        m_closed = true;
+    }
+    m_notEmpty.notify_one();
+    m_thread.join();
+
+    if( m_exception ){
+        exception_ptr e = m_exception;
+        m_exception = exception_ptr();
+        rethrow_exception( e );
+    }
+}
+
+void AsyncDumpSink::Writer::WriterMain()
+{
+    string chunk;
+    while( true ){
+        {
+            unique_lock<mutex> lock( m_mutex );
+            m_queuedBytes -= chunk.size();
+            m_notFull.notify_one();
+
+            while( m_queue.empty() && !m_closed ){
+                m_notEmpty.wait( lock );
+            }
+            if( m_queue.empty() ){
+                break;
+            }
+            chunk.swap( m_queue.front() );
+            m_queue.pop_front();
+        }
+
+        try{
+            m_stream.write( chunk.data(), chunk.size() );
+        }
+        catch( ... ){
+            // Remaining chunks are discarded after a failure.
+            lock_guard<mutex> lock( m_mutex );
+            if( !m_exception ){
+                m_exception = current_exception();
+            }
+        }
+    }
+
+    // Flush the stream and write a gzip footer.
+    try{
+        m_stream.reset();
+    }
+    catch( ... ){
+        lock_guard<mutex> lock( m_mutex );
+        if( !m_exception ){
+            m_exception = current_exception();
+        }
+    }
+}
+
+//
+// AsyncDumpSink
+//
+AsyncDumpSink::AsyncDumpSink( 
+    const String& fileName, 
+    bool gzipEnabled, 
+    int gzipLevel, 
+    size_t bufferSize 
+) :
+    m_writer( new Writer( fileName, gzipEnabled, gzipLevel, bufferSize ) )
+{
+}
+
+streamsize AsyncDumpSink::write( const char* s, streamsize n )
+{
+    m_writer->Write( s, (size_t)n );
+    return n;
+}
+
+void AsyncDumpSink::close()
+{
+    m_writer->Close();
+}
+
+void Onikiri::OpenDumpStream(
+    boost::iostreams::filtering_ostream* stream,
+    const String& fileName,
+    bool gzipEnabled, 
+    int gzipLevel,
+    bool asyncEnabled,
+    size_t asyncBufferSize
+){
+    if( asyncEnabled ){
+        // The compressor is pushed in the writer thread.
+        stream->push( 
+            AsyncDumpSink( fileName, gzipEnabled, gzipLevel, asyncBufferSize ),
+            AsyncDumpSink::CHUNK_SIZE 
+        );
+        return;
+    }
+
+    if( gzipEnabled ){
+        stream->push( 
+            boost::iostreams::gzip_compressor( 
+                boost::iostreams::gzip_params( gzipLevel ) 
+            )
+        );
+    }
+    stream->push( boost::iostreams::file_sink( fileName, ios::binary ) );
+}
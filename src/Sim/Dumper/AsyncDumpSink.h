@@ -0,0 +1,98 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+//
+// A sink that writes dump text on a background host thread
+//
+
+#ifndef SIM_DUMPER_ASYNC_DUMP_SINK_H
+#define SIM_DUMPER_ASYNC_DUMP_SINK_H
+
+#include "Utility/String.h"
+
+namespace Onikiri
+{
+    // Dumpers format text on the simulation thread and pass it to this sink
+    // through a filtering_ostream. The sink hands the text over to a writer 
+    // thread in large chunks, and the writer thread compresses the text and 
+    // writes it to a file. Only the gzip compression and the file I/O are 
+    // moved off the simulation thread, so output files are the same as those
+    // written synchronously.
+    //
+    // The amount of text that has not been written yet is bounded by 
+    // 'bufferSize'. write() blocks when the writer thread falls behind.
+    class AsyncDumpSink
+    {
+    public:
+        typedef char char_type;
+        struct category : 
+            public boost::iostreams::sink_tag,
+            public boost::iostreams::closable_tag
+        {
+        };
+
+        // The size of chunks passed to the writer thread.
+        static const size_t CHUNK_SIZE = 64 * 1024;
+
+        AsyncDumpSink( 
+            const String& fileName, 
+            bool gzipEnabled, 
+            int gzipLevel, 
+            size_t bufferSize 
+        );
+
+        std::streamsize write( const char* s, std::streamsize n );
+        
+        // Writes all the remaining text and waits for the writer thread.
+        void close();
+
+    private:
+        class Writer;
+
+        // boost::iostreams copies devices, so the copies share a writer.
+        std::shared_ptr< Writer > m_writer;
+    };
+
+    // Pushes a (gzip compressed) file sink to 'stream'. When 'asyncEnabled'
+    // is true, the file is written by AsyncDumpSink.
+    void OpenDumpStream(
+        boost::iostreams::filtering_ostream* stream,
+        const String& fileName,
+        bool gzipEnabled, 
+        int gzipLevel,
+        bool asyncEnabled,
+        size_t asyncBufferSize
+    );
+
+}; // namespace Onikiri
+
+#endif // SIM_DUMPER_ASYNC_DUMP_SINK_H
+
@@ -50,7 +50,9 @@ using namespace Onikiri;
 
 Dumper::Dumper()
 {
+    m_initialized = false;
     m_dumpEnabled = false;
+    m_statDumpEnabled = false;
 }
 
 Dumper::~Dumper()
@@ -85,19 +87,31 @@ void Dumper::CreateThreadDumper(
 }
 
 
+// Joins suffixes of a dump file name.
+static String JoinSuffix( const String& lhs, const String& rhs )
+{
+    if( lhs == "" )
+        return rhs;
+    if( rhs == "" )
+        return lhs;
+    return lhs + "." + rhs;
+}
+
 void Dumper::Initialize(
     PhysicalResourceArray<Core>& coreList,
-    PhysicalResourceArray<Thread>& threadList 
+    PhysicalResourceArray<Thread>& threadList,
+    const String& fileNameSuffix
 ){
     LoadParam();
 
+    m_initialized = true;
     m_dumpEnabled = false;
 
     if( m_dumpEachThread ){
         for( int i = 0; i < threadList.GetSize(); i++ ){
             Thread* thread = threadList[i];
             ThreadDumper dumper;
-            String suffix = "t" + boost::lexical_cast<String>(i);
+            String suffix = JoinSuffix( fileNameSuffix, "t" + boost::lexical_cast<String>(i) );
             CreateThreadDumper( &dumper, suffix, coreList );
             m_dumperMap[thread] = dumper;
         }
@@ -107,7 +121,7 @@ void Dumper::Initialize(
             Core* core = coreList[i];
 
             ThreadDumper dumper;
-            String suffix = "c" + boost::lexical_cast<String>(i);
+            String suffix = JoinSuffix( fileNameSuffix, "c" + boost::lexical_cast<String>(i) );
             CreateThreadDumper( &dumper, suffix, coreList );
 
             for( int j = 0; j < core->GetThreadCount(); j++ ){
@@ -118,12 +132,15 @@ void Dumper::Initialize(
     }
     else{
         ThreadDumper dumper;
-        CreateThreadDumper( &dumper, "", coreList );
+        CreateThreadDumper( &dumper, fileNameSuffix, coreList );
         for( int i = 0; i < threadList.GetSize(); i++ ){
             Thread* thread = threadList[i];
             m_dumperMap[thread] = dumper;
         }
     }
+
+    m_intervalStatDumper.Initialize( m_statCounters, fileNameSuffix );
+    m_statDumpEnabled = m_intervalStatDumper.Enabled();
 }
 
 template <class T> static void DeleteDumper(T*& ptr)
@@ -136,6 +153,13 @@ template <class T> static void DeleteDumper(T*& ptr)
 
 void Dumper::Finalize()
 {
+    // Counters may be registered by resources without initializing dumpers.
+    if( !m_initialized ){
+        m_statCounters.clear();
+        return;
+    }
+    m_initialized = false;
+
     for( DumperList::iterator i = m_dumperList.begin();
         i != m_dumperList.end();
         ++i
@@ -145,9 +169,23 @@ void Dumper::Finalize()
         i->countDumper->Finalize();
     }
     ReleaseDumper();
+
+    m_intervalStatDumper.Finalize();
+    m_statDumpEnabled = false;
+    m_statCounters.clear();
+
     ReleaseParam();
 }
 
+void Dumper::RegisterStatCounter( 
+    PhysicalResourceNode* owner, const char* name, const s64* counter 
+){
+    IntervalStatDumper::Counter entry;
+    entry.name.format( "%s[%d].%s", owner->GetName().c_str(), owner->GetRID(), name );
+    entry.value = counter;
+    m_statCounters.push_back( entry );
+}
+
 void Dumper::ReleaseDumper()
 {
     for( DumperList::iterator i = m_dumperList.begin();
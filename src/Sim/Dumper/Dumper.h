@@ -36,6 +36,7 @@
 #include "Sim/Op/OpArray/OpArray.h"
 #include "Sim/Foundation/Resource/ResourceNode.h"
 #include "Sim/Dumper/DumpState.h"
+#include "Sim/Dumper/IntervalStatDumper.h"
 
 
 namespace Onikiri 
@@ -60,10 +61,17 @@ namespace Onikiri
         DumperMap m_dumperMap;
         DumperList m_dumperList;
 
+        bool m_initialized;
         bool m_dumpEnabled;
         bool m_dumpEachThread;
         bool m_dumpEachCore;
 
+        // Interval statistics are sampled regardless of m_dumpEnabled, 
+        // because op dumps are heavy and are not needed for them.
+        IntervalStatDumper m_intervalStatDumper;
+        IntervalStatDumper::CounterList m_statCounters;
+        bool m_statDumpEnabled;
+
         void DumpImpl(DUMP_STATE state, OpIterator op, int detail);
         void DumpStallBeginImpl(OpIterator op);
         void DumpStallEndImpl(OpIterator op);
@@ -87,9 +95,11 @@ namespace Onikiri
 
         Dumper();
         virtual ~Dumper();
+        // 'fileNameSuffix' is inserted in the names of all the dump files.
         void Initialize( 
             PhysicalResourceArray<Core>& coreList,
-            PhysicalResourceArray<Thread>& threadList 
+            PhysicalResourceArray<Thread>& threadList,
+            const String& fileNameSuffix
         );
         void Finalize();
 
@@ -158,6 +168,32 @@ namespace Onikiri
         {
             SetEnabledImpl( enabled );
         }
+
+        // Register a counter sampled by IntervalStatDumper.
+        // A column is named "<resource name>[<rid>].<name>".
+        // Counters must be registered before Initialize() and are
+        // unregistered in Finalize().
+        void RegisterStatCounter( 
+            PhysicalResourceNode* owner, const char* name, const s64* counter 
+        );
+
+        // Sample the registered counters. This is called at the end of 
+        // each cycle with the total count of retired insns.
+        void SampleStatistics( s64 cycle, s64 insns )
+        {
+            if( !m_statDumpEnabled )
+                return;
+            m_intervalStatDumper.Update( cycle, insns );
+        }
+
+        // The number of idle cycles that can be skipped from 'cycle' 
+        // without passing a sampling point of the counters.
+        s64 GetSkippableCycles( s64 cycle ) const
+        {
+            if( !m_statDumpEnabled )
+                return INT64_MAX;
+            return m_intervalStatDumper.GetCyclesToNextSample( cycle );
+        }
     };
 
     extern Dumper g_dumper;
@@ -0,0 +1,141 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+#include <pch.h>
+
+#include "Sim/Dumper/IntervalStatDumper.h"
+#include "Sim/Dumper/DumpFileName.h"
+#include "Sim/Dumper/AsyncDumpSink.h"
+
+using namespace std;
+using namespace Onikiri;
+
+IntervalStatDumper::IntervalStatDumper()
+{
+    m_enabled = false;
+    m_gzipEnabled = false;
+    m_gzipLevel = 0;
+    m_cycleInterval = 0;
+    m_insnInterval = 0;
+
+    m_curCycle = 0;
+    m_curInsns = 0;
+    m_lastCycle = 0;
+    m_lastInsns = 0;
+    m_nextCycle = INT64_MAX;
+    m_nextInsns = INT64_MAX;
+}
+
+IntervalStatDumper::~IntervalStatDumper()
+{
+}
+
+void IntervalStatDumper::Initialize( const CounterList& counters, const String& fileNameSuffix )
+{
+    LoadParam();
+
+    m_curCycle = 0;
+    m_curInsns = 0;
+    m_lastCycle = 0;
+    m_lastInsns = 0;
+    m_nextCycle = INT64_MAX;
+    m_nextInsns = INT64_MAX;
+
+    if( !m_enabled )
+        return;
+
+    if( m_cycleInterval < 0 || m_insnInterval < 0 ){
+        THROW_RUNTIME_ERROR( "The intervals of IntervalStatDumper must not be negative." );
+    }
+
+    m_counters = counters;
+    m_lastValues.resize( m_counters.size() );
+    for( size_t i = 0; i < m_counters.size(); i++ ){
+        m_lastValues[i] = *m_counters[i].value;
+    }
+    UpdateNextPoint( 0, 0 );
+
+    String fileName = 
+        g_env.GetHostWorkPath() + MakeDumpFileName( m_fileName, fileNameSuffix, m_gzipEnabled );
+    OpenDumpStream( &m_stream, fileName, m_gzipEnabled, m_gzipLevel, false, 0 );
+
+    m_stream << "cycles,insns,interval cycles,interval insns";
+    for( size_t i = 0; i < m_counters.size(); i++ ){
+        m_stream << "," << m_counters[i].name;
+    }
+    m_stream << "\n";
+}
+
+void IntervalStatDumper::Finalize()
+{
+    ReleaseParam();
+
+    if( m_stream.is_complete() ){
+        // The last interval that is not completed.
+        if( m_curCycle > m_lastCycle ){
+            WriteRow( m_curCycle, m_curInsns );
+        }
+        m_stream.reset();
+    }
+    m_counters.clear();
+    m_lastValues.clear();
+}
+
+void IntervalStatDumper::WriteRow( s64 cycle, s64 insns )
+{
+    m_stream << 
+        cycle << "," << 
+        insns << "," << 
+        ( cycle - m_lastCycle ) << "," << 
+        ( insns - m_lastInsns );
+
+    for( size_t i = 0; i < m_counters.size(); i++ ){
+        s64 value = *m_counters[i].value;
+        m_stream << "," << ( value - m_lastValues[i] );
+        m_lastValues[i] = value;
+    }
+    m_stream << "\n";
+
+    m_lastCycle = cycle;
+    m_lastInsns = insns;
+    UpdateNextPoint( cycle, insns );
+}
+
+// Set the next sampling points after 'cycle' and 'insns'.
+void IntervalStatDumper::UpdateNextPoint( s64 cycle, s64 insns )
+{
+    if( m_cycleInterval > 0 ){
+        m_nextCycle = ( cycle / m_cycleInterval + 1 ) * m_cycleInterval;
+    }
+    if( m_insnInterval > 0 ){
+        m_nextInsns = insns + m_insnInterval;
+    }
+}
@@ -0,0 +1,115 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+#ifndef SIM_DUMPER_INTERVAL_STAT_DUMPER_H
+#define SIM_DUMPER_INTERVAL_STAT_DUMPER_H
+
+#include "Types.h"
+#include "Env/Param/ParamExchange.h"
+
+namespace Onikiri 
+{
+    // Samples registered counters periodically and writes one CSV row per 
+    // interval. An interval ends every 'CycleInterval' cycles or every 
+    // 'InsnInterval' retired insns, whichever comes first (0 disables each).
+    // Each row has the cycle/insn counts at the end of the interval, the 
+    // cycles/insns in the interval and the increments of the counters in 
+    // the interval.
+    class IntervalStatDumper : public ParamExchange
+    {
+    public:
+        struct Counter
+        {
+            String name;
+            const s64* value;
+        };
+        typedef std::vector< Counter > CounterList;
+
+        BEGIN_PARAM_MAP( "/Session/Environment/Dumper/IntervalStatDumper/" )
+            PARAM_ENTRY( "@FileName",       m_fileName )
+            PARAM_ENTRY( "@EnableDump",     m_enabled )
+            PARAM_ENTRY( "@EnableGzip",     m_gzipEnabled )
+            PARAM_ENTRY( "@GzipLevel",      m_gzipLevel )
+            PARAM_ENTRY( "@CycleInterval",  m_cycleInterval )
+            PARAM_ENTRY( "@InsnInterval",   m_insnInterval )
+        END_PARAM_MAP()
+
+        IntervalStatDumper();
+        ~IntervalStatDumper();
+
+        void Initialize( const CounterList& counters, const String& fileNameSuffix );
+        void Finalize();
+        bool Enabled() const { return m_enabled; }
+
+        // Called at the end of each simulated cycle.
+        void Update( s64 cycle, s64 insns )
+        {
+            m_curCycle = cycle;
+            m_curInsns = insns;
+            if( cycle >= m_nextCycle || insns >= m_nextInsns ){
+                WriteRow( cycle, insns );
+            }
+        }
+
+        // The number of cycles from 'cycle' to the next sampling point in cycles.
+        // Skipped idle cycles must not pass the point.
+        s64 GetCyclesToNextSample( s64 cycle ) const
+        {
+            return m_nextCycle - cycle;
+        }
+
+    private:
+        bool m_enabled;
+        bool m_gzipEnabled;
+        int  m_gzipLevel;
+        String m_fileName;
+        s64 m_cycleInterval;
+        s64 m_insnInterval;
+
+        boost::iostreams::filtering_ostream m_stream;
+        CounterList m_counters;
+        std::vector< s64 > m_lastValues;
+
+        s64 m_curCycle;
+        s64 m_curInsns;
+        s64 m_lastCycle;
+        s64 m_lastInsns;
+        s64 m_nextCycle;
+        s64 m_nextInsns;
+
+        void WriteRow( s64 cycle, s64 insns );
+        void UpdateNextPoint( s64 cycle, s64 insns );
+    };
+
+}; // namespace Onikiri
+
+#endif // SIM_DUMPER_INTERVAL_STAT_DUMPER_H
+
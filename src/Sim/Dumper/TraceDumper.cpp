@@ -36,6 +36,7 @@
 #include "Utility/RuntimeError.h"
 #include "Sim/Dumper/DumpState.h"
 #include "Sim/Dumper/DumpFileName.h"
+#include "Sim/Dumper/AsyncDumpSink.h"
 #include "Sim/Op/Op.h"
 
 
@@ -51,6 +52,10 @@ TraceDumper::TraceDumper()
     m_cycle = 0;
     m_skipInsns = 0;
     m_flush = false;
+    m_gzipEnabled = false;
+    m_gzipLevel = 0;
+    m_asyncWriteEnabled = false;
+    m_asyncBufferSize = 0;
 }
 
 TraceDumper::~TraceDumper()
@@ -81,14 +86,16 @@ void TraceDumper::Open( const String& suffix )
 
     if( Enabled() && (!m_dumpStream.is_complete()) ) {
         String fileName = g_env.GetHostWorkPath() + MakeDumpFileName( m_filename, suffix, m_gzipEnabled );
-        if (m_gzipEnabled){
-            m_dumpStream.push( 
-                iostreams::gzip_compressor( 
-                    iostreams::gzip_params(m_gzipLevel) 
-                )
-            );
-        }
-        m_dumpStream.push( iostreams::file_sink(fileName, ios::binary));
+        // A dump is written synchronously when it is flushed on each output,
+        // so that the output is not lost when the simulator crashes.
+        OpenDumpStream( 
+            &m_dumpStream, 
+            fileName, 
+            m_gzipEnabled, 
+            m_gzipLevel, 
+            m_asyncWriteEnabled && !m_flush, 
+            (size_t)m_asyncBufferSize 
+        );
     }
 }
 
@@ -49,6 +49,8 @@ namespace Onikiri {
         bool m_gzipEnabled; // Dumpをgzip圧縮するかどうか
         int  m_gzipLevel;   // gzipの圧縮レベル
         bool m_flush;       // 出力毎にフラッシュを行うかどうか
+        bool m_asyncWriteEnabled;   // Compress and write a dump on a background thread.
+        u64  m_asyncBufferSize;     // The maximum bytes of text not written yet.
 
         std::string m_filename;
         boost::iostreams::filtering_ostream m_dumpStream;
@@ -72,6 +74,8 @@ namespace Onikiri {
             PARAM_ENTRY("@GzipLevel",       m_gzipLevel)
             PARAM_ENTRY("@SkipInsns",       m_skipInsns)
             PARAM_ENTRY("@Flush",           m_flush)
+            PARAM_ENTRY("@EnableAsyncWrite",m_asyncWriteEnabled)
+            PARAM_ENTRY("@AsyncBufferSize", m_asyncBufferSize)
         END_PARAM_MAP()
 
         bool Enabled() const { return m_enabled != 0; }
@@ -36,7 +36,10 @@
 #include "Sim/Dumper/DumpState.h"
 #include "Sim/Op/Op.h"
 #include "Sim/Core/Core.h"
+#include "Sim/Memory/Cache/Cache.h"
+#include "Sim/Memory/Cache/CacheSystem.h"
 #include "Sim/Dumper/DumpFileName.h"
+#include "Sim/Dumper/AsyncDumpSink.h"
 #include "Version.h"
 
 using namespace Onikiri;
@@ -70,8 +73,35 @@ VisualizationDumper::VisualizationDumper()
     m_visLastPrintCycle = 0;
     m_visCurrentCycle = 0;
     m_enabled = false;
+    m_gzipEnabled = false;
+    m_gzipLevel = 0;
+    m_asyncWriteEnabled = false;
+    m_asyncBufferSize = 0;
     m_skipInsns = 0;
     m_visSerialID = 0;
+
+    m_captureBeginCycle = 0;
+    m_captureEndCycle = -1;
+    m_captureEndInsns = -1;
+    m_historyCycles = 0;
+    m_postTriggerCycles = 0;
+    m_maxTriggers = 0;
+
+    m_triggerBranchMissCount = 0;
+    m_triggerBranchMissCycles = 0;
+    m_triggerCacheLevel = 0;
+    m_triggerCacheMissRate = 0.0;
+    m_triggerCacheInterval = 0;
+
+    m_triggerMode = false;
+    m_triggerPCEnabled = false;
+    m_triggerPC = 0;
+    m_triggerCount = 0;
+    m_captureUntilCycle = 0;
+    m_chunkCycle = 0;
+    m_lastCacheAccess = 0;
+    m_lastCacheMiss = 0;
+    m_lastCacheCheckCycle = 0;
 }
 
 VisualizationDumper::~VisualizationDumper()
@@ -199,7 +229,7 @@ void VisualizationDumper::PrintOpInit(OpIterator op)
     SetVisSerialID( op, visSerialID );
 
     // Print 'I' command.
-    m_visStream <<
+    Out() <<
         "I\t" << 
         visSerialID             << "\t" <<
         op->GetGlobalSerialID() << "\t" <<
@@ -220,7 +250,7 @@ void VisualizationDumper::PrintOpInit(OpIterator op)
 // Print a label text 
 void VisualizationDumper::PrintOpLabel(  const OpIterator op, OpLabelType type, const string& label )
 {
-    m_visStream <<
+    Out() <<
         "L\t" << 
         GetVisSerialID( op )    << "\t" <<
         (type == POLT_LABEL ? '0' : '1' ) << "\t" <<
@@ -229,6 +259,15 @@ void VisualizationDumper::PrintOpLabel(  const OpIterator op, OpLabelType type,
 
 void VisualizationDumper::PrintCycle()
 {
+    if( m_triggerMode ){
+        // Cycle commands are printed when chunks are written to a file.
+        if( m_chunkCycle != m_visCurrentCycle ){
+            EndCycleChunk();
+            m_chunkCycle = m_visCurrentCycle;
+        }
+        return;
+    }
+
     stringstream stream;
     if (m_enabled && m_visLastPrintCycle != m_visCurrentCycle) {
         if (m_visLastPrintCycle == 0) {
@@ -238,14 +277,14 @@ void VisualizationDumper::PrintCycle()
         }
         m_visLastPrintCycle = m_visCurrentCycle;
     }
-    m_visStream << stream.str();
+    Out() << stream.str();
 }
 
 
 // opが新しいPipelineStageに入ったことを表示
 void VisualizationDumper::PrintNextPipelineStage( const OpIterator op, DUMP_STATE state )
 {
-    m_visStream <<
+    Out() <<
         "S\t" << 
         GetVisSerialID( op ) << "\t" << 
         "0" /*lane*/         << "\t" << 
@@ -255,7 +294,7 @@ void VisualizationDumper::PrintNextPipelineStage( const OpIterator op, DUMP_STAT
 // opが前のPipelineStageから出たことを表示
 void VisualizationDumper::PrintLastPipelineStage( const OpIterator op, DUMP_STATE lastState )
 {
-    m_visStream <<
+    Out() <<
         "E\t" << 
         GetVisSerialID( op ) << "\t" << 
         "0" /*lane*/         << "\t" << 
@@ -265,7 +304,7 @@ void VisualizationDumper::PrintLastPipelineStage( const OpIterator op, DUMP_STAT
 void VisualizationDumper::PrintStallBody( OpIterator op, bool stall )
 {
     const char* tag = stall ? "S\t" : "E\t";
-    m_visStream <<
+    Out() <<
         tag << 
         GetVisSerialID( op ) << "\t" <<
         "1\t"/*lane*/ << 
@@ -295,7 +334,7 @@ void VisualizationDumper::PrintRawOutput(
     PrintCycle();
 
     const char* tag = begin ? "S\t" : "E\t";
-    m_visStream <<
+    Out() <<
         tag << 
         GetVisSerialID( op ) << "\t" <<
         lane  << "\t" << 
@@ -427,7 +466,7 @@ void VisualizationDumper::PrintOpEnd( const OpIterator op, DUMP_STATE state )
     PrintOpEndLabel( op );
 
     // 基本情報
-    m_visStream << 
+    Out() << 
         "R\t" << 
         GetVisSerialID( op ) << "\t" <<                 // serial ID
         op->GetRetireID() << "\t" <<                    // Retire ID
@@ -451,16 +490,15 @@ void VisualizationDumper::Initialize(
             g_env.GetHostWorkPath() + 
             MakeDumpFileName( m_visFileName, suffix, m_gzipEnabled );
 
-        if (m_gzipEnabled){
-            m_visStream.push( 
-                iostreams::gzip_compressor( 
-                    iostreams::gzip_params(m_gzipLevel) 
-                )
-            );
-        }
-
-        m_visStream.push( iostreams::file_sink( fileName, ios::binary ) );
-        m_visStream << MakeKanataHeaderString().c_str();
+        OpenDumpStream( 
+            &m_visStream, 
+            fileName, 
+            m_gzipEnabled, 
+            m_gzipLevel, 
+            m_asyncWriteEnabled, 
+            (size_t)m_asyncBufferSize 
+        );
+        Out() << MakeKanataHeaderString().c_str();
 
 
         for( int i = 0; i < coreList.GetSize(); i++ ){
@@ -471,12 +509,18 @@ void VisualizationDumper::Initialize(
             }
             
         }
+
+        InitializeTrigger( coreList );
     }
 }
 
 // close FileStream
 void VisualizationDumper::Finalize()
 {
+    if( m_enabled && m_triggerMode ){
+        // Write the last chunk if it is in a capture window.
+        EndCycleChunk();
+    }
     ReleaseParam();
 }
 
@@ -494,6 +538,14 @@ void VisualizationDumper::PrintOpState(OpIterator op, DUMP_STATE state)
     if( !GetOpState( op )->inPipeline && state != DS_FETCH )
         return;
 
+    // A new op is dumped only in a capture window.
+    if( state == DS_FETCH && !IsInCaptureWindow() )
+        return;
+
+    if( m_triggerMode ){
+        CheckOpTrigger( op, state );
+    }
+
     PrintCycle();
 
     // 初めてopをvisDumpに書きだす時(Fetch時)、opの情報を表示する
@@ -531,7 +583,7 @@ void VisualizationDumper::PrintOpDependency(
         return;
 
     PrintCycle();
-    m_visStream << 
+    Out() << 
         "W\t" <<
         GetVisSerialID( consumerOp ) << "\t" << 
         GetVisSerialID( producerOp ) << "\t" << 
@@ -542,6 +594,9 @@ void VisualizationDumper::PrintOpDependency(
 void VisualizationDumper::SetCurrentCycle(const s64 cycle)
 {
     m_visCurrentCycle = cycle;
+    if( m_enabled && m_triggerMode ){
+        CheckCacheTrigger();
+    }
 }
 
 void VisualizationDumper::SetCurrentInsnCount( Thread* thread, const s64 count )
@@ -557,3 +612,245 @@ s64 VisualizationDumper::GetTotalRetiredInsnCount()
     }
     return count;
 }
+
+bool VisualizationDumper::IsInCaptureWindow()
+{
+    if( m_visCurrentCycle < m_captureBeginCycle )
+        return false;
+    if( m_captureEndCycle >= 0 && m_visCurrentCycle >= m_captureEndCycle )
+        return false;
+    if( m_captureEndInsns >= 0 && GetTotalRetiredInsnCount() >= m_captureEndInsns )
+        return false;
+    return true;
+}
+
+//
+// Trigger mode
+//
+
+void VisualizationDumper::InitializeTrigger( PhysicalResourceArray<Core>& coreList )
+{
+    m_triggerPCEnabled = m_triggerPCStr != "";
+    if( m_triggerPCEnabled ){
+        // Both decimal and hexadecimal ("0x...") addresses are accepted.
+        char* end = NULL;
+        m_triggerPC = strtoull( m_triggerPCStr.c_str(), &end, 0 );
+        if( *end != '\0' ){
+            THROW_RUNTIME_ERROR( "'%s' is not a valid trigger PC.", m_triggerPCStr.c_str() );
+        }
+    }
+
+    m_triggerCaches.clear();
+    if( m_triggerCacheLevel > 0 ){
+        if( m_triggerCacheInterval <= 0 ){
+            THROW_RUNTIME_ERROR( "'CacheInterval' of a cache trigger must be positive." );
+        }
+
+        // A cache shared by the cores is counted only once.
+        for( int i = 0; i < coreList.GetSize(); i++ ){
+            Cache* cache = coreList[i]->GetCacheSystem()->GetFirstLevelDataCache();
+            for( int level = 1; level < m_triggerCacheLevel && cache != NULL; level++ ){
+                cache = cache->GetNextCache();
+            }
+            if( cache == NULL ){
+                THROW_RUNTIME_ERROR( 
+                    "There is no level %d data cache for a trigger.", 
+                    m_triggerCacheLevel 
+                );
+            }
+            if( find( m_triggerCaches.begin(), m_triggerCaches.end(), cache ) == m_triggerCaches.end() ){
+                m_triggerCaches.push_back( cache );
+            }
+        }
+    }
+
+    m_triggerMode =
+        m_triggerPCEnabled ||
+        m_triggerBranchMissCount > 0 ||
+        !m_triggerCaches.empty();
+
+    m_triggerCount = 0;
+    m_captureUntilCycle = 0;
+    m_chunkCycle = 0;
+    m_lastCacheAccess = 0;
+    m_lastCacheMiss = 0;
+    m_lastCacheCheckCycle = 0;
+}
+
+void VisualizationDumper::CheckOpTrigger( OpIterator op, DUMP_STATE state )
+{
+    if( m_triggerPCEnabled && state == DS_RETIRE && op->GetPC().address == m_triggerPC ){
+        FireTrigger();
+    }
+
+    if( m_triggerBranchMissCount > 0 && state == DS_BRANCH_PREDICTION_MISS ){
+        // Fire when 'BranchMissCount' misses occur in 'BranchMissCycles' cycles.
+        m_branchMissCycles.push_back( m_visCurrentCycle );
+        while( !m_branchMissCycles.empty() &&
+               m_branchMissCycles.front() <= m_visCurrentCycle - m_triggerBranchMissCycles 
+        ){
+            m_branchMissCycles.pop_front();
+        }
+        if( (int)m_branchMissCycles.size() >= m_triggerBranchMissCount ){
+            m_branchMissCycles.clear();
+            FireTrigger();
+        }
+    }
+}
+
+void VisualizationDumper::CheckCacheTrigger()
+{
+    if( m_triggerCaches.empty() )
+        return;
+    if( m_visCurrentCycle - m_lastCacheCheckCycle < m_triggerCacheInterval )
+        return;
+
+    s64 access = 0;
+    s64 miss = 0;
+    for( size_t i = 0; i < m_triggerCaches.size(); i++ ){
+        access += m_triggerCaches[i]->GetNumAccess();
+        miss   += m_triggerCaches[i]->GetNumMiss();
+    }
+
+    s64 intervalAccess = access - m_lastCacheAccess;
+    s64 intervalMiss   = miss - m_lastCacheMiss;
+    m_lastCacheAccess = access;
+    m_lastCacheMiss   = miss;
+    m_lastCacheCheckCycle = m_visCurrentCycle;
+
+    if( intervalAccess > 0 && 
+        (double)intervalMiss / (double)intervalAccess >= m_triggerCacheMissRate 
+    ){
+        FireTrigger();
+    }
+}
+
+bool VisualizationDumper::IsCapturing() const
+{
+    return m_visCurrentCycle < m_captureUntilCycle;
+}
+
+void VisualizationDumper::FireTrigger()
+{
+    if( !IsCapturing() ){
+        if( m_maxTriggers > 0 && m_triggerCount >= m_maxTriggers )
+            return;
+        m_triggerCount++;
+        FlushCycleChunks();
+    }
+
+    // A trigger in a capture window extends the window.
+    m_captureUntilCycle = m_visCurrentCycle + m_postTriggerCycles + 1;
+}
+
+// Moves text dumped in a cycle to the ring or a file.
+void VisualizationDumper::EndCycleChunk()
+{
+    string text = m_chunkStream.str();
+    m_chunkStream.str( "" );
+    if( text.empty() )
+        return;
+
+    if( m_chunkCycle < m_captureUntilCycle ){
+        WriteCycleChunk( m_chunkCycle, text, true, NULL );
+        return;
+    }
+
+    // Ops captured in a window are written until they retire or are flushed,
+    // as in the cycle window, and the rest is kept in the history.
+    string rest;
+    if( m_capturedOps.empty() ){
+        rest.swap( text );
+    }
+    else{
+        WriteCycleChunk( m_chunkCycle, text, false, &rest );
+
+        // Cycles in a file must not go backward, so the history begins after
+        // the last written cycle.
+        if( m_visLastPrintCycle == m_chunkCycle ){
+            m_history.clear();
+        }
+    }
+
+    // No chunk is kept after the last trigger.
+    if( m_maxTriggers > 0 && m_triggerCount >= m_maxTriggers )
+        return;
+    if( rest.empty() )
+        return;
+
+    m_history.push_back( CycleChunk() );
+    m_history.back().cycle = m_chunkCycle;
+    m_history.back().text.swap( rest );
+    while( !m_history.empty() && m_history.front().cycle <= m_chunkCycle - m_historyCycles ){
+        m_history.pop_front();
+    }
+}
+
+void VisualizationDumper::FlushCycleChunks()
+{
+    for( size_t i = 0; i < m_history.size(); i++ ){
+        WriteCycleChunk( m_history[i].cycle, m_history[i].text, true, NULL );
+    }
+    m_history.clear();
+}
+
+// Writes lines for ops whose 'I' command is written in the file.
+// Every line in a chunk begins with "<command>\t<id>", except a line broken
+// by a new line in a label, which follows its previous line.
+// When 'capture' is false, no new op is captured and lines that are not
+// written are appended to 'rest' if it is not NULL.
+void VisualizationDumper::WriteCycleChunk( s64 cycle, const string& text, bool capture, string* rest )
+{
+    string out;
+    bool written = false;
+    size_t pos = 0;
+    while( pos < text.size() ){
+        size_t end = text.find( '\n', pos );
+        end = ( end == string::npos ) ? text.size() : end + 1;
+
+        const char* line = text.c_str() + pos;
+        char command = line[0];
+        if( end - pos > 2 && line[1] == '\t' && strchr( "ILSERW", command ) != NULL ){
+            char* next = NULL;
+            u64 id = strtoull( line + 2, &next, 10 );
+            if( command == 'I' ){
+                written = capture;
+                if( capture ){
+                    m_capturedOps.insert( id );
+                }
+            }
+            else if( command == 'W' ){
+                u64 producerID = strtoull( next + 1, NULL, 10 );
+                written = 
+                    m_capturedOps.find( id ) != m_capturedOps.end() &&
+                    m_capturedOps.find( producerID ) != m_capturedOps.end();
+            }
+            else{
+                written = m_capturedOps.find( id ) != m_capturedOps.end();
+                if( command == 'R' ){
+                    m_capturedOps.erase( id );
+                }
+            }
+        }
+
+        if( written ){
+            out.append( line, end - pos );
+        }
+        else if( rest != NULL ){
+            rest->append( line, end - pos );
+        }
+        pos = end;
+    }
+
+    if( out.empty() )
+        return;
+
+    if( m_visLastPrintCycle == 0 ){
+        m_visStream << "C=\t" << cycle << "\n";
+    }
+    else if( m_visLastPrintCycle != cycle ){
+        m_visStream << "C\t" << ( cycle - m_visLastPrintCycle ) << "\n";
+    }
+    m_visLastPrintCycle = cycle;
+    m_visStream << out;
+}
@@ -48,6 +48,7 @@ namespace Onikiri
 {
     class Core;
     class Thread;
+    class Cache;
 
     // simulationの結果をVisualizeするためのクラス
     class VisualizationDumper : public ParamExchange
@@ -60,6 +61,24 @@ namespace Onikiri
             PARAM_ENTRY( "@EnableGzip", m_gzipEnabled )
             PARAM_ENTRY( "@GzipLevel",  m_gzipLevel )
             PARAM_ENTRY( "@SkipInsns",  m_skipInsns )
+            PARAM_ENTRY( "@EnableAsyncWrite", m_asyncWriteEnabled )
+            PARAM_ENTRY( "@AsyncBufferSize",  m_asyncBufferSize )
+            BEGIN_PARAM_PATH( "Capture/" )
+                PARAM_ENTRY( "@BeginCycle",     m_captureBeginCycle )
+                PARAM_ENTRY( "@EndCycle",       m_captureEndCycle )
+                PARAM_ENTRY( "@EndInsns",       m_captureEndInsns )
+                PARAM_ENTRY( "@HistoryCycles",      m_historyCycles )
+                PARAM_ENTRY( "@PostTriggerCycles",  m_postTriggerCycles )
+                PARAM_ENTRY( "@MaxTriggers",        m_maxTriggers )
+            END_PARAM_PATH()
+            BEGIN_PARAM_PATH( "Trigger/" )
+                PARAM_ENTRY( "@PC",                 m_triggerPCStr )
+                PARAM_ENTRY( "@BranchMissCount",    m_triggerBranchMissCount )
+                PARAM_ENTRY( "@BranchMissCycles",   m_triggerBranchMissCycles )
+                PARAM_ENTRY( "@CacheLevel",         m_triggerCacheLevel )
+                PARAM_ENTRY( "@CacheMissRate",      m_triggerCacheMissRate )
+                PARAM_ENTRY( "@CacheInterval",      m_triggerCacheInterval )
+            END_PARAM_PATH()
         END_PARAM_MAP()
 
         // constructor/destructor
@@ -154,6 +173,8 @@ namespace Onikiri
         bool m_enabled;     // VisDumpを書きだすかどうか
         bool m_gzipEnabled; // VisDumpをgzip圧縮するかどうか
         int  m_gzipLevel;   // gzipの圧縮レベル
+        bool m_asyncWriteEnabled;   // Compress and write a dump on a background thread.
+        u64  m_asyncBufferSize;     // The maximum bytes of text not written yet.
 
         std::string m_visFileName; // visDumpを出力するファイル名
         boost::iostreams::filtering_ostream m_visStream;    // visDumpを出力するファイルストリーム
@@ -164,6 +185,80 @@ namespace Onikiri
 
         u64 m_visSerialID;      // ログファイル内でのシリアルID
 
+        //
+        // Capture windows.
+        //
+        // Ops are dumped only when they are fetched in a window specified by 
+        // a cycle range ([BeginCycle, EndCycle)) and a retired insn range 
+        // ([SkipInsns, EndInsns)). A negative end means an unbounded window.
+        //
+        // When any trigger is configured, the dumper runs in a trigger mode.
+        // Dumped text is kept in a ring of the last 'HistoryCycles' cycles 
+        // and is written to a file only when a trigger fires. After a trigger
+        // fires, text is written directly for 'PostTriggerCycles' cycles.
+        // Text for ops whose 'I' command was dropped from the ring is 
+        // discarded, so an output file is always a valid Kanata log.
+        //
+        s64 m_captureBeginCycle;
+        s64 m_captureEndCycle;
+        s64 m_captureEndInsns;
+        s64 m_historyCycles;
+        s64 m_postTriggerCycles;
+        int m_maxTriggers;      // 0 means unlimited.
+
+        std::string m_triggerPCStr;     // A retired PC. An empty string disables it.
+        int m_triggerBranchMissCount;   // Branch misses in 'BranchMissCycles' cycles.
+        s64 m_triggerBranchMissCycles;
+        int m_triggerCacheLevel;        // 1: L1 data cache, 2: L2 ...  0 disables it.
+        double m_triggerCacheMissRate;  // A miss rate in each 'CacheInterval' cycles.
+        s64 m_triggerCacheInterval;
+
+        // A chunk of text dumped in one cycle.
+        struct CycleChunk
+        {
+            s64 cycle;
+            std::string text;
+        };
+
+        bool m_triggerMode;
+        bool m_triggerPCEnabled;
+        u64  m_triggerPC;
+        int  m_triggerCount;
+        s64  m_captureUntilCycle;   // Text is written directly until this cycle.
+        s64  m_chunkCycle;          // The cycle of 'm_chunkStream'.
+
+        std::ostringstream m_chunkStream;   // Text dumped in the current cycle.
+        std::deque< CycleChunk > m_history;
+        std::set< u64 > m_capturedOps;       // Ops whose 'I' is written and whose 'R' is not.
+        std::deque< s64 > m_branchMissCycles;
+
+        std::vector< Cache* > m_triggerCaches;
+        s64 m_lastCacheAccess;
+        s64 m_lastCacheMiss;
+        s64 m_lastCacheCheckCycle;
+
+        // Returns a stream for dumped text.
+        std::ostream& Out()
+        {
+            if( m_triggerMode ){
+                return m_chunkStream;
+            }
+            return m_visStream;
+        }
+
+        // Whether a new op can be dumped or not.
+        bool IsInCaptureWindow();
+
+        // Trigger mode
+        void InitializeTrigger( PhysicalResourceArray<Core>& coreList );
+        void CheckOpTrigger( OpIterator op, DUMP_STATE state );
+        void CheckCacheTrigger();
+        void FireTrigger();
+        bool IsCapturing() const;
+        void EndCycleChunk();
+        void WriteCycleChunk( s64 cycle, const std::string& text, bool capture, std::string* rest );
+        void FlushCycleChunks();
+
         // ダンプのスキップ判定
         bool IsDumpSkipped( OpIterator op );
 
@@ -284,3 +284,9 @@ void ExecUnitBase::Update()
     m_reserver.Update();
 }
 
+// Called when idle cycles are skipped.
+void ExecUnitBase::SkipIdleCycles( s64 cycles )
+{
+    m_reserver.SkipIdleCycles( cycles );
+}
+
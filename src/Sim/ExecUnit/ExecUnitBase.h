@@ -98,6 +98,9 @@ namespace Onikiri
         // Called in Update phase.
         virtual void Update();
 
+        // Called when idle cycles are skipped.
+        virtual void SkipIdleCycles( s64 cycles );
+
         // accessors
         ExecLatencyInfo* GetExecLatencyInfo()
         {
@@ -64,6 +64,10 @@ namespace Onikiri
         // Called in Update phase.
         virtual void Update() = 0;
 
+        // Called instead of Begin()/Update() when idle cycles
+        // without reservations are skipped.
+        virtual void SkipIdleCycles( s64 cycles ) = 0;
+
         // Get a reserver when you need to manually reserve execution units 
         // without CanReserve()/Reserve().
         virtual ExecUnitReserver* GetReserver() = 0; 
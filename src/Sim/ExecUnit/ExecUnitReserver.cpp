@@ -119,3 +119,16 @@ void ExecUnitReserver::Update()
 
     m_current = GetWheelIndex(1);   // Get an index for a next cycle.
 }
+
+void ExecUnitReserver::SkipIdleCycles( s64 cycles )
+{
+    ASSERT( m_resvQueue.size() == 0, "Reservations are skipped." );
+
+    // Reset counts of the skipped cycles.
+    s64 size = (s64)m_wheel.size();
+    for( s64 i = 0; i < cycles && i < size; i++ ){
+        m_wheel[ GetWheelIndex( (int)i ) ] = 0;
+    }
+
+    m_current = (size_t)( ( (s64)m_current + cycles ) % size );
+}
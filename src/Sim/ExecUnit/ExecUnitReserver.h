@@ -61,6 +61,10 @@ namespace Onikiri
         // Called in Update phase.
         void Update();
 
+        // The same as calling Begin()/Update() 'cycles' times 
+        // without reservations.
+        void SkipIdleCycles( s64 cycles );
+
     protected:
         
         // The number of units corresponding to this reserver.
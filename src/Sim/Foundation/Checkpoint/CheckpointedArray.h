@@ -0,0 +1,219 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+
+
+#ifndef SIM_FOUNDATION_CHECK_POINT_CHECKPOINTED_ARRAY_H
+#define SIM_FOUNDATION_CHECK_POINT_CHECKPOINTED_ARRAY_H
+
+#include "Utility/RuntimeError.h"
+#include "Sim/Foundation/Checkpoint/CheckpointMaster.h"
+#include "Sim/Foundation/Checkpoint/CheckpointedDataBase.h"
+#include "Sim/Foundation/Checkpoint/Checkpoint.h"
+
+namespace Onikiri 
+{
+    // Incremental check pointing of an array with 'Size' elements.
+    // CheckpointedData copies whole data on each backup, which is expensive
+    // for a large table such as a register mapping table. Instead, this class 
+    // records the old value of each written element to an undo journal 
+    // while there are backed up checkpoints, and a checkpoint only holds 
+    // a position in the journal. Recovery undoes the journal backwards to 
+    // the position of a checkpoint.
+    //
+    // Checkpoints younger than a recovered one must be flushed before
+    // they are recovered, as InorderList does.
+    template <typename ElementType, size_t Size>
+    class CheckpointedArray : public CheckpointedDataBase
+    {
+
+    public:
+        CheckpointedArray() : 
+            m_journalBase(0),
+            m_backedUpCount(0)
+        {
+        }
+
+        virtual ~CheckpointedArray()
+        {
+        }
+
+        // This data is registered to 'master' and it is check pointed on 'slot' timing.
+        virtual void Initialize( CheckpointMaster* master, CheckpointMaster::Slot slot )
+        {
+            CheckpointedDataHandle handle = master->Register( this, slot );
+            SetHandle( handle );
+        }
+
+        // Allocate an entry for a journal position and set the entry to 'checkpoint'.
+        virtual void Allocate( Checkpoint* checkpoint )
+        {
+            m_list.push_back( BackupEntry() );
+            BackupIterator i = m_list.end();
+            --i;
+            checkpoint->SetIterator( GetHandle(), i );
+        }
+
+        // The current position of the journal is recorded to a checkpoint.
+        virtual void Backup( Checkpoint* checkpoint )
+        {
+            BackupIterator entry = GetIterator( checkpoint );
+            if( !entry->valid ){
+                m_backedUpCount++;
+            }
+            entry->valid = true;
+            entry->journalPosition = GetJournalEnd();
+        }
+
+        // Current data is recovered by undoing the journal.
+        virtual void Recover( Checkpoint* checkpoint )
+        {
+            BackupIterator entry = GetIterator( checkpoint );
+            if( !entry->valid ){
+                // See comments in CheckpointedData::Recover().
+                return;
+            }
+
+            ASSERT( 
+                entry->journalPosition >= m_journalBase,
+                "The journal of a recovered checkpoint is already released."
+            );
+            while( GetJournalEnd() > entry->journalPosition ){
+                const JournalEntry& undo = m_journal.back();
+                m_current[ undo.index ] = undo.value;
+                m_journal.pop_back();
+            }
+        }
+
+        // Erase an entry assigned for 'checkpoint' and release the journal 
+        // that is no longer necessary for recovery.
+        virtual void Erase( Checkpoint* checkpoint )
+        {
+            BackupIterator i;
+            if( !GetIterator( checkpoint, &i ) ){
+                return;
+            }
+
+            bool valid = i->valid;
+            m_list.erase( i );
+            if( !valid ){
+                return;
+            }
+            m_backedUpCount--;
+
+            // Journal entries older than the oldest backed up checkpoint are released.
+            // The journal positions of checkpoints increase in the order of the list.
+            u64 oldest = GetJournalEnd();
+            for( BackupIterator e = m_list.begin(); e != m_list.end(); ++e ){
+                if( e->valid ){
+                    oldest = e->journalPosition;
+                    break;
+                }
+            }
+            while( m_journalBase < oldest ){
+                m_journal.pop_front();
+                m_journalBase++;
+            }
+        }
+
+        // Accessors.
+        // Elements must be written through Set() so that they are journaled.
+        const ElementType& Get( size_t index ) const
+        {
+            ASSERT( index < Size );
+            return m_current[ index ];
+        }
+
+        const ElementType& operator[]( size_t index ) const
+        {
+            return Get( index );
+        }
+
+        void Set( size_t index, const ElementType& value )
+        {
+            ASSERT( index < Size );
+            if( m_backedUpCount > 0 ){
+                JournalEntry undo = { index, m_current[ index ] };
+                m_journal.push_back( undo );
+            }
+            m_current[ index ] = value;
+        }
+
+        size_t size() const
+        {
+            return Size;
+        }
+
+    private:
+        struct JournalEntry
+        {
+            size_t index;
+            ElementType value;  // An old value
+        };
+
+        boost::array< ElementType, Size > m_current; // Current data.
+        BackupList m_list;      // Journal positions of checkpoints.
+
+        // Undo journal. m_journalBase is an absolute position of the front entry.
+        std::deque< JournalEntry > m_journal;
+        u64 m_journalBase;
+
+        // The number of checkpoints that are backed up and not erased yet.
+        int m_backedUpCount;
+
+        u64 GetJournalEnd() const
+        {
+            return m_journalBase + m_journal.size();
+        }
+
+        // Access methods
+        bool GetIterator( const Checkpoint* checkpoint, BackupIterator* iterator ) const
+        {
+            return checkpoint->GetIterator( GetHandle(), iterator );
+        }
+
+        BackupIterator GetIterator( const Checkpoint* checkpoint ) const
+        {
+            BackupIterator iterator;
+#if ONIKIRI_DEBUG
+            bool success = checkpoint->GetIterator( GetHandle(), &iterator );
+            ASSERT( success, "GetIterator() failed." );
+#else
+            checkpoint->GetIterator( GetHandle(), &iterator );
+#endif
+            return iterator;
+        }
+    };
+
+}; // namespace Onikiri
+
+#endif // SIM_FOUNDATION_CHECK_POINT_CHECKPOINTED_ARRAY_H
+
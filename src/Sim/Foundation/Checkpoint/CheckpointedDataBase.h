@@ -51,9 +51,11 @@ namespace Onikiri
         {
             void* data;
             bool  valid;
+            u64   journalPosition;  // Used by CheckpointedArray instead of 'data'.
             BackupEntry() :
                 data(NULL),
-                valid(false)
+                valid(false),
+                journalPosition(0)
             {
             }
         };
@@ -37,6 +37,7 @@
 #include "Sim/Foundation/TimeWheel/TimeWheelBase.h"
 #include "Sim/ResourcePriority.h"
 #include "Utility/Collection/fixed_size_buffer.h"
+#include "Sim/Foundation/Profiler/HostProfiler.h"
 
 namespace Onikiri
 {
@@ -45,7 +46,8 @@ namespace Onikiri
     public:
         PriorityEventList() :
             m_updatePriority( RP_LOWEST ),
-            m_evaluatePriority( RP_LOWEST )
+            m_evaluatePriority( RP_LOWEST ),
+            m_profileTable( NULL )
         {
             //m_eventList.resize( CRP_HIGHEST + 1 );
             for( int i = RP_LOWEST; i < RP_HIGHEST + 1; i++ ){
@@ -116,6 +118,17 @@ namespace Onikiri
 
         }
 
+        // Returns whether any events are extracted in this cycle or not.
+        bool HasExtractedEvent()
+        {
+            for( PriorityList::iterator i = m_eventList.begin(); i != m_eventList.end(); ++i ){
+                if( (*i)->size() > 0 ){
+                    return true;
+                }
+            }
+            return false;
+        }
+
         void BeginEvaluate()
         {
             m_evaluatePriority = RP_HIGHEST;
@@ -123,6 +136,11 @@ namespace Onikiri
 
         void TriggerEvaluate( int priority )
         {
+            if( m_profileTable ){
+                TriggerEvaluateProfiled( priority );
+                return;
+            }
+
             int curPriority;
             for( curPriority = m_evaluatePriority; curPriority >= priority; curPriority-- ){
                 EventList* eventList = m_eventList[curPriority];
@@ -147,6 +165,11 @@ namespace Onikiri
 
         void TriggerUpdate( int priority )
         {
+            if( m_profileTable ){
+                TriggerUpdateProfiled( priority );
+                return;
+            }
+
             int curPriority;
             for( curPriority = m_updatePriority; curPriority >= priority; curPriority-- ){
                 EventList* eventList = m_eventList[curPriority];
@@ -165,11 +188,57 @@ namespace Onikiri
             TriggerUpdate( RP_LOWEST );
         }
 
+        // Host time spent in each event is added to 'table' when it is set.
+        void SetProfileTable( HostProfiler::EventTable* table )
+        {
+            m_profileTable = table;
+        }
+
     private:
 
         PriorityList m_eventList;
         int m_updatePriority;
         int m_evaluatePriority;
+        HostProfiler::EventTable* m_profileTable;
+
+        void AddEventTicks( PtrType event, u64 ticks )
+        {
+            HostProfiler::Entry* entry = &(*m_profileTable)[ typeid( *event ).name() ];
+            entry->ticks += ticks;
+            entry->calls++;
+        }
+
+        void TriggerEvaluateProfiled( int priority )
+        {
+            int curPriority;
+            for( curPriority = m_evaluatePriority; curPriority >= priority; curPriority-- ){
+                EventList* eventList = m_eventList[curPriority];
+                EventList::iterator eventEnd = eventList->end();
+                for( EventList::iterator i = eventList->begin(); i != eventEnd; ++i ){
+                    u64 begin = ReadHostTimeStamp();
+                    i->event->TriggerEvaluate();
+                    AddEventTicks( i->event, ReadHostTimeStamp() - begin );
+                }
+            }
+            m_evaluatePriority = curPriority; 
+        }
+
+        void TriggerUpdateProfiled( int priority )
+        {
+            int curPriority;
+            for( curPriority = m_updatePriority; curPriority >= priority; curPriority-- ){
+                EventList* eventList = m_eventList[curPriority];
+                EventList::iterator eventEnd = eventList->end();
+                for( EventList::iterator i = eventList->begin(); i != eventEnd; ++i ){
+                    if( !i->timeWheel->IsStalledThisCycle() ){
+                        u64 begin = ReadHostTimeStamp();
+                        i->event->TriggerUpdate();
+                        AddEventTicks( i->event, ReadHostTimeStamp() - begin );
+                    }
+                }
+            }
+            m_updatePriority = curPriority; 
+        }
     };
 
 } //namespace Onikiri
@@ -48,6 +48,7 @@
 #include "Utility/RuntimeError.h"
 #include "Sim/Op/OpArray/OpArray.h"
 #include "Sim/Foundation/Hook/HookDecl.h"
+#include "Sim/Foundation/Profiler/HostProfiler.h"
 
 namespace Onikiri 
 {
@@ -491,6 +492,11 @@ namespace Onikiri
         // 登録されている Hook をすべて呼ぶ関数
         void Trigger(HookVector& hookVector, HookParameterType* hookParameter)
         {
+            if( g_hostProfiler.IsEnabled() ){
+                TriggerProfiled( hookVector, hookParameter );
+                return;
+            }
+
             for(typename HookVector::iterator iter = hookVector.begin();
                 iter != hookVector.end();
                 ++iter)
@@ -499,6 +505,23 @@ namespace Onikiri
             }
         }
 
+        void TriggerProfiled(HookVector& hookVector, HookParameterType* hookParameter)
+        {
+            u64 begin = ReadHostTimeStamp();
+            for(typename HookVector::iterator iter = hookVector.begin();
+                iter != hookVector.end();
+                ++iter)
+            {
+                (*(iter->first))(hookParameter);
+            }
+            u64 ticks = ReadHostTimeStamp() - begin;
+
+            const char* hookType = 
+                &hookVector == &m_beforeFunction ? "before" :
+                &hookVector == &m_afterFunction  ? "after"  : "around";
+            g_hostProfiler.AddHookTicks( &hookVector, typeid(*this).name(), hookType, ticks );
+        }
+
         void ReleaseHookVector(HookVector& hookVector)
         {
             for(typename HookVector::iterator iter = hookVector.begin();
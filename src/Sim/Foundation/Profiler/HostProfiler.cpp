@@ -0,0 +1,224 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+#include <pch.h>
+
+#include "Sim/Foundation/Profiler/HostProfiler.h"
+
+using namespace std;
+using namespace Onikiri;
+
+namespace Onikiri
+{
+    HostProfiler g_hostProfiler;
+}
+
+namespace
+{
+    template < typename T >
+    struct CompareTicks
+    {
+        bool operator()( const T& lhs, const T& rhs ) const
+        {
+            return lhs.ticks > rhs.ticks;
+        }
+    };
+}
+
+HostProfiler::ProfileEntry::ProfileEntry() :
+    ticks( 0 ),
+    calls( 0 ),
+    ratio( 0.0 )
+{
+    for( int i = 0; i < PHASE_MAX; i++ ){
+        phaseTicks[i] = 0;
+    }
+}
+
+HostProfiler::ProfileResult::ProfileResult() :
+    totalTicks( 0 )
+{
+}
+
+HostProfiler::HostProfiler()
+{
+    m_enabled = false;
+    m_totalTicks = 0;
+}
+
+HostProfiler::~HostProfiler()
+{
+    Clear();
+}
+
+void HostProfiler::Initialize()
+{
+    Clear();
+    LoadParam();
+}
+
+void HostProfiler::Finalize()
+{
+    if( m_enabled ){
+        MakeResult();
+    }
+    ReleaseParam();
+    Clear();
+}
+
+void HostProfiler::Clear()
+{
+    for( size_t i = 0; i < m_eventTables.size(); i++ ){
+        delete m_eventTables[i];
+    }
+    m_eventTables.clear();
+    m_resources.clear();
+    m_hookIndex.clear();
+    m_hooks.clear();
+    m_totalTicks = 0;
+    m_result = ProfileResult();
+}
+
+int HostProfiler::AddResource( const String& name )
+{
+    for( size_t i = 0; i < m_resources.size(); i++ ){
+        if( m_resources[i].name == name ){
+            return (int)i;
+        }
+    }
+
+    ResourceEntry entry;
+    entry.name = name;
+    for( int i = 0; i < PHASE_MAX; i++ ){
+        entry.ticks[i] = 0;
+    }
+    m_resources.push_back( entry );
+    return (int)m_resources.size() - 1;
+}
+
+HostProfiler::EventTable* HostProfiler::CreateEventTable()
+{
+    EventTable* table = new EventTable();
+    m_eventTables.push_back( table );
+    return table;
+}
+
+void HostProfiler::AddHookTicks( 
+    const void* hookVector, const char* typeName, const char* hookType, u64 ticks 
+){
+    lock_guard< mutex > lock( m_hookMutex );
+
+    HookIndexMap::iterator i = m_hookIndex.find( hookVector );
+    size_t index;
+    if( i == m_hookIndex.end() ){
+        index = m_hooks.size();
+        m_hookIndex[ hookVector ] = index;
+        m_hooks.push_back( HookEntry() );
+        m_hooks.back().name.format( "%s(%s)", typeName, hookType );
+    }
+    else{
+        index = i->second;
+    }
+
+    Entry* entry = &m_hooks[ index ].entry;
+    entry->ticks += ticks;
+    entry->calls++;
+}
+
+void HostProfiler::MakeResult()
+{
+#if defined(HOST_IS_X86_64) || defined(HOST_IS_X86)
+    m_result.unit = "tsc";
+#else
+    m_result.unit = "ns";
+#endif
+    m_result.totalTicks = m_totalTicks;
+    double total = m_totalTicks > 0 ? (double)m_totalTicks : 1.0;
+
+    // Clocked resources
+    for( size_t i = 0; i < m_resources.size(); i++ ){
+        ResourceProfileEntry entry;
+        entry.name = m_resources[i].name;
+        for( int p = 0; p < PHASE_MAX; p++ ){
+            entry.phaseTicks[p] = m_resources[i].ticks[p];
+            entry.ticks += m_resources[i].ticks[p];
+        }
+        entry.ratio = (double)entry.ticks / total;
+        m_result.resources.push_back( entry );
+    }
+    stable_sort( 
+        m_result.resources.begin(), 
+        m_result.resources.end(), 
+        CompareTicks< ResourceProfileEntry >() 
+    );
+
+    // Events: tables of all partitions are merged by type names.
+    map< String, Entry > events;
+    for( size_t i = 0; i < m_eventTables.size(); i++ ){
+        EventTable* table = m_eventTables[i];
+        for( EventTable::iterator e = table->begin(); e != table->end(); ++e ){
+            Entry& entry = events[ String( e->first ) ];
+            entry.ticks += e->second.ticks;
+            entry.calls += e->second.calls;
+        }
+    }
+    for( map< String, Entry >::iterator e = events.begin(); e != events.end(); ++e ){
+        ProfileEntry entry;
+        entry.name  = e->first;
+        entry.ticks = e->second.ticks;
+        entry.calls = e->second.calls;
+        entry.ratio = (double)entry.ticks / total;
+        m_result.events.push_back( entry );
+    }
+    stable_sort( 
+        m_result.events.begin(), 
+        m_result.events.end(), 
+        CompareTicks< ProfileEntry >() 
+    );
+
+    // Hooks: hook points do not have names, so hook points with the same 
+    // type are numbered in the order in which they are triggered first.
+    map< String, int > hookCount;
+    for( size_t i = 0; i < m_hooks.size(); i++ ){
+        ProfileEntry entry;
+        int count = hookCount[ m_hooks[i].name ]++;
+        entry.name  = String().format( "%s#%d", m_hooks[i].name.c_str(), count );
+        entry.ticks = m_hooks[i].entry.ticks;
+        entry.calls = m_hooks[i].entry.calls;
+        entry.ratio = (double)entry.ticks / total;
+        m_result.hooks.push_back( entry );
+    }
+    stable_sort( 
+        m_result.hooks.begin(), 
+        m_result.hooks.end(), 
+        CompareTicks< ProfileEntry >() 
+    );
+}
@@ -0,0 +1,220 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+#ifndef SIM_FOUNDATION_PROFILER_HOST_PROFILER_H
+#define SIM_FOUNDATION_PROFILER_HOST_PROFILER_H
+
+#include "Types.h"
+#include "Env/Param/ParamExchange.h"
+
+#if defined(COMPILER_IS_MSVC)
+    #include <intrin.h>
+#elif defined(HOST_IS_X86_64) || defined(HOST_IS_X86)
+    #include <x86intrin.h>
+#endif
+
+namespace Onikiri 
+{
+    // Returns a host time stamp. The time stamp counter is used on x86 hosts
+    // and nano seconds of a steady clock are used on the other hosts.
+    INLINE u64 ReadHostTimeStamp()
+    {
+#if defined(HOST_IS_X86_64) || defined(HOST_IS_X86)
+        return (u64)__rdtsc();
+#else
+        return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>( 
+            std::chrono::steady_clock::now().time_since_epoch() 
+        ).count();
+#endif
+    }
+
+    // Measures host time spent in clocked resources, events and hooks.
+    // Time is measured only when '@Enable' is set, and the results are 
+    // written to '/Session/Result/HostProfile' in Finalize().
+    // Time spent in events and hooks is also included in time of clocked 
+    // resources that trigger them.
+    class HostProfiler : public ParamExchange
+    {
+    public:
+        // Phases of a cycle in ClockedResourceIF.
+        enum Phase
+        {
+            PHASE_BEGIN = 0,
+            PHASE_EVALUATE,
+            PHASE_TRANSITION,
+            PHASE_UPDATE,
+            PHASE_END,
+            PHASE_MAX
+        };
+
+        struct Entry
+        {
+            u64 ticks;
+            s64 calls;
+            Entry() : ticks( 0 ), calls( 0 ) {}
+        };
+
+        // Time spent in each type of events. Each priority event list has
+        // its own table, so that partitions simulated on different host 
+        // threads do not share a table. Events are keyed by their type names.
+        typedef unordered_map< const char*, Entry > EventTable;
+
+        BEGIN_PARAM_MAP( "/Session/" )
+            PARAM_ENTRY( "Environment/HostProfiler/@Enable", m_enabled )
+            if( m_enabled ){
+                CHAIN_PARAM_MAP( "Result/HostProfile", m_result )
+            }
+        END_PARAM_MAP()
+
+        HostProfiler();
+        virtual ~HostProfiler();
+
+        void Initialize();
+        void Finalize();
+
+        bool IsEnabled() const
+        {
+            return m_enabled;
+        }
+
+        // Returns a slot of a clocked resource named 'name'.
+        // Resources with the same name share a slot.
+        // Slots must be added before simulation.
+        int AddResource( const String& name );
+
+        // A resource in a slot is accessed only from one host thread.
+        void AddResourceTicks( int slot, Phase phase, u64 ticks )
+        {
+            ResourceEntry* entry = &m_resources[ slot ];
+            entry->ticks[ phase ] += ticks;
+        }
+
+        // Returns a new event table. The table is released in Finalize().
+        EventTable* CreateEventTable();
+
+        // Hooks may be triggered from any host threads.
+        // 'hookVector' identifies a hook point and its hook type.
+        void AddHookTicks( 
+            const void* hookVector, const char* typeName, const char* hookType, u64 ticks 
+        );
+
+        // Time spent in the whole simulation loop.
+        void AddTotalTicks( u64 ticks )
+        {
+            m_totalTicks += ticks;
+        }
+
+    protected:
+        struct ResourceEntry
+        {
+            String name;
+            u64 ticks[ PHASE_MAX ];
+        };
+
+        struct HookEntry
+        {
+            String name;
+            Entry entry;
+        };
+
+        struct ProfileEntry : public ParamExchangeChild
+        {
+            String name;
+            u64 ticks;
+            s64 calls;
+            u64 phaseTicks[ PHASE_MAX ];
+            double ratio;
+
+            ProfileEntry();
+            BEGIN_PARAM_MAP( "" )
+                RESULT_ENTRY( "@Name",  name )
+                RESULT_ENTRY( "@Ticks", ticks )
+                RESULT_ENTRY( "@Calls", calls )
+                RESULT_ENTRY( "@Ratio", ratio )
+            END_PARAM_MAP()
+        };
+
+        struct ResourceProfileEntry : public ProfileEntry
+        {
+            BEGIN_PARAM_MAP( "" )
+                RESULT_ENTRY( "@Name",       name )
+                RESULT_ENTRY( "@Ticks",      ticks )
+                RESULT_ENTRY( "@Ratio",      ratio )
+                RESULT_ENTRY( "@Begin",      phaseTicks[ PHASE_BEGIN ] )
+                RESULT_ENTRY( "@Evaluate",   phaseTicks[ PHASE_EVALUATE ] )
+                RESULT_ENTRY( "@Transition", phaseTicks[ PHASE_TRANSITION ] )
+                RESULT_ENTRY( "@Update",     phaseTicks[ PHASE_UPDATE ] )
+                RESULT_ENTRY( "@End",        phaseTicks[ PHASE_END ] )
+            END_PARAM_MAP()
+        };
+
+        struct ProfileResult : public ParamExchangeChild
+        {
+            String unit;
+            u64 totalTicks;
+            std::vector< ResourceProfileEntry > resources;
+            std::vector< ProfileEntry > events;
+            std::vector< ProfileEntry > hooks;
+
+            ProfileResult();
+            BEGIN_PARAM_MAP( "" )
+                RESULT_ENTRY( "@Unit",       unit )
+                RESULT_ENTRY( "@TotalTicks", totalTicks )
+                CHAIN_PARAM_MAP( "Resource", resources )
+                CHAIN_PARAM_MAP( "Event",    events )
+                CHAIN_PARAM_MAP( "Hook",     hooks )
+            END_PARAM_MAP()
+        };
+
+        bool m_enabled;
+        u64  m_totalTicks;
+
+        std::vector< ResourceEntry > m_resources;
+        std::vector< EventTable* > m_eventTables;
+
+        // Hooks are listed in the order in which they are triggered first.
+        typedef unordered_map< const void*, size_t > HookIndexMap;
+        HookIndexMap m_hookIndex;
+        std::vector< HookEntry > m_hooks;
+        std::mutex m_hookMutex;
+
+        ProfileResult m_result;
+
+        void MakeResult();
+        void Clear();
+    };
+
+    extern HostProfiler g_hostProfiler;
+
+}; // namespace Onikiri
+
+#endif // SIM_FOUNDATION_PROFILER_HOST_PROFILER_H
+
@@ -64,6 +64,7 @@ namespace Onikiri
             m_parent( NULL ),
             m_cycles( 0 ),
             m_stalledCycles( 0 ),
+            m_cycleCounterCount( 0 ),
             m_phase( PHASE_BEGIN ),
             m_priority( RP_DEFAULT_UPDATE )
         {
@@ -85,6 +86,7 @@ namespace Onikiri
             m_lastCycleStalled = m_thisCycleStalled;
             m_thisCycleStalled  = false;
             m_reqStallThisCycle = false;
+            m_cycleCounterCount = 0;
 
             if( m_stallPeriod > 0 ) {
                 m_reqStallThisCycle = true;
@@ -221,6 +223,72 @@ namespace Onikiri
             }
         }
 
+        // Returns the number of next cycles in which this resource and its
+        // children only repeat a last cycle. A last cycle can be repeated if 
+        // a stall state is not changed and a stall period does not expire.
+        // Classes that work in Update() must override this method and
+        // return 0 when they work.
+        virtual s64 GetIdleCycles()
+        {
+            ASSERT( m_phase == PHASE_BEGIN, "GetIdleCycles() can be called only between cycles." );
+
+            if( m_lastCycleStalled != m_thisCycleStalled || 
+                m_cycleCounterCount > MAX_CYCLE_COUNTERS 
+            ){
+                return 0;
+            }
+
+            s64 cycles = IDLE_CYCLES_UNBOUNDED;
+            if( m_stallPeriod > 0 ){
+                if( !m_thisCycleStalled ){
+                    return 0;
+                }
+                cycles = m_stallPeriod;
+            }
+
+            Children::iterator end = m_children.end();
+            for( Children::iterator i = m_children.begin(); i != end; ++i ){
+                cycles = std::min( cycles, (*i)->GetIdleCycles() );
+                if( cycles == 0 ){
+                    return 0;
+                }
+            }
+            return cycles;
+        }
+
+        // Proceed idle cycles at once.
+        // Counters incremented with IncrementCycleCounter() in a last cycle
+        // are incremented in each skipped cycle.
+        virtual void SkipIdleCycles( s64 cycles )
+        {
+            ASSERT( m_phase == PHASE_BEGIN, "SkipIdleCycles() can be called only between cycles." );
+
+            m_cycles += cycles;
+            if( m_thisCycleStalled ){
+                m_stalledCycles += cycles;
+            }
+            if( m_stallPeriod > 0 ){
+                ASSERT( cycles <= m_stallPeriod );
+                m_stallPeriod -= (int)cycles;
+            }
+            m_lastCycleStalled = m_thisCycleStalled;
+
+            for( int i = 0; i < m_cycleCounterCount; i++ ){
+                *m_cycleCounters[i] += cycles;
+            }
+
+            Children::iterator end = m_children.end();
+            for( Children::iterator i = m_children.begin(); i != end; ++i ){
+                (*i)->SkipIdleCycles( cycles );
+            }
+
+            if( !m_thisCycleStalled ){
+                for( s64 i = 0; i < cycles; i++ ){
+                    Tick();
+                }
+            }
+        }
+
         // Is this resource stalled in a this cycle
         bool IsStalledThisCycle()
         {
@@ -311,6 +379,28 @@ namespace Onikiri
             m_priority = priority;
         }
 
+        // Increment a counter that is incremented on every cycle while 
+        // this resource is idle, such as the number of stalled cycles
+        // for each reason. Such counters must be incremented with this method
+        // for skipping idle cycles.
+        void IncrementCycleCounter( s64* counter )
+        {
+            ++(*counter);
+            if( m_cycleCounterCount < MAX_CYCLE_COUNTERS ){
+                m_cycleCounters[ m_cycleCounterCount ] = counter;
+            }
+            if( m_cycleCounterCount <= MAX_CYCLE_COUNTERS ){
+                m_cycleCounterCount++;
+            }
+        }
+
+        // Is this resource stalled in a last finished cycle.
+        // This method is for GetIdleCycles() and can be called between cycles.
+        bool IsStalledFinishedCycle() const
+        {
+            return m_thisCycleStalled;
+        }
+
 
     private:
         String m_name;
@@ -333,6 +423,12 @@ namespace Onikiri
         // Stalled cycles.
         s64  m_stalledCycles;
 
+        // Counters incremented with IncrementCycleCounter() in this cycle.
+        // 'm_cycleCounterCount' exceeds MAX_CYCLE_COUNTERS on overflow.
+        enum MaxCycleCounters{ MAX_CYCLE_COUNTERS = 4 };
+        s64* m_cycleCounters[ MAX_CYCLE_COUNTERS ];
+        int  m_cycleCounterCount;
+
         // Cycle phase
         PHASE m_phase;
 
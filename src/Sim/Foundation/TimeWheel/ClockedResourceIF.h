@@ -41,6 +41,8 @@ namespace Onikiri
     class ClockedResourceIF
     {
     public:
+        // GetIdleCycles() returns this value when idle cycles are not bounded.
+        enum IdleCycles{ IDLE_CYCLES_UNBOUNDED = 0x7fffffff };
 
         virtual ~ClockedResourceIF(){};
         
@@ -84,6 +86,21 @@ namespace Onikiri
         // Cancel a stall period set by StallNextCycle.
         virtual void CancelStallPeriod() = 0;
 
+
+        //
+        // --- These methods are called between cycles for skipping idle cycles.
+        //
+
+        // Returns the number of next cycles in which this resource does
+        // nothing but repeating a last cycle. Returns 0 if this resource
+        // works in a next cycle or cannot guarantee this.
+        virtual s64 GetIdleCycles() = 0;
+
+        // Proceed 'cycles' idle cycles at once.
+        // The results must be the same as those of calling the
+        // above 1-cycle methods 'cycles' times.
+        virtual void SkipIdleCycles( s64 cycles ) = 0;
+
         // Get a priority of this resource.
         // Priority constants are defined in "Sim/ResourcePriority.h".
         virtual int GetPriority() const = 0;
@@ -65,13 +65,17 @@ void TimeWheelBase::AddEvent( const ListNode& evnt, int time )
         "AddEvent() can be called only in PHASE_PROCESS/END."
     );
     ASSERT( time >= 0, "time is negative." );
-    ASSERT( m_size > time, "event list is not enough." );
     
     if( /*m_processedThisCycle &&*/ time == 0 ){
         evnt->TriggerUpdate();
         return;
     }
 
+    if( time >= m_size ){
+        m_farEvents.insert( FarEventMap::value_type( m_now + time, evnt ) );
+        return;
+    }
+
     //ASSERT( !(time == 0 && m_processedThisCycle == true) , "event added after process.");
 
     int id = IndexAfterTime( time );
@@ -87,6 +91,23 @@ void TimeWheelBase::Tick()
         m_current -= m_size;
     }
     ++m_now;
+
+    if( !m_farEvents.empty() ){
+        MoveFarEvents();
+    }
+}
+
+void TimeWheelBase::MoveFarEvents()
+{
+    while( !m_farEvents.empty() ){
+        FarEventMap::iterator e = m_farEvents.begin();
+        s64 time = e->first - m_now;
+        if( time >= m_size ){
+            break;
+        }
+        m_eventWheel.GetEventList( IndexAfterTime( (int)time ) )->AddEvent( e->second );
+        m_farEvents.erase( e );
+    }
 }
 
 
@@ -102,6 +123,79 @@ s64 TimeWheelBase::GetNow() const
     return m_now;
 }
 
+// Returns whether a list at 'index' has events that are not canceled.
+bool TimeWheelBase::HasActiveEvent( int index )
+{
+    const ListType* events = m_eventWheel.PeekEventList( index );
+    if( !events ){
+        return false;
+    }
+
+    ListType::ConstIteratorType end = events->end();
+    for( ListType::ConstIteratorType e = events->begin(); e != end; ++e ){
+        if( !e->event->IsCanceled() ){
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns the number of cycles until a cycle where any events are triggered.
+s64 TimeWheelBase::GetIdleCycles()
+{
+    s64 cycles = ClockedResourceBase::GetIdleCycles();
+    if( cycles == 0 ){
+        return 0;
+    }
+
+    // Events are not proceeded in a stalled wheel and 
+    // events on the current list are triggered in every cycle.
+    if( IsStalledFinishedCycle() ){
+        return HasActiveEvent( m_current ) ? 0 : cycles;
+    }
+
+    // Held events are moved to the wheel while skipped cycles are ticked, 
+    // and a skip must not pass the first of them.
+    if( !m_farEvents.empty() ){
+        cycles = std::min( cycles, m_farEvents.begin()->first - m_now );
+    }
+
+    int index = m_current;
+    for( s64 i = 0; i < cycles && i < m_size; i++ ){
+        if( HasActiveEvent( index ) ){
+            return i;
+        }
+        index++;
+        if( index >= m_size ){
+            index -= m_size;
+        }
+    }
+    return cycles;
+}
+
+// Skip idle cycles.
+// Lists of skipped cycles have only canceled events and they are cleared
+// as done in End().
+void TimeWheelBase::SkipIdleCycles( s64 cycles )
+{
+    if( !IsStalledFinishedCycle() ){
+        int index = m_current;
+        for( s64 i = 0; i < cycles && i < m_size; i++ ){
+            ListType* events = m_eventWheel.PeekEventList( index );
+            if( events ){
+                events->Clear();
+                m_eventWheel.ReleaseEventList( events, index );
+            }
+            index++;
+            if( index >= m_size ){
+                index -= m_size;
+            }
+        }
+    }
+
+    ClockedResourceBase::SkipIdleCycles( cycles );
+}
+
 // Process events.
 void TimeWheelBase::End()
 {
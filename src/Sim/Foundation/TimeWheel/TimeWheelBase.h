@@ -61,6 +61,8 @@ namespace Onikiri
         virtual ~TimeWheelBase();
 
         // Add events
+        // An event after the size of the wheel is held until its time comes 
+        // within the wheel.
         virtual void AddEvent( const ListNode& evnt, int time );
 
         // Process events.
@@ -69,6 +71,10 @@ namespace Onikiri
         // Proceed a time tick.
         virtual void Tick();
 
+        // Skip idle cycles until a cycle with events.
+        virtual s64  GetIdleCycles();
+        virtual void SkipIdleCycles( s64 cycles );
+
         // Get time tick count.
         // A difference between GetCycles() and GetNow is the following:
         //   GetCycles() returns the number of all experienced cycles, but 
@@ -107,6 +113,12 @@ namespace Onikiri
         }
 
     private:
+        // Returns whether a list at 'index' has events that are not canceled.
+        bool HasActiveEvent( int index );
+
+        // Move held events whose times come within the wheel to the wheel.
+        void MoveFarEvents();
+
         // m_event のどこを処理するか
         int m_current;
         
@@ -116,6 +128,11 @@ namespace Onikiri
         // Time tick
         s64 m_now;
 
+        // Events after the size of the wheel, keyed by the ticks 
+        // (GetNow()) at which they are triggered.
+        typedef std::multimap< s64, ListNode > FarEventMap;
+        FarEventMap m_farEvents;
+
         // Copy is forbidden
         TimeWheelBase( const TimeWheelBase& ref ){}
         TimeWheelBase& operator=( const TimeWheelBase &ref ){   return(*this);  }
@@ -33,6 +33,7 @@
 #define SIM_ISA_INFO_H
 
 #include "Interface/ISAInfo.h"
+#include "Emu/EmulatorISALimits.h"
 
 //
 // The following constants are used in Simulator section. 
@@ -60,10 +61,12 @@ namespace Onikiri
             static const int INSTRUCTION_WORD_BYTE_SIZE  = 4;
             static const int INSTRUCTION_WORD_BYTE_SHIFT = 2;
 
-            static const int MAX_SRC_REG_COUNT = 4;
-            static const int MAX_DST_REG_COUNT = 3;
+            // The limits of registers are derived from the traits of the target ISAs,
+            // because they size the register arrays of Op, RMT and so on.
+            static const int MAX_SRC_REG_COUNT = EmulatorISALimits::MAX_SRC_REG_COUNT;
+            static const int MAX_DST_REG_COUNT = EmulatorISALimits::MAX_DST_REG_COUNT;
 
-            static const int MAX_REG_COUNT = 10000;
+            static const int MAX_REG_COUNT = EmulatorISALimits::MAX_REG_COUNT;
             static const int MAX_REG_SEGMENT_COUNT = 6;
             static const int MAX_OP_INFO_COUNT_PER_PC = 4;
 
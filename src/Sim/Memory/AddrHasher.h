@@ -33,6 +33,7 @@
 #define SIM_MEMORY_ADR_HASHER_H
 
 #include "Lib/shttl/hasher.h"
+#include "Lib/shttl/setassoc_table.h"
 #include "Interface/Addr.h"
 
 namespace Onikiri
@@ -115,4 +116,18 @@ namespace Onikiri
 
 } // namespace Onikiri
 
+namespace shttl
+{
+    // Addr tags are compared in setassoc_table_strage_soa with their 
+    // addresses, and PIDs are compared only when the addresses are equal.
+    template <>
+    struct setassoc_table_tag_signature< Onikiri::Addr >
+    {
+        static u64 get( const Onikiri::Addr& tag )
+        {
+            return tag.address;
+        }
+    };
+}
+
 #endif // __ADR_HASHER_H
@@ -66,6 +66,8 @@
 #include "Sim/Memory/Prefetcher/PrefetcherIF.h"
 #include "Sim/Memory/Cache/CacheExtraStateTable.h"
 #include "Sim/Memory/Cache/CacheAccessRequestQueue.h"
+#include "Sim/Memory/DRAM/DRAMController.h"
+#include "Sim/Dumper/Dumper.h"
 
 //
 // --- Hooks
@@ -83,9 +85,12 @@ using namespace Onikiri;
 Cache::Cache() :
     m_latency           (0),
     m_nextLevelCache    (0),
+    m_parallelContext   (0),
     m_prefetcher        (0),
+    m_dramController    (0),
     m_perfect           (0),
     m_writePolicy       (WP_INVALID),
+    m_coherence         (CP_NONE),
     m_missedAccessList  (0),
     m_accessQueue       (0),
     m_level             (0),
@@ -109,6 +114,10 @@ Cache::Cache() :
     m_numWritePendingHit(0),
     m_numWrittenBackLines(0),
     m_numInvalidated    (0),
+    m_numCoherenceMiss  (0),
+    m_numCoherenceInvalidation(0),
+    m_numCoherenceDowngrade(0),
+    m_numUpgrade        (0),
     m_capacityKB        (0)
 {
     m_lineBitSize = 0;
@@ -191,6 +200,12 @@ void Cache::Initialize( InitPhase phase )
                 m_numWays 
             );
 
+        g_dumper.RegisterStatCounter( this, "NumReadHit",     &m_numReadHit );
+        g_dumper.RegisterStatCounter( this, "NumReadMiss",    &m_numReadMiss );
+        g_dumper.RegisterStatCounter( this, "NumReadAccess",  &m_numReadAccess );
+        g_dumper.RegisterStatCounter( this, "NumWriteHit",    &m_numWriteHit );
+        g_dumper.RegisterStatCounter( this, "NumWriteMiss",   &m_numWriteMiss );
+        g_dumper.RegisterStatCounter( this, "NumWriteAccess", &m_numWriteAccess );
     }
     else if( phase == INIT_POST_CONNECTION ){
         
@@ -215,8 +230,25 @@ void Cache::Initialize( InitPhase phase )
             THROW_RUNTIME_ERROR( "The last level of a memory hierarchy must be 'perfect'." );
         }
 
+        if( m_dramController ){
+            if( !m_perfect || m_nextLevelCache ){
+                THROW_RUNTIME_ERROR( "A DRAM controller can be connected only to the last level 'perfect' cache." );
+            }
+        }
+
+        if( m_coherence != CP_NONE ){
+            if( m_perfect ){
+                THROW_RUNTIME_ERROR( "A 'perfect' cache cannot have a coherence directory." );
+            }
+            if( m_prevLevelCaches.GetSize() > (int)(sizeof(u64) * 8) ){
+                THROW_RUNTIME_ERROR( "The number of previous level caches exceeds the limit of a coherence directory." );
+            }
+        }
+
         LineState initState;
         initState.dirty = false;
+        initState.sharers = 0;
+        initState.owner = -1;
         m_lineState->Resize( this, initState );
 
         DisableLatch();
@@ -311,8 +343,21 @@ void Cache::AddToMissedAccessList(
     );
 }
 
+// Get the latency of an access that hits in this cache.
+// If a DRAM is connected, its latency and the controller overhead are used 
+// instead of @Latency.
+int Cache::GetHitLatency( const Access& access )
+{
+    if( m_dramController ){
+        return 
+            m_dramController->GetControllerLatency() + 
+            (int)m_dramController->Access( access, GetLowerPipeline()->GetNow() );
+    }
+    return m_latency;
+}
+
 // Get the access latency of a hit access.
-Cache::Result Cache::OnReadHit( const Access& access)
+Cache::Result Cache::OnReadHit( const Access& access, int coherenceLatency )
 {
     // Update cache replacement information.
     if( !m_perfect ){
@@ -325,7 +370,7 @@ Cache::Result Cache::OnReadHit( const Access& access)
     result.latency = 
         (int)m_accessQueue->Push( 
             access, 
-            m_latency,
+            GetHitLatency( access ) + coherenceLatency,
             NULL,
             NotifyParam()
         );
@@ -359,8 +404,12 @@ Cache::Result Cache::OnReadMiss(
     const Access& access,
     CacheAccessNotifieeIF* notifee
 ){
+    if( IsCoherenceMiss( access.address ) ){
+        m_numCoherenceMiss++;
+    }
+
     // 次のレベルのキャッシュにレイテンシを問い合わせる
-    Result nextResult = m_nextLevelCache->Read( access, NULL );
+    Result nextResult = ReadNextLevel( access );
     int nextLatency = nextResult.latency;
 
     Result result( m_latency + nextLatency, Result::ST_MISS, nextResult.cache );
@@ -391,7 +440,9 @@ void Cache::ReadBody( CacheHookParam* param )
         CacheTableIterator line = m_cacheTable->find( addr );
         if( line != m_cacheTable->end() ){
             // Perfect or Hit
-            result = OnReadHit( access );
+            int coherenceLatency = 
+                m_coherence != CP_NONE ? UpdateDirectory( access, line ) : 0;
+            result = OnReadHit( access, coherenceLatency );
             param->line = line;
         } 
         else{
@@ -416,6 +467,8 @@ void Cache::ReadBody( CacheHookParam* param )
 
 Cache::Result Cache::Read( const Access& access, NotifieeIF* notifiee )
 {
+    std::unique_lock<std::recursive_mutex> lock = LockParallelAccess();
+
     CacheHookParam param;
     param.access = &access;
     param.table  = m_cacheTable;
@@ -434,8 +487,19 @@ Cache::Result Cache::Read( const Access& access, NotifieeIF* notifiee )
 
 
 // Processes on a cache hit.
-Cache::Result Cache::OnWriteHit( const Access& access )
+Cache::Result Cache::OnWriteHit( const Access& access, int coherenceLatency )
 {
+    // A write-back cache gets an exclusive ownership of the line from
+    // a coherence directory before writing it. A write-through cache does not
+    // need this, because its write invalidates the other copies.
+    if( m_writePolicy == WP_WRITE_BACK && 
+        m_nextLevelCache && m_nextLevelCache->IsCoherent()
+    ){
+        Access upgrade = access;
+        upgrade.requester = this;
+        coherenceLatency += m_nextLevelCache->Upgrade( upgrade );
+    }
+
     Result result( (int)m_latency, Result::ST_HIT, this );
     NotifyParam notification( CAET_WRITE_ACCESS_FINISHED, result );
 
@@ -443,7 +507,7 @@ Cache::Result Cache::OnWriteHit( const Access& access )
     result.latency = 
     (int)m_accessQueue->Push( 
         access, 
-        m_latency,
+        GetHitLatency( access ) + coherenceLatency,
         this,
         notification
     );
@@ -476,11 +540,14 @@ Cache::Result Cache::OnWriteMiss(
     const Access& access,
     CacheAccessNotifieeIF* notifee
 ){
+    if( IsCoherenceMiss( access.address ) ){
+        m_numCoherenceMiss++;
+    }
+
     // Write allocate
     Access writeAllocate = access;
     writeAllocate.type = Access::OT_READ_FOR_WRITE_ALLOCATE;
-    Result nextResult = 
-        m_nextLevelCache->Read( writeAllocate, NULL );
+    Result nextResult = ReadNextLevel( writeAllocate );
 
     int nextLatency = nextResult.latency;
     
@@ -499,6 +566,8 @@ Cache::Result Cache::OnWriteMiss(
 // レイテンシは，ライトミス時にライトアロケートにかかった時間を含む
 Cache::Result Cache::Write( const Access& access, NotifieeIF* notifiee )
 {
+    std::unique_lock<std::recursive_mutex> lock = LockParallelAccess();
+
     CacheHookParam param;
     param.access = &access;
     param.address   = &access.address;
@@ -533,7 +602,9 @@ void Cache::WriteBody( CacheHookParam* param )
         CacheTableIterator line = m_cacheTable->find( addr );
         if( line != m_cacheTable->end() ){
             // Hit
-            result = OnWriteHit( access );
+            int coherenceLatency = 
+                m_coherence != CP_NONE ? UpdateDirectory( access, line ) : 0;
+            result = OnWriteHit( access, coherenceLatency );
             param->line = line;
         }
         else{
@@ -567,6 +638,10 @@ void Cache::UpdateTableBody( CacheHookParam* param )
     const CacheAccess& access = *param->access;
     bool dirty = access.IsWirte();
 
+    // A directory entry is initialized when a line is newly allocated.
+    bool allocated = 
+        m_coherence != CP_NONE && m_cacheTable->find( access.address ) == m_cacheTable->end();
+
     bool replaced;
     CacheLine replacedLine;
     Addr replacedAddr;
@@ -580,9 +655,7 @@ void Cache::UpdateTableBody( CacheHookParam* param )
         // Perfect cache must not invalidate upper cache lines.
         if (!m_perfect) {
             // Invalidate replaced lines in previous level caches for keep inclusion.
-            for( int i = 0; i < m_prevLevelCaches.GetSize(); i++ ){
-                m_prevLevelCaches[i]->Invalidate( replacedAddr );
-            }
+            InvalidatePreviousLevelCaches( replacedAddr );
         }
         
         // Write back replaced lines to the next level cache.
@@ -594,7 +667,7 @@ void Cache::UpdateTableBody( CacheHookParam* param )
                     writeBack.value = 0;
                     writeBack.lineValue = replacedLine.value;
                     writeBack.type = AOT_WRITE_BACK;
-                    m_nextLevelCache->Write(writeBack, NULL);
+                    WriteNextLevel(writeBack);
                     m_numWrittenBackLines++;
                 }
             }
@@ -604,6 +677,12 @@ void Cache::UpdateTableBody( CacheHookParam* param )
     // Set a dirty flag.
     if (line != m_cacheTable->end()) {
         (*m_lineState)[line].dirty = dirty;
+
+        if (allocated) {
+            (*m_lineState)[line].sharers = 0;
+            (*m_lineState)[line].owner = -1;
+            UpdateDirectory(access, line);
+        }
     }
 }
 
@@ -626,6 +705,8 @@ void Cache::UpdateTable( const Access& access )
 // Invalidate line
 void Cache::Invalidate( const Addr& addr )
 {
+    std::unique_lock<std::recursive_mutex> lock = LockParallelAccess();
+
     CacheHookParam param;
     param.address = &addr;
     param.table  = m_cacheTable;
@@ -633,9 +714,7 @@ void Cache::Invalidate( const Addr& addr )
 
     HookEntry( this, &Cache::InvalidateBody, &s_invalidateHook, &param );
 
-    for (int i = 0; i < m_prevLevelCaches.GetSize(); i++) {
-        m_prevLevelCaches[i]->Invalidate(addr);
-    }
+    InvalidatePreviousLevelCaches( addr );
 
     if( m_prefetcher ){
         m_prefetcher->OnCacheInvalidation( this, &param );
@@ -652,7 +731,7 @@ void Cache::InvalidateBody( CacheHookParam* param )
                 writeBack.address = *param->address;
                 writeBack.value = 0;
                 writeBack.type = AOT_WRITE_BACK;
-                m_nextLevelCache->Write(writeBack, NULL);
+                WriteNextLevel(writeBack);
             }
         }
         m_cacheTable->invalidate(*param->address);
@@ -669,6 +748,13 @@ void Cache::AccessFinished( const Access& access, const NotifyParam& param )
     switch( param.type ){
     case CAET_FILL_FROM_MAL_FINISHED:
         ASSERT( !access.IsWirte() );
+        // Add a requester that waits a line filled by a preceding access.
+        if( m_coherence != CP_NONE ){
+            CacheTableIterator line = m_cacheTable->find( access.address );
+            if( line != m_cacheTable->end() ){
+                UpdateDirectory( access, line );
+            }
+        }
         break;
 
     case CAET_FILL_FROM_NEXT_CACHE_FINISHED:
@@ -689,7 +775,7 @@ void Cache::AccessFinished( const Access& access, const NotifyParam& param )
         ASSERT( access.IsWirte() );
         UpdateTable( access );
         if( m_writePolicy == WP_WRITE_THROUGH && !m_perfect ){
-            m_nextLevelCache->Write( access, NULL );
+            WriteNextLevel( access );
         }
         break;
 
@@ -729,6 +815,205 @@ void Cache::AddPreviousLevelCache( Cache* prev )
     m_prevLevelCaches.Add( prev );
 }
 
+// Invalidate a line in the previous level caches for keeping inclusion.
+void Cache::InvalidatePreviousLevelCaches( const Addr& addr )
+{
+    for( int i = 0; i < m_prevLevelCaches.GetSize(); i++ ){
+        if( m_parallelContext && m_parallelContext->parallelPhase ){
+            ParallelAccessContext::DeferredInvalidation invalidation = 
+                { m_prevLevelCaches[i], addr, false };
+            m_parallelContext->deferredInvalidations.push_back( invalidation );
+        }
+        else{
+            m_prevLevelCaches[i]->Invalidate( addr );
+        }
+    }
+}
+
+// Access the next level cache on behalf of this cache.
+// The next level cache identifies this cache as a requester.
+Cache::Result Cache::ReadNextLevel( const Access& access )
+{
+    Access next = access;
+    next.requester = this;
+    return m_nextLevelCache->Read( next, NULL );
+}
+
+Cache::Result Cache::WriteNextLevel( const Access& access )
+{
+    Access next = access;
+    next.requester = this;
+    return m_nextLevelCache->Write( next, NULL );
+}
+
+// Returns the index of a previous level cache that sends 'access'.
+int Cache::GetRequesterIndex( const Access& access )
+{
+    if( !access.requester ){
+        return -1;
+    }
+    for( int i = 0; i < m_prevLevelCaches.GetSize(); i++ ){
+        if( m_prevLevelCaches[i] == access.requester ){
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Update the directory entry of a line accessed from a previous level cache.
+// The E/M states are not distinguished in the directory, because a previous
+// level cache with an E line can write it without notifying the directory.
+int Cache::UpdateDirectory( const Access& access, CacheTableIterator line )
+{
+    int requester = GetRequesterIndex( access );
+    if( requester < 0 ){
+        return 0;
+    }
+
+    LineState& state = (*m_lineState)[line];
+    u64 requesterBit = (u64)1 << requester;
+    int latency = 0;
+
+    switch( access.type ){
+    case AOT_READ:
+    case AOT_PREFETCH:
+        // An E/M line in another cache is downgraded to the S state, 
+        // and the line is forwarded from the cache.
+        if( state.owner >= 0 && state.owner != requester ){
+            latency = m_prevLevelCaches[ state.owner ]->GetStaticLatency();
+            state.owner = -1;
+            m_numCoherenceDowngrade++;
+        }
+        state.sharers |= requesterBit;
+        
+        // The requester gets the line in the E state if there are no other sharers.
+        if( state.sharers == requesterBit ){
+            state.owner = requester;
+        }
+        break;
+
+    case AOT_WRITE:
+    case AOT_READ_FOR_WRITE_ALLOCATE:
+        latency = InvalidateSharers( access.address, &state, requester );
+        state.sharers = requesterBit;
+        state.owner = requester;
+        break;
+
+    case AOT_WRITE_BACK:
+        state.sharers &= ~requesterBit;
+        if( state.owner == requester ){
+            state.owner = -1;
+        }
+        break;
+    }
+
+    return latency;
+}
+
+// Invalidate a line in sharers except for 'requester'.
+// The invalidations are sent in parallel, so the latency is that of the 
+// slowest sharer.
+int Cache::InvalidateSharers( const Addr& addr, LineState* state, int requester )
+{
+    int latency = 0;
+    for( int i = 0; i < m_prevLevelCaches.GetSize(); i++ ){
+        if( i == requester || !(state->sharers & ((u64)1 << i)) ){
+            continue;
+        }
+
+        Cache* sharer = m_prevLevelCaches[i];
+        if( m_parallelContext && m_parallelContext->parallelPhase ){
+            ParallelAccessContext::DeferredInvalidation invalidation = 
+                { sharer, addr, true };
+            m_parallelContext->deferredInvalidations.push_back( invalidation );
+        }
+        else{
+            sharer->InvalidateByCoherence( addr );
+        }
+
+        latency = std::max( latency, sharer->GetStaticLatency() );
+        m_numCoherenceInvalidation++;
+    }
+    state->sharers &= ((u64)1 << requester);
+    return latency;
+}
+
+// Get an exclusive ownership of a line for a write from a previous level cache.
+// A line in the E state is upgraded to the M state without any latency.
+int Cache::Upgrade( const Access& access )
+{
+    std::unique_lock<std::recursive_mutex> lock = LockParallelAccess();
+
+    int requester = GetRequesterIndex( access );
+    if( requester < 0 || m_coherence == CP_NONE ){
+        return 0;
+    }
+
+    CacheTableIterator line = m_cacheTable->find( access.address );
+    if( line == m_cacheTable->end() ){
+        return 0;
+    }
+
+    LineState& state = (*m_lineState)[line];
+    if( state.owner == requester ){
+        return 0;
+    }
+
+    m_numUpgrade++;
+    int latency = m_latency + InvalidateSharers( access.address, &state, requester );
+    state.sharers = (u64)1 << requester;
+    state.owner = requester;
+
+    return (int)m_accessQueue->Push( access, latency, NULL, NotifyParam() );
+}
+
+// Invalidate line for keeping coherence.
+void Cache::InvalidateByCoherence( const Addr& addr )
+{
+    std::unique_lock<std::recursive_mutex> lock = LockParallelAccess();
+
+    if( !m_perfect && m_cacheTable->find( addr ) != m_cacheTable->end() ){
+        // Forget old lines when the number of lines exceeds the capacity,
+        // because such lines are likely to be capacity misses.
+        if( (int)m_coherenceInvalidatedLines.size() >= GetIndexCount() * GetWayCount() ){
+            m_coherenceInvalidatedLines.clear();
+        }
+        Addr lineAddr = addr;
+        lineAddr.address &= ~(((u64)1 << m_offsetBitSize) - 1);
+        m_coherenceInvalidatedLines.insert( lineAddr );
+    }
+
+    Invalidate( addr );
+}
+
+// Returns true and forget a line if a miss to the line is caused by
+// a coherence invalidation.
+bool Cache::IsCoherenceMiss( const Addr& addr )
+{
+    if( m_coherenceInvalidatedLines.empty() ){
+        return false;
+    }
+
+    Addr lineAddr = addr;
+    lineAddr.address &= ~(((u64)1 << m_offsetBitSize) - 1);
+    return m_coherenceInvalidatedLines.erase( lineAddr ) > 0;
+}
+
+void Cache::SetParallelAccessContext( ParallelAccessContext* context )
+{
+    m_parallelContext = context;
+}
+
+// Lock this cache if it is accessed from multiple host threads.
+// An empty lock is returned otherwise.
+std::unique_lock<std::recursive_mutex> Cache::LockParallelAccess()
+{
+    if( m_parallelContext && m_parallelContext->parallelPhase ){
+        return std::unique_lock<std::recursive_mutex>( m_parallelContext->lock );
+    }
+    return std::unique_lock<std::recursive_mutex>();
+}
+
 int Cache::GetOffsetBitSize() const
 {
     return m_offsetBitSize;
@@ -737,6 +1022,7 @@ int Cache::GetOffsetBitSize() const
 // Returns true when resources (a request queue etc) are full and stall is required.
 bool Cache::IsStallRequired()
 {
+    std::unique_lock<std::recursive_mutex> lock = LockParallelAccess();
 
     if( m_nextLevelCache && m_nextLevelCache->IsStallRequired() ){
         return true;
@@ -50,6 +50,7 @@ namespace Onikiri
     class CacheAccessRequestQueue;
     class Core;
     class PrefetcherIF;
+    class DRAMController;
     template < 
         typename ValueType, 
         typename ContainerType
@@ -82,6 +83,10 @@ namespace Onikiri
                     PARAM_BINDING_ENTRY( "WriteThrough", WP_WRITE_THROUGH )
                     PARAM_BINDING_ENTRY( "WriteBack",    WP_WRITE_BACK )
                 END_PARAM_BINDING()
+                BEGIN_PARAM_BINDING( "@Coherence", m_coherence, Coherence )
+                    PARAM_BINDING_ENTRY( "None", CP_NONE )
+                    PARAM_BINDING_ENTRY( "MESI", CP_MESI )
+                END_PARAM_BINDING()
             END_PARAM_PATH()
             BEGIN_PARAM_PATH( GetResultPath() )
                 PARAM_ENTRY("@TableName",           m_name);
@@ -99,6 +104,10 @@ namespace Onikiri
                 PARAM_ENTRY("@NumWritePendingHit",  m_numWritePendingHit);
                 PARAM_ENTRY("@NumWrittenBackLines", m_numWrittenBackLines);
                 PARAM_ENTRY("@NumInvalidatedLines", m_numInvalidated);
+                PARAM_ENTRY("@NumCoherenceMiss",    m_numCoherenceMiss);
+                PARAM_ENTRY("@NumCoherenceInvalidation",    m_numCoherenceInvalidation);
+                PARAM_ENTRY("@NumCoherenceDowngrade",       m_numCoherenceDowngrade);
+                PARAM_ENTRY("@NumUpgrade",          m_numUpgrade);
                 PARAM_ENTRY("@CapacityKByte",       m_capacityKB);
                 PARAM_ENTRY("@MaxThroughputBytesPerCycle",  m_maxThroughputBytesPerCycle );
                 RESULT_RATE_ENTRY("@NumReadHitRate",  m_numReadHit,  m_numReadAccess )
@@ -110,6 +119,7 @@ namespace Onikiri
             RESOURCE_ENTRY( Core,   "core",     m_core )
             RESOURCE_ENTRY( Thread, "thread",   m_thread )
             RESOURCE_OPTIONAL_ENTRY(        PrefetcherIF,   "prefetcher",   m_prefetcher )
+            RESOURCE_OPTIONAL_ENTRY(        DRAMController, "dramController",   m_dramController )
             RESOURCE_OPTIONAL_SETTER_ENTRY( Cache,          "cache",        SetNextCache )
         END_RESOURCE_MAP()
 
@@ -152,6 +162,18 @@ namespace Onikiri
         // Invalidate line
         void Invalidate( const Addr& addr );
 
+        // Invalidate line for keeping coherence.
+        // A next miss to the line is counted as a coherence miss.
+        void InvalidateByCoherence( const Addr& addr );
+
+        // Returns true if this cache has a coherence directory of 
+        // its previous level caches.
+        bool IsCoherent() const { return m_coherence != CP_NONE; }
+
+        // Get an exclusive ownership of a line for a write from a previous 
+        // level cache, and return the latency of the upgrade.
+        int Upgrade( const Access& access );
+
         // キャッシュのラインサイズをオフセットのビット数で返す
         int GetOffsetBitSize() const;
 
@@ -170,6 +192,41 @@ namespace Onikiri
         int GetIndexCount() { return 1 << m_indexBitSize; }
         int GetWayCount()   { return m_numWays;           }
 
+        // The numbers of accesses and misses so far, used for triggering dumps.
+        s64 GetNumAccess() const { return m_numReadAccess + m_numWriteAccess; }
+        s64 GetNumMiss()   const { return m_numReadMiss   + m_numWriteMiss;   }
+
+        // A context of a cache shared by cores that are simulated on 
+        // different host threads in the parallel simulation engine.
+        struct ParallelAccessContext
+        {
+            // Accesses from the cores are serialized with this lock.
+            // This is recursive because a shared cache accesses its next
+            // level cache, which is also shared.
+            std::recursive_mutex lock;
+
+            // True while the cores are simulated in parallel.
+            bool parallelPhase;
+
+            // Invalidations of previous level caches are deferred until 
+            // the end of a parallel phase, because the previous level caches
+            // are simulated on other host threads.
+            struct DeferredInvalidation
+            {
+                Cache* cache;
+                Addr   addr;
+                bool   coherence;   // An invalidation by the coherence protocol.
+            };
+            std::vector< DeferredInvalidation > deferredInvalidations;
+
+            ParallelAccessContext() : parallelPhase( false )
+            {
+            }
+        };
+
+        // Set a context when this cache is shared between host threads.
+        void SetParallelAccessContext( ParallelAccessContext* context );
+
         //
         // --- PipelineNodeIF/PipelineNodeBase
         //
@@ -222,6 +279,13 @@ namespace Onikiri
         struct LineState
         {
             bool dirty;
+
+            // Coherence directory entries, which are used when @Coherence is enabled.
+            // 'sharers' is a bit vector of previous level caches that may have
+            // the line, and 'owner' is an index of a previous level cache that 
+            // has the line in the E/M state.
+            u64  sharers;
+            int  owner;
         };
         typedef CacheExtraStateTable< LineState, std::vector<LineState> > ExtraStateTableType;
         ExtraStateTableType* m_lineState;
@@ -232,9 +296,17 @@ namespace Onikiri
         // Previous level caches
         PhysicalResourceArray<Cache> m_prevLevelCaches;
 
+        // A context for the parallel simulation engine.
+        // This is NULL unless this cache is shared between host threads.
+        ParallelAccessContext* m_parallelContext;
+
         // プリフェッチャ
         PrefetcherIF* m_prefetcher;
 
+        // A DRAM timing model below the last level cache.
+        // This is NULL when the memory has the fixed latency.
+        DRAMController* m_dramController;
+
         int m_perfect;
 
         // Throughput of this cache specified by bytes per cycle.
@@ -254,6 +326,20 @@ namespace Onikiri
         };
         WritePolicy m_writePolicy;
 
+        // Coherence protocol
+        // A cache with a protocol keeps a directory of lines in its previous 
+        // level caches, so it must be inclusive and not be 'perfect'.
+        enum Coherence
+        {
+            CP_NONE,
+            CP_MESI
+        };
+        Coherence m_coherence;
+
+        // Lines invalidated by a coherence protocol.
+        // This is used for counting coherence misses.
+        std::set<Addr> m_coherenceInvalidatedLines;
+
         // A list of memory accesses that access this cache/memory layer.
         CacheMissedAccessList* m_missedAccessList;      
 
@@ -292,8 +378,15 @@ namespace Onikiri
         s64 m_numWrittenBackLines;  // The number of cache lines written back
 
         s64 m_numInvalidated;       // The number of invalidated lines.
+        s64 m_numCoherenceMiss;         // Misses caused by coherence invalidations.
+        s64 m_numCoherenceInvalidation; // Lines invalidated in previous level caches for coherence.
+        s64 m_numCoherenceDowngrade;    // E/M lines downgraded to the S state in previous level caches.
+        s64 m_numUpgrade;               // Requests of exclusive ownership for writes.
         s64 m_capacityKB;           // 容量(キロバイト)
 
+        // Get the latency of an access that hits in this cache.
+        int GetHitLatency( const Access& access );
+
         // Returns whether an access is prefetch or not.
         bool IsPrefetch( const Access& access );
 
@@ -316,7 +409,8 @@ namespace Onikiri
         //
 
         // Processes on a cache hit.
-        Result OnReadHit( const Access& access);
+        // 'coherenceLatency' is an additional latency for keeping coherence.
+        Result OnReadHit( const Access& access, int coherenceLatency = 0 );
 
         // Processes on a cache partial hit (hits in PendingAccess).
         Result OnReadPendingHit( 
@@ -336,7 +430,7 @@ namespace Onikiri
         //
 
         // Processes on a cache hit.
-        Result OnWriteHit( const Access& access);
+        Result OnWriteHit( const Access& access, int coherenceLatency = 0 );
 
         // Processes on a cache partial hit (hits in PendingAccess).
         Result OnWritePendingHit( 
@@ -354,6 +448,36 @@ namespace Onikiri
         // Write an access to the cache table.
         void UpdateTable( const Access& access );
 
+        // Invalidate a line in the previous level caches for keeping inclusion.
+        void InvalidatePreviousLevelCaches( const Addr& addr );
+
+        // Access the next level cache on behalf of this cache.
+        Result ReadNextLevel( const Access& access );
+        Result WriteNextLevel( const Access& access );
+
+        //
+        // --- Coherence
+        //
+
+        // Returns the index of a previous level cache that sends 'access'.
+        // -1 is returned if it is not sent from a previous level cache.
+        int GetRequesterIndex( const Access& access );
+
+        // Update the directory entry of 'line' for 'access' and return an 
+        // additional latency for the coherence actions.
+        int UpdateDirectory( const Access& access, CacheTableIterator line );
+
+        // Invalidate 'addr' in sharers except for 'requester' and 
+        // return the latency of the invalidations.
+        int InvalidateSharers( const Addr& addr, LineState* state, int requester );
+
+        // Returns true and forget a line if a miss to the line is caused by
+        // a coherence invalidation.
+        bool IsCoherenceMiss( const Addr& addr );
+
+        // Lock this cache if it is accessed from multiple host threads.
+        std::unique_lock<std::recursive_mutex> LockParallelAccess();
+
 
         //
         // Implements
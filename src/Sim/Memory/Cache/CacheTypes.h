@@ -53,11 +53,19 @@ namespace Onikiri
         std::pair<Addr, CacheLineValue> 
         CachePair;
 
+    // Tags are compared with SIMD instructions, because last level caches
+    // have large associativity.
+    typedef 
+        shttl::setassoc_table_strage_soa< 
+            shttl::setassoc_table_line_base< CachePair >
+        >
+        CacheStrage;
     typedef 
         shttl::setassoc_table<
             CachePair, 
             CacheHasher,
-            shttl::lru_list< Addr, u8 >
+            shttl::lru_list< Addr, u8 >,
+            CacheStrage
         >
         CacheTable;
 
@@ -105,6 +113,10 @@ namespace Onikiri
         OpIterator     op;
         CacheLineValue lineValue;
 
+        // A previous level cache that sends this access to a next level cache.
+        // This is NULL when the access comes from a core or a prefetcher.
+        Cache*         requester;
+
         CacheAccess(
             const MemAccess& newMem   = MemAccess(), 
             OpIterator       op       = OpIterator(),
@@ -114,7 +126,8 @@ namespace Onikiri
             MemAccess( newMem ),
             type ( newType ),
             op   ( op ),
-            lineValue( newLineValue )
+            lineValue( newLineValue ),
+            requester( NULL )
         {
         }
 
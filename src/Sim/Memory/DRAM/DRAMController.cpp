@@ -0,0 +1,358 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+#include <pch.h>
+
+#include "Sim/Memory/DRAM/DRAMController.h"
+
+using namespace std;
+using namespace Onikiri;
+
+
+DRAMController::DRAMController() :
+    m_numChannels( 0 ),
+    m_numRanks( 0 ),
+    m_numBanks( 0 ),
+    m_rowBufferBytes( 0 ),
+    m_offsetBitSize( 0 ),
+    m_rowPolicy( RP_OPEN ),
+    m_controllerLatency( 0 ),
+    m_tCL( 0 ),
+    m_tRCD( 0 ),
+    m_tRP( 0 ),
+    m_tRAS( 0 ),
+    m_tBurst( 0 ),
+    m_tRRD( 0 ),
+    m_tFAW( 0 ),
+    m_tWR( 0 ),
+    m_tRTP( 0 ),
+    m_tREFI( 0 ),
+    m_tRFC( 0 ),
+    m_mode( SM_SIMULATION ),
+    m_numAccesses( 0 ),
+    m_numTotalRowHits( 0 ),
+    m_totalLatency( 0 ),
+    m_averageLatency( 0.0 )
+{
+    for( int i = 0; i < AF_NUM; i++ ){
+        m_fieldBits[i] = 0;
+    }
+}
+
+DRAMController::~DRAMController()
+{
+}
+
+static int GetBitCount( int value, const char* name )
+{
+    if( value <= 0 || ( value & ( value - 1 ) ) != 0 ){
+        THROW_RUNTIME_ERROR( "'%s' (%d) must be a power of 2.", name, value );
+    }
+    int bits = 0;
+    while( ( 1 << bits ) < value ){
+        bits++;
+    }
+    return bits;
+}
+
+void DRAMController::Initialize( InitPhase phase )
+{
+    if( phase == INIT_PRE_CONNECTION ){
+        LoadParam();
+
+        m_fieldBits[ AF_CHANNEL ] = GetBitCount( m_numChannels, "@Channels" );
+        m_fieldBits[ AF_RANK ]    = GetBitCount( m_numRanks, "@Ranks" );
+        m_fieldBits[ AF_BANK ]    = GetBitCount( m_numBanks, "@Banks" );
+        int rowBufferBits = GetBitCount( m_rowBufferBytes, "@RowBufferBytes" );
+        if( rowBufferBits < m_offsetBitSize ){
+            THROW_RUNTIME_ERROR( "'@RowBufferBytes' is smaller than a line." );
+        }
+        m_fieldBits[ AF_COLUMN ] = rowBufferBits - m_offsetBitSize;
+        ParseAddressMapping();
+
+        if( m_controllerLatency < 0 ){
+            THROW_RUNTIME_ERROR( "'@ControllerLatency' must not be negative." );
+        }
+        if( m_tBurst <= 0 ){
+            THROW_RUNTIME_ERROR( "'@tBurst' must be greater than 0." );
+        }
+        if( m_tREFI != 0 && m_tREFI <= m_tRFC + m_tRCD + m_tCL + m_tBurst ){
+            THROW_RUNTIME_ERROR( "'@tREFI' is too short to access a bank between refreshes." );
+        }
+
+        int totalRanks = m_numChannels * m_numRanks;
+        int totalBanks = totalRanks * m_numBanks;
+
+        Bank initBank;
+        initBank.rowOpened      = false;
+        initBank.openRow        = 0;
+        initBank.activateTime   = 0;
+        initBank.prechargeReady = 0;
+        initBank.activateReady  = 0;
+        initBank.numReads       = 0;
+        initBank.numWrites      = 0;
+        initBank.numRowHits     = 0;
+        initBank.numRowMisses   = 0;
+        initBank.numRowConflicts = 0;
+        m_banks.resize( totalBanks, initBank );
+
+        Rank initRank;
+        initRank.lastActivateTime = -m_tRRD;
+        m_ranks.resize( totalRanks, initRank );
+
+        m_channels.resize( m_numChannels );
+    }
+}
+
+// Per-bank statistics are written in the order of channels, ranks and banks.
+void DRAMController::Finalize()
+{
+    m_numReads.clear();
+    m_numWrites.clear();
+    m_numRowHits.clear();
+    m_numRowMisses.clear();
+    m_numRowConflicts.clear();
+    for( vector<Bank>::iterator i = m_banks.begin(); i != m_banks.end(); ++i ){
+        m_numReads.push_back( i->numReads );
+        m_numWrites.push_back( i->numWrites );
+        m_numRowHits.push_back( i->numRowHits );
+        m_numRowMisses.push_back( i->numRowMisses );
+        m_numRowConflicts.push_back( i->numRowConflicts );
+    }
+
+    if( m_numAccesses > 0 ){
+        m_averageLatency = (double)m_totalLatency / (double)m_numAccesses;
+    }
+
+    ReleaseParam();
+}
+
+void DRAMController::ChangeSimulationMode( SimulationMode mode )
+{
+    m_mode = mode;
+}
+
+// @AddressMapping lists the fields of a line address from the most 
+// significant one with two letter names: 'Ro'(row), 'Ra'(rank), 
+// 'Ba'(bank), 'Ch'(channel) and 'Co'(column). 'Ro' must be the first, 
+// because it has all the remaining bits.
+void DRAMController::ParseAddressMapping()
+{
+    static const struct
+    {
+        const char* name;
+        AddressField field;
+    } names[] = 
+    {
+        { "Ro", AF_ROW },
+        { "Ra", AF_RANK },
+        { "Ba", AF_BANK },
+        { "Ch", AF_CHANNEL },
+        { "Co", AF_COLUMN },
+    };
+
+    const string mapping = m_addressMapping;
+    vector<AddressField> fields;
+    for( size_t pos = 0; pos < mapping.size(); pos += 2 ){
+        string name = mapping.substr( pos, 2 );
+        bool found = false;
+        for( size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++ ){
+            if( name == names[i].name ){
+                if( find( fields.begin(), fields.end(), names[i].field ) != fields.end() ){
+                    break;
+                }
+                fields.push_back( names[i].field );
+                found = true;
+                break;
+            }
+        }
+        if( !found ){
+            THROW_RUNTIME_ERROR( "'@AddressMapping' ('%s') is invalid.", mapping.c_str() );
+        }
+    }
+
+    if( fields.size() != AF_NUM || fields[0] != AF_ROW ){
+        THROW_RUNTIME_ERROR( 
+            "'@AddressMapping' ('%s') must have all of 'Ro', 'Ra', 'Ba', 'Ch' and 'Co', "
+            "and 'Ro' must be the first.", 
+            mapping.c_str() 
+        );
+    }
+
+    m_fieldOrder.assign( fields.rbegin(), fields.rend() - 1 );
+}
+
+DRAMController::Location DRAMController::Decode( u64 address ) const
+{
+    u64 line = address >> m_offsetBitSize;
+    u64 value[ AF_NUM ] = { 0 };
+    for( size_t i = 0; i < m_fieldOrder.size(); i++ ){
+        AddressField field = m_fieldOrder[i];
+        value[ field ] = line & ( ( (u64)1 << m_fieldBits[ field ] ) - 1 );
+        line >>= m_fieldBits[ field ];
+    }
+
+    Location location;
+    location.channel = (int)value[ AF_CHANNEL ];
+    location.rank    = (int)value[ AF_RANK ];
+    location.bank    = (int)value[ AF_BANK ];
+    location.row     = line;
+    return location;
+}
+
+// All the banks are refreshed in [k*tREFI, k*tREFI + tRFC) (k >= 1), 
+// and the rows opened before a refresh are closed by the refresh.
+s64 DRAMController::GetNextRefreshTime( s64 time ) const
+{
+    if( m_tREFI == 0 ){
+        return numeric_limits<s64>::max();
+    }
+    return ( time / m_tREFI + 1 ) * m_tREFI;
+}
+
+s64 DRAMController::AvoidRefresh( s64 time ) const
+{
+    if( m_tREFI == 0 || time < m_tREFI ){
+        return time;
+    }
+    s64 offset = time % m_tREFI;
+    return offset < m_tRFC ? time - offset + m_tRFC : time;
+}
+
+s64 DRAMController::FindBusSlot( const Channel& channel, s64 time ) const
+{
+    set<s64>::const_iterator i = channel.busSlots.lower_bound( time - m_tBurst + 1 );
+    while( i != channel.busSlots.end() && *i < time + m_tBurst ){
+        time = *i + m_tBurst;
+        ++i;
+    }
+    return time;
+}
+
+s64 DRAMController::Access( const CacheAccess& access, s64 now )
+{
+    if( m_mode != SM_SIMULATION ){
+        // Timing is not simulated in the other modes.
+        return m_tRCD + m_tCL + m_tBurst;
+    }
+
+    Location location = Decode( access.address.address );
+    int rankIndex = location.channel * m_numRanks + location.rank;
+    Channel& channel = m_channels[ location.channel ];
+    Rank&    rank    = m_ranks[ rankIndex ];
+    Bank&    bank    = m_banks[ rankIndex * m_numBanks + location.bank ];
+    bool write = access.IsWirte();
+
+    // Release the slots of the data transfers that have finished.
+    while( !channel.busSlots.empty() && *channel.busSlots.begin() + m_tBurst <= now ){
+        channel.busSlots.erase( channel.busSlots.begin() );
+    }
+
+    s64 rowCloseTime = bank.rowOpened ? GetNextRefreshTime( bank.activateTime ) : now;
+    bool rowOpened = bank.rowOpened && now < rowCloseTime;
+
+    // Try to serve the access from the open row.
+    s64 dataTime = -1;
+    if( rowOpened && bank.openRow == location.row ){
+        s64 columnTime = max( now, bank.activateTime + m_tRCD );
+        s64 time = FindBusSlot( channel, columnTime + m_tCL );
+        if( time + m_tBurst <= rowCloseTime ){
+            dataTime = time;
+            bank.numRowHits++;
+            m_numTotalRowHits++;
+        }
+    }
+
+    if( dataTime < 0 ){
+        if( rowOpened ){
+            bank.numRowConflicts++;
+        }
+        else{
+            bank.numRowMisses++;
+        }
+
+        // The earliest activation after the current row is closed by 
+        // a precharge or a refresh.
+        s64 activateTime = bank.activateReady;
+        if( bank.rowOpened ){
+            s64 prechargeTime = max( now, bank.prechargeReady );
+            activateTime = prechargeTime < rowCloseTime ? prechargeTime + m_tRP : rowCloseTime;
+        }
+        activateTime = max( activateTime, now );
+        activateTime = max( activateTime, rank.lastActivateTime + m_tRRD );
+        if( rank.recentActivations.size() >= 4 ){
+            activateTime = max( activateTime, rank.recentActivations.front() + m_tFAW );
+        }
+
+        // Transfer data before a next refresh.
+        while( true ){
+            activateTime = AvoidRefresh( activateTime );
+            dataTime = FindBusSlot( channel, activateTime + m_tRCD + m_tCL );
+            if( dataTime + m_tBurst <= GetNextRefreshTime( activateTime ) ){
+                break;
+            }
+            activateTime = GetNextRefreshTime( activateTime );
+        }
+
+        bank.rowOpened      = true;
+        bank.openRow        = location.row;
+        bank.activateTime   = activateTime;
+        bank.prechargeReady = activateTime + m_tRAS;
+
+        rank.lastActivateTime = max( rank.lastActivateTime, activateTime );
+        rank.recentActivations.push_back( activateTime );
+        if( rank.recentActivations.size() > 4 ){
+            rank.recentActivations.pop_front();
+        }
+    }
+
+    channel.busSlots.insert( dataTime );
+
+    s64 columnTime = dataTime - m_tCL;
+    s64 prechargeReady = write ? dataTime + m_tBurst + m_tWR : columnTime + m_tRTP;
+    bank.prechargeReady = max( bank.prechargeReady, prechargeReady );
+    if( m_rowPolicy == RP_CLOSED ){
+        bank.rowOpened = false;
+        bank.activateReady = AvoidRefresh( bank.prechargeReady + m_tRP );
+    }
+
+    if( write ){
+        bank.numWrites++;
+    }
+    else{
+        bank.numReads++;
+    }
+
+    s64 latency = dataTime + m_tBurst - now;
+    m_numAccesses++;
+    m_totalLatency += latency;
+    return latency;
+}
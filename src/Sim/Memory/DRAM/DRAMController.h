@@ -0,0 +1,231 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+//
+// A DRAM timing model used as the main memory.
+//
+// A controller is connected to the last level cache, which must be 
+// 'perfect', and determines the latency of each access from the states 
+// of the channels, ranks, banks and row buffers.
+//
+// The latency of an access must be determined when the access is issued, 
+// because the cache hierarchy returns it to its requester immediately. 
+// So commands are scheduled when each access arrives, in the following 
+// FR-FCFS manner:
+//   - An access that hits an open row is served from the row buffer in 
+//     the first free slot of the data bus, and may pass accesses that 
+//     arrived earlier (first ready).
+//   - The other accesses precharge and activate a bank in arrival order 
+//     (first come, first served).
+//
+// All timing parameters are specified in core cycles.
+//
+
+#ifndef SIM_MEMORY_DRAM_DRAM_CONTROLLER_H
+#define SIM_MEMORY_DRAM_DRAM_CONTROLLER_H
+
+#include "Env/Param/ParamExchange.h"
+#include "Sim/Foundation/Resource/ResourceNode.h"
+#include "Sim/Memory/Cache/CacheTypes.h"
+
+namespace Onikiri
+{
+    class DRAMController : public PhysicalResourceNode
+    {
+    public:
+
+        BEGIN_PARAM_MAP("")
+            BEGIN_PARAM_PATH( GetParamPath() )
+                PARAM_ENTRY( "@Channels",       m_numChannels )
+                PARAM_ENTRY( "@Ranks",          m_numRanks )
+                PARAM_ENTRY( "@Banks",          m_numBanks )
+                PARAM_ENTRY( "@RowBufferBytes", m_rowBufferBytes )
+                PARAM_ENTRY( "@OffsetBitSize",  m_offsetBitSize )
+                PARAM_ENTRY( "@AddressMapping", m_addressMapping )
+                PARAM_ENTRY( "@ControllerLatency",  m_controllerLatency )
+                BEGIN_PARAM_BINDING( "@RowPolicy", m_rowPolicy, RowPolicy )
+                    PARAM_BINDING_ENTRY( "Open",   RP_OPEN )
+                    PARAM_BINDING_ENTRY( "Closed", RP_CLOSED )
+                END_PARAM_BINDING()
+                PARAM_ENTRY( "@tCL",    m_tCL )
+                PARAM_ENTRY( "@tRCD",   m_tRCD )
+                PARAM_ENTRY( "@tRP",    m_tRP )
+                PARAM_ENTRY( "@tRAS",   m_tRAS )
+                PARAM_ENTRY( "@tBurst", m_tBurst )
+                PARAM_ENTRY( "@tRRD",   m_tRRD )
+                PARAM_ENTRY( "@tFAW",   m_tFAW )
+                PARAM_ENTRY( "@tWR",    m_tWR )
+                PARAM_ENTRY( "@tRTP",   m_tRTP )
+                PARAM_ENTRY( "@tREFI",  m_tREFI )
+                PARAM_ENTRY( "@tRFC",   m_tRFC )
+            END_PARAM_PATH()
+            BEGIN_PARAM_PATH( GetResultPath() )
+                PARAM_ENTRY( "@NumReads",       m_numReads )
+                PARAM_ENTRY( "@NumWrites",      m_numWrites )
+                PARAM_ENTRY( "@NumRowHits",     m_numRowHits )
+                PARAM_ENTRY( "@NumRowMisses",   m_numRowMisses )
+                PARAM_ENTRY( "@NumRowConflicts",    m_numRowConflicts )
+                PARAM_ENTRY( "@NumAccesses",    m_numAccesses )
+                PARAM_ENTRY( "@AverageLatency", m_averageLatency )
+                RESULT_RATE_ENTRY( "@RowHitRate", m_numTotalRowHits, m_numAccesses )
+            END_PARAM_PATH()
+        END_PARAM_MAP()
+
+        BEGIN_RESOURCE_MAP()
+        END_RESOURCE_MAP()
+
+        DRAMController();
+        virtual ~DRAMController();
+
+        // --- PhysicalResourceNode
+        virtual void Initialize( InitPhase phase );
+        virtual void Finalize();
+        virtual void ChangeSimulationMode( SimulationMode mode );
+
+        // Schedule an access arriving at 'now' and return its latency.
+        // The latency does not include the controller overhead.
+        s64 Access( const CacheAccess& access, s64 now );
+
+        // The overhead of the controller added to the latency of each access.
+        int GetControllerLatency() const { return m_controllerLatency; }
+
+    protected:
+        enum RowPolicy
+        {
+            RP_OPEN,    // A row is left open after an access.
+            RP_CLOSED   // A row is precharged after an access.
+        };
+
+        // Fields of an address in @AddressMapping.
+        enum AddressField
+        {
+            AF_ROW,
+            AF_RANK,
+            AF_BANK,
+            AF_CHANNEL,
+            AF_COLUMN,
+            AF_NUM
+        };
+
+        struct Location
+        {
+            int channel;
+            int rank;
+            int bank;
+            u64 row;
+        };
+
+        struct Bank
+        {
+            bool rowOpened;
+            u64  openRow;
+            s64  activateTime;      // The time when the open row is activated.
+            s64  prechargeReady;    // The earliest time when the open row can be precharged.
+            s64  activateReady;     // The earliest time of a next activation if no row is open.
+
+            // Statistics
+            s64 numReads;
+            s64 numWrites;
+            s64 numRowHits;
+            s64 numRowMisses;       // Accesses to a bank without an open row
+            s64 numRowConflicts;    // Accesses to a bank with another open row
+        };
+
+        struct Rank
+        {
+            s64 lastActivateTime;
+            std::deque<s64> recentActivations;  // The last 4 activations for tFAW
+        };
+
+        struct Channel
+        {
+            std::set<s64> busSlots;     // Beginning times of data transfers on the bus
+        };
+
+        int m_numChannels;
+        int m_numRanks;
+        int m_numBanks;
+        int m_rowBufferBytes;
+        int m_offsetBitSize;
+        String m_addressMapping;
+        RowPolicy m_rowPolicy;
+        int m_controllerLatency;
+
+        // Fields of @AddressMapping from the least significant one.
+        std::vector<AddressField> m_fieldOrder;
+        int m_fieldBits[ AF_NUM ];
+
+        int m_tCL;      // Column access to data
+        int m_tRCD;     // Activation to column access
+        int m_tRP;      // Precharge to activation
+        int m_tRAS;     // Activation to precharge
+        int m_tBurst;   // Data transfer of a line
+        int m_tRRD;     // Activation to activation in a rank
+        int m_tFAW;     // Window of 4 activations in a rank
+        int m_tWR;      // End of write data to precharge
+        int m_tRTP;     // Read to precharge
+        int m_tREFI;    // Refresh interval (0 disables refresh)
+        int m_tRFC;     // Refresh cycle
+
+        SimulationMode m_mode;
+
+        std::vector<Channel> m_channels;
+        std::vector<Rank>    m_ranks;
+        std::vector<Bank>    m_banks;
+
+        // Statistics
+        std::vector<s64> m_numReads;
+        std::vector<s64> m_numWrites;
+        std::vector<s64> m_numRowHits;
+        std::vector<s64> m_numRowMisses;
+        std::vector<s64> m_numRowConflicts;
+        s64 m_numAccesses;
+        s64 m_numTotalRowHits;
+        s64 m_totalLatency;
+        double m_averageLatency;
+
+        void ParseAddressMapping();
+        Location Decode( u64 address ) const;
+
+        // The time of the first refresh after 'time'.
+        s64 GetNextRefreshTime( s64 time ) const;
+
+        // Delay 'time' to the end of a refresh if 'time' is in the refresh.
+        s64 AvoidRefresh( s64 time ) const;
+
+        // Find the first free slot of the data bus from 'time'.
+        s64 FindBusSlot( const Channel& channel, s64 time ) const;
+    };
+
+}; // namespace Onikiri
+
+#endif // SIM_MEMORY_DRAM_DRAM_CONTROLLER_H
+
@@ -0,0 +1,186 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+
+
+#ifndef SIM_MEMORY_MEM_ORDER_MANAGER_MEM_ACCESS_INDEX_H
+#define SIM_MEMORY_MEM_ORDER_MANAGER_MEM_ACCESS_INDEX_H
+
+#include "Types.h"
+
+namespace Onikiri 
+{
+    // An index of in-flight memory accesses keyed by word addresses.
+    // Each entry is registered to all the words that its access covers, and 
+    // the entries of each word are sorted by 'order' (ex. program order).
+    // This is used for searching a load/store queue without scanning all entries. 
+    // Find() returns candidates that share words with an access, and 
+    // callers must check actual address overlapping of the candidates.
+    template <typename ValueType>
+    class MemAccessIndex
+    {
+    public:
+        // The size of an indexed block is 1 << BLOCK_BITS bytes.
+        static const int BLOCK_BITS = 3;
+
+        struct Entry
+        {
+            u64 order;
+            ValueType value;
+        };
+        typedef std::vector<Entry> EntryList;
+
+        // Register 'value' accessing [addr, addr+size).
+        // 'order' must be unique in this index.
+        void Insert( u64 order, const ValueType& value, u64 addr, int size )
+        {
+            Entry entry = { order, value };
+            u64 last = GetLastBlock( addr, size );
+            for( u64 block = GetFirstBlock( addr ); ; ++block ){
+                EntryList& list = m_table[ block ];
+
+                // Entries are usually inserted in ascending order.
+                typename EntryList::iterator pos = list.end();
+                while( pos != list.begin() && order < ( pos - 1 )->order ){
+                    --pos;
+                }
+                list.insert( pos, entry );
+
+                if( block == last )
+                    break;
+            }
+        }
+
+        // Remove an entry registered with 'order', 'addr' and 'size'.
+        void Erase( u64 order, u64 addr, int size )
+        {
+            u64 last = GetLastBlock( addr, size );
+            for( u64 block = GetFirstBlock( addr ); ; ++block ){
+                typename TableType::iterator i = m_table.find( block );
+                if( i != m_table.end() ){
+                    EntryList& list = i->second;
+                    for( typename EntryList::iterator e = list.begin(); e != list.end(); ++e ){
+                        if( e->order == order ){
+                            list.erase( e );
+                            break;
+                        }
+                    }
+                    if( list.empty() ){
+                        m_table.erase( i );
+                    }
+                }
+
+                if( block == last )
+                    break;
+            }
+        }
+
+        // Get entries that may overlap [addr, addr+size) to 'result' in ascending order.
+        void Find( u64 addr, int size, EntryList* result ) const
+        {
+            result->clear();
+            u64 first = GetFirstBlock( addr );
+            u64 last  = GetLastBlock( addr, size );
+            for( u64 block = first; ; ++block ){
+                typename TableType::const_iterator i = m_table.find( block );
+                if( i != m_table.end() ){
+                    result->insert( result->end(), i->second.begin(), i->second.end() );
+                }
+
+                if( block == last )
+                    break;
+            }
+
+            // An entry over multiple blocks is found multiple times.
+            if( first != last ){
+                std::sort( result->begin(), result->end(), LessOrder() );
+                result->erase( 
+                    std::unique( result->begin(), result->end(), EqualOrder() ),
+                    result->end()
+                );
+            }
+        }
+
+        void Clear()
+        {
+            m_table.clear();
+        }
+
+    protected:
+        class BlockHash
+        {
+        public:
+            size_t operator()( const u64 block ) const
+            {
+                return (size_t)( block ^ ( block >> 16 ) );
+            }
+        };
+
+        struct LessOrder
+        {
+            bool operator()( const Entry& lhs, const Entry& rhs ) const
+            {
+                return lhs.order < rhs.order;
+            }
+        };
+
+        struct EqualOrder
+        {
+            bool operator()( const Entry& lhs, const Entry& rhs ) const
+            {
+                return lhs.order == rhs.order;
+            }
+        };
+
+        typedef pool_unordered_map< u64, EntryList, BlockHash > TableType;
+        TableType m_table;
+
+        static u64 GetFirstBlock( u64 addr )
+        {
+            return addr >> BLOCK_BITS;
+        }
+
+        // An access with size 0 is treated as 1 byte access, because
+        // MemOrderOperations::IsOverlapped() treats it as a point.
+        static u64 GetLastBlock( u64 addr, int size )
+        {
+            u64 end = addr + ( size > 1 ? size - 1 : 0 );
+            if( end < addr ){
+                end = ~(u64)0;
+            }
+            return end >> BLOCK_BITS;
+        }
+    };
+
+}; // namespace Onikiri
+
+#endif // SIM_MEMORY_MEM_ORDER_MANAGER_MEM_ACCESS_INDEX_H
+
@@ -75,7 +75,8 @@ MemOrderManager::MemOrderManager() :
     m_cache(0),
     m_cacheSystem(0),
     m_core(0),
-    m_emulator(0)
+    m_emulator(0),
+    m_allocationCount(0)
 {
 }
 
@@ -101,6 +102,7 @@ void MemOrderManager::Initialize( InitPhase phase )
         // Listなどの初期化
         m_loadList.resize(*m_core->GetOpArray());
         m_storeList.resize(*m_core->GetOpArray());
+        m_indexState.Resize(*m_core->GetOpArray());
         m_memOperations.SetTargetEndian( m_emulator->GetISAInfo()->IsLittleEndian() );
 
         int fetchWidth = GetCore()->GetFetcher()->GetFetchWidth();
@@ -228,6 +230,37 @@ void MemOrderManager::Allocate(OpIterator op)
     else{
         m_storeList.push_back( op );
     }
+
+    RemoveFromIndex( op );
+    m_indexState[op].order = m_allocationCount++;
+
+    // An op is indexed with its initial access, because the linear search 
+    // of the lists also checks ops that have not accessed memory yet.
+    UpdateIndex( op, op->GetMemAccess() );
+}
+
+void MemOrderManager::UpdateIndex( OpIterator op, const MemAccess& access )
+{
+    RemoveFromIndex( op );
+
+    IndexState& state = m_indexState[op];
+    OpAccessIndex& index = op->GetOpClass().IsLoad() ? m_loadIndex : m_storeIndex;
+    index.Insert( state.order, op, access.address.address, access.size );
+    state.indexed = true;
+    state.addr = access.address.address;
+    state.size = access.size;
+}
+
+void MemOrderManager::RemoveFromIndex( OpIterator op )
+{
+    IndexState& state = m_indexState[op];
+    if( !state.indexed ){
+        return;
+    }
+
+    OpAccessIndex& index = op->GetOpClass().IsLoad() ? m_loadIndex : m_storeIndex;
+    index.Erase( state.order, state.addr, state.size );
+    state.indexed = false;
 }
 
 // 実行終了
@@ -258,11 +291,12 @@ OpIterator MemOrderManager::GetProducerStore( OpIterator consumer, const MemAcce
 
     OpIterator producer = OpIterator(0);
 
-    OpList::const_iterator i = m_storeList.end();
-    while( i != m_storeList.begin() ) {
-        --i;
+    // Search candidates that may overlap 'access' from the back of the store list.
+    m_storeIndex.Find( access.address.address, access.size, &m_candidates );
 
-        OpIterator op = *i;
+    OpAccessIndex::EntryList::const_reverse_iterator i = m_candidates.rbegin();
+    for( ; i != m_candidates.rend(); ++i ){
+        OpIterator op = i->value;
 
         if( op->GetGlobalSerialID() > consumer->GetGlobalSerialID() ){
             continue;
@@ -279,7 +313,7 @@ OpIterator MemOrderManager::GetProducerStore( OpIterator consumer, const MemAcce
             producer = op;
             break;
         }
-    };
+    }
 
     return producer;
 }
@@ -291,10 +325,14 @@ OpIterator MemOrderManager::GetConsumerLoad( OpIterator producer, const MemAcces
 
     OpIterator consumer;
 
+    // Candidates are in program order.
+    m_loadIndex.Find( producerAccess.address.address, producerAccess.size, &m_candidates );
+
     int num = 0;
-    for( OpList::iterator i = m_loadList.begin(); i != m_loadList.end(); ++i ){
+    OpAccessIndex::EntryList::const_iterator i = m_candidates.begin();
+    for( ; i != m_candidates.end(); ++i ){
         
-        OpIterator op = *i;
+        OpIterator op = i->value;
         if( op->GetGlobalSerialID() < producer->GetGlobalSerialID() ){
             continue;
         }
@@ -386,6 +424,8 @@ void MemOrderManager::Delete( OpIterator op )
         return;
     }
 
+    RemoveFromIndex( op );
+
     const OpClass& opClass = op->GetOpClass();
     if( opClass.IsLoad() ) {
         m_loadList.erase(op);
@@ -442,11 +482,13 @@ void MemOrderManager::Read( OpIterator op, MemAccess* access )
         ReadMemImage( op, access );
     }
 
+    UpdateIndex( op, *access );
     op->SetMemAccess( *access );
 }
 
 void MemOrderManager::Write( OpIterator op, MemAccess* access )
 {
+    UpdateIndex( op, *access );
     op->SetMemAccess( *access );
 }
 
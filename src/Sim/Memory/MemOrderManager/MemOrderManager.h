@@ -41,6 +41,7 @@
 
 #include "Sim/Core/DataPredTypes.h"
 #include "Sim/Memory/MemOrderManager/MemOrderOperations.h"
+#include "Sim/Memory/MemOrderManager/MemAccessIndex.h"
 
 namespace Onikiri 
 {
@@ -170,6 +171,29 @@ namespace Onikiri
         // Operations related to detect address intersection.
         MemOrderOperations m_memOperations;
 
+        // Address indices of m_loadList/m_storeList.
+        // Entries are ordered by allocation order, which is the same as the order of the lists, 
+        // and GetProducerStore/GetConsumerLoad search only ops that may overlap an access.
+        typedef MemAccessIndex<OpIterator> OpAccessIndex;
+        struct IndexState
+        {
+            u64 order;      // Allocation order
+            bool indexed;
+            u64 addr;       // An address and a size that an op is indexed with.
+            int size;
+
+            IndexState() : order(0), indexed(false), addr(0), size(0) {}
+        };
+        OpAccessIndex m_loadIndex;
+        OpAccessIndex m_storeIndex;
+        OpExtraStateTable<IndexState> m_indexState;
+        u64 m_allocationCount;
+        mutable OpAccessIndex::EntryList m_candidates;  // A work area for searching.
+
+        // Register 'op' to an index with 'access', which will be set to 'op'.
+        void UpdateIndex( OpIterator op, const MemAccess& access );
+        void RemoveFromIndex( OpIterator op );
+
         // エミュレータが持つメモリイメージへの読み書き
         void ReadMemImage( OpIterator op, MemAccess* access );
         void WriteMemImage( OpIterator op, MemAccess* access );
@@ -257,6 +257,7 @@ void PrefetcherBase::Prefetch( const CacheAccess& access )
     CacheAccess prefetch = access;
     prefetch.type = CacheAccess::OT_PREFETCH;
     prefetch.address.address = MaskLineOffset( access.address.address );
+    prefetch.requester = NULL;
 
     
     AccessList::iterator current;
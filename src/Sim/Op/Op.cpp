@@ -54,27 +54,28 @@ using namespace std;
 using namespace Onikiri;
 
 
-Op::Op(OpIterator iterator) :
+Op::Op( OpIterator iterator, OpColdState* coldState ) :
+    m_srcNum     (0),
+    m_dstNum     (0),
+    m_scheduler  (0),
+    m_issueState (),
     m_opInfo     (0),
     m_opClass    (0),
-    m_no         (0),
-    m_localTID   (TID_INVALID),
     m_serialID   (0),
     m_globalSerialID     (0),
     m_retireID   (0),
+    m_latPredResult(),
+    m_no         (0),
+    m_localTID   (TID_INVALID),
     m_thread     (0),
     m_core       (0),
     m_inorderList(0),
     m_beforeCheckpoint (0), 
     m_afterCheckpoint (0), 
     m_taken      (false),
-    m_latPredResult(),
-    m_issueState (),
-    m_scheduler  (0),
     m_regFile    (0),
-    m_srcNum     (0),
-    m_dstNum     (0),
-    m_iterator   (iterator)
+    m_iterator   (iterator),
+    m_cold       (coldState)
 {
 }
 
@@ -105,13 +106,14 @@ void Op::Initialize(const OpInitArgs& args)
     m_reserveExecUnit = false;
     m_scheduler     = 0;
 
-    m_memAccess.address = Addr();
-    m_memAccess.size    = 0;
-    m_memAccess.sign    = false;
-    m_memAccess.value   = 0;
+    MemAccess* memAccess = &m_cold->memAccess;
+    memAccess->address = Addr();
+    memAccess->size    = 0;
+    memAccess->sign    = false;
+    memAccess->value   = 0;
 
-    m_exception = Exception();
-    m_cacheAccessResult = CacheAccessResult();
+    m_cold->exception = Exception();
+    m_cold->cacheAccessResult = CacheAccessResult();
 
     m_regFile = m_core->GetRegisterFile();
     m_srcNum = m_opInfo->GetSrcNum();
@@ -273,18 +275,18 @@ void Op::AddEvent(
 {
     timeWheel->AddEvent( evnt, time );
     if( !evnt->IsUpdated() ){
-        m_event.AddEvent( evnt, mask );
+        m_cold->event.AddEvent( evnt, mask );
     }
 }
 
 void Op::CancelEvent( EventMask mask )
 {
-    m_event.Cancel( mask );
+    m_cold->event.Cancel( mask );
 }
 
 void Op::ClearEvent()
 {
-    m_event.Clear();
+    m_cold->event.Clear();
 }
 
 
@@ -404,7 +406,7 @@ OpIterator Op::GetFirstConsumer()
     
     if( m_opClass->IsStore() ){
         MemOrderManager* memOrder = m_thread->GetMemOrderManager();
-        OpIterator consumer = memOrder->GetConsumerLoad( m_iterator, m_memAccess, 0 );
+        OpIterator consumer = memOrder->GetConsumerLoad( m_iterator, m_cold->memAccess, 0 );
         if( !consumer.IsNull() && 
             ( result.IsNull() ||
               result->GetSerialID() > consumer->GetSerialID() 
@@ -64,6 +64,24 @@ namespace Onikiri
     class ExecUnitIF;
     struct OpInitArgs;
 
+    // Rarely accessed state of an op.
+    // OpArray places these out of line of ops, so that 
+    // the hot fields of ops are packed into fewer cache lines.
+    struct OpColdState
+    {
+        // Memory access
+        MemAccess memAccess;
+
+        // Cache access result
+        CacheAccessResult cacheAccessResult;
+
+        // Exception
+        Exception exception;
+
+        // フラッシュされるときに消すイベント
+        EventList event;
+    };
+
     // 命令をあらわすクラス
     class Op :
         public OpStateIF,
@@ -80,7 +98,7 @@ namespace Onikiri
         static const int EVENT_MASK_ALL            = EventList::EVENT_MASK_ALL;
 
 
-        Op(OpIterator iterator);
+        Op( OpIterator iterator, OpColdState* coldState );
         virtual ~Op();
 
         // Initialize
@@ -95,6 +113,7 @@ namespace Onikiri
         virtual PC GetTakenPC() const;
         virtual void SetTaken(const bool taken);
         virtual bool GetTaken() const;
+        virtual s64 GetPipelineRetireID() const { return (s64)m_retireID; }
 
         // MemIF
         virtual void Read(  MemAccess* access );
@@ -191,16 +210,16 @@ namespace Onikiri
         void SetStatus( OpStatus status )   { m_status = status; }
         OpStatus GetStatus() const          { return m_status;   }
 
-        void SetMemAccess( const MemAccess& memAccess ) { m_memAccess = memAccess; }
-        const MemAccess& GetMemAccess() const           { return m_memAccess;      }
+        void SetMemAccess( const MemAccess& memAccess ) { m_cold->memAccess = memAccess; }
+        const MemAccess& GetMemAccess() const           { return m_cold->memAccess;      }
 
-        void SetException( const Exception& exception) { m_exception = exception; }
-        const Exception& GetException() const          { return m_exception;      }
+        void SetException( const Exception& exception) { m_cold->exception = exception; }
+        const Exception& GetException() const          { return m_cold->exception;      }
 
         void SetCacheAccessResult( const CacheAccessResult& cacheAccessResult )
-        { m_cacheAccessResult = cacheAccessResult;  }
+        { m_cold->cacheAccessResult = cacheAccessResult;  }
         const CacheAccessResult& GetCacheAccessResult() const             
-        { return m_cacheAccessResult;               }
+        { return m_cold->cacheAccessResult;               }
 
         void SetPredPC(const PC predPC) { m_predPC = predPC; }
         PC GetPredPC() const            { return m_predPC; }
@@ -232,18 +251,37 @@ namespace Onikiri
 
     protected:
 
-        // PC
-        PC m_pc;
+        //
+        // Fields accessed in scheduling, wakeup and retirement are 
+        // packed at the head of an op.
+        //
+
+        // 現在どういう状態なのか
+        OpStatus m_status;
+
+        // ソースとディスティネーション
+        int m_srcNum;
+        int m_dstNum;
+        PhyReg* m_dstPhyReg[SimISAInfo::MAX_DST_REG_COUNT];
+        PhyReg* m_srcPhyReg[SimISAInfo::MAX_SRC_REG_COUNT];
+
+        // 自分が今いるスケジューラ
+        Scheduler* m_scheduler;
+
+        // State of issuing
+        IssueState m_issueState;
+
+        // Whether reserving an execution unit or not.
+        bool m_reserveExecUnit;
+
         // PCに対応する命令の情報
         OpInfo*  m_opInfo;
         const OpClass* m_opClass;
 
-        // 同一PC内に複数のOpがあるときに、いくつ目かを特定する番号
-        // 上流側から順に 0 1 2 ...
-        int m_no;
-
-        // Local thread id in each core
-        int m_localTID;
+        // デスティネーションに割り当てられたメモリの依存関係のポインタ
+        MemDependencyPtr m_dstMem[MAX_DST_MEM_NUM];
+        // ソースに割り当てられたメモリの依存関係のポインタ
+        MemDependencyPtr m_srcMem[MAX_SRC_MEM_NUM];
 
         // フェッチされた順につく番号
         u64 m_serialID;
@@ -251,14 +289,28 @@ namespace Onikiri
         // リタイアした順につく番号
         u64 m_retireID;
 
+        // Result of latency prediction
+        LatPredResult m_latPredResult;
+
+        //
+        // Fields accessed in fetch, rename and execution.
+        //
+
+        // PC
+        PC m_pc;
+
+        // 同一PC内に複数のOpがあるときに、いくつ目かを特定する番号
+        // 上流側から順に 0 1 2 ...
+        int m_no;
+
+        // Local thread id in each core
+        int m_localTID;
+
         // フェッチされたコア/スレッド/InorderList
         Thread*     m_thread;
         Core*           m_core;
         InorderList*    m_inorderList;
 
-        // 現在どういう状態なのか
-        OpStatus m_status;
-
         // 自分が作ったチェックポイント
         Checkpoint* m_beforeCheckpoint;
         Checkpoint* m_afterCheckpoint;
@@ -268,15 +320,6 @@ namespace Onikiri
         // 分岐が taken かどうか
         bool m_taken;
 
-        // Memory access
-        MemAccess   m_memAccess;
-
-        // Cache access result
-        CacheAccessResult m_cacheAccessResult;
-
-        // Exception
-        Exception m_exception;
-
         // 予測したPC
         PC m_predPC;
 
@@ -285,38 +328,16 @@ namespace Onikiri
         // ソースに割り当てられた物理レジスタの番号
         int m_srcReg[SimISAInfo::MAX_SRC_REG_COUNT];
 
-        // デスティネーションに割り当てられたメモリの依存関係のポインタ
-        MemDependencyPtr m_dstMem[MAX_DST_MEM_NUM];
-        // ソースに割り当てられたメモリの依存関係のポインタ
-        MemDependencyPtr m_srcMem[MAX_SRC_MEM_NUM];
-
-        // Result of latency prediction
-        LatPredResult m_latPredResult;
-
-        // State of issuing
-        IssueState m_issueState;
-
-        // Whether reserving an execution unit or not.
-        bool m_reserveExecUnit;
-
-        // フラッシュされるときに消すイベント
-        EventList m_event;
-
-        // 自分が今いるスケジューラ
-        Scheduler* m_scheduler;
-
         // レジスタファイル
         RegisterFile* m_regFile;
 
-        // ソースとディスティネーション
-        int m_srcNum;
-        int m_dstNum;
-        PhyReg* m_dstPhyReg[SimISAInfo::MAX_DST_REG_COUNT];
-        PhyReg* m_srcPhyReg[SimISAInfo::MAX_SRC_REG_COUNT];
         u64     m_dstResultValue[SimISAInfo::MAX_DST_REG_COUNT];
 
         OpIterator m_iterator;
 
+        // Rarely accessed fields placed out of line in OpArray.
+        OpColdState* m_cold;
+
         PhyReg* GetPhyReg(int phyRegNo);
     };
 
@@ -38,34 +38,40 @@
 
 using namespace Onikiri;
 
-// --
-OpArray::ArrayID::~ArrayID()
-{
-    delete m_op;
-}
-
 // --
 OpArray::OpArray(int capacity) : 
+    m_ops(0),
+    m_coldStates(0),
     m_capacity(capacity)
 {
+    // ArrayID の作成(この時点ではOpがまだ作成されていないので0)
+    // 'm_body' must not be reallocated after this, because 
+    // OpIterators point its elements.
+    m_body.reserve(m_capacity);
+    for(int k = 0; k < m_capacity; ++k) {
+        m_body.push_back( ArrayID(0, this, k) );
+    }
+    m_coldStates = new OpColdState[m_capacity];
+
     // Op の確保
+    // Ops are constructed in one slab in the order of their IDs.
+    m_ops = static_cast<Op*>( ::operator new( sizeof(Op) * m_capacity ) );
     for(int k = 0; k < m_capacity; ++k) {
-        // ArrayID の作成(この時点ではOpがまだ作成されていないので0)
-        ArrayID* arrayID = new ArrayID(0, this, k);
         // arrayID を利用して op を作成
-        Op* op = new Op( OpIterator(arrayID) );
+        ArrayID* arrayID = &m_body[k];
+        Op* op = new( &m_ops[k] ) Op( OpIterator(arrayID), &m_coldStates[k] );
         // arrayID に op をセット
         arrayID->SetOp(op);
-            
-        m_body.push_back(arrayID);
     }
 
     // 使用中かどうかのフラグの初期化
     m_alive.resize(m_capacity, false);
     
     // free list の初期化
+    // IDs are pushed in reverse order, so that ops are created 
+    // from the head of the slab.
     m_freeList.reserve(m_capacity);
-    for(int k = 0; k < m_capacity; ++k) {
+    for(int k = m_capacity - 1; k >= 0; --k) {
         m_freeList.push_back(k);
     }
 }
@@ -73,8 +79,10 @@ OpArray::OpArray(int capacity) :
 OpArray::~OpArray()
 {
     for(int k = 0; k < m_capacity; ++k) {
-        delete m_body[k];
+        m_ops[k].~Op();
     }
+    ::operator delete( m_ops );
+    delete[] m_coldStates;
     m_body.clear();
 }
 
@@ -98,7 +106,7 @@ OpIterator OpArray::CreateOp()
     m_alive[id] = true;
 
     // id番目のオリジナルのOpIteratorを返す
-    return OpIterator(m_body[id]);
+    return OpIterator(&m_body[id]);
 }
 
 void OpArray::ReleaseOp(const OpIterator& opIterator)
@@ -40,6 +40,7 @@ namespace Onikiri
     // forward declaration
     class OpIterator;
     class Op;
+    struct OpColdState;
 
     class OpArray 
     {
@@ -71,8 +72,6 @@ namespace Onikiri
                 m_id(arrayID.m_id)
             {}
 
-            virtual ~ArrayID();
-
             // accessors
             Op* GetOp() const  { return m_op; }
             void SetOp(Op* op)
@@ -147,7 +146,11 @@ namespace Onikiri
     protected:
         // Op の pool 
         // IDの配列
-        std::vector<OpArray::ArrayID*> m_body;
+        // ArrayIDs, ops and the cold states of the ops are allocated in 
+        // contiguous slabs and are indexed by IDs.
+        std::vector<OpArray::ArrayID> m_body;
+        Op* m_ops;
+        OpColdState* m_coldStates;
 
         // 使用中かどうかのフラグ
         // Copy方向の配列
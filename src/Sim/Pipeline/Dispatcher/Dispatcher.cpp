@@ -155,7 +155,7 @@ void Dispatcher::Evaluate()
     for( int i = 0; i < m_numScheduler; i++ ){
         if( !m_schedInfo[i].scheduler->CanAllocate( dispatchingOps[i] ) ){
             stall = true;
-            m_schedInfo[i].saturateCount++;
+            IncrementCycleCounter( &m_schedInfo[i].saturateCount );
         }
     }
 
@@ -167,6 +167,16 @@ void Dispatcher::Evaluate()
     }
 }
 
+// Ops on the latch are checked by the latch itself.
+// Hooks for evaluation may change their states in every cycle.
+s64 Dispatcher::GetIdleCycles()
+{
+    if( s_dispatchEvaluateHook.IsAnyHookRegistered() ){
+        return 0;
+    }
+    return BaseType::GetIdleCycles();
+}
+
 void Dispatcher::Dispatch( OpIterator op )
 {   
     SchedulerInfo* schd = GetSchedulerInfo(op);
@@ -97,6 +97,7 @@ namespace Onikiri
         virtual void Evaluate();
         virtual void Update();
         virtual void ExitLowerPipeline( OpIterator op );
+        virtual s64  GetIdleCycles();
         
         virtual void Retire( OpIterator op );
         virtual void Flush( OpIterator op );
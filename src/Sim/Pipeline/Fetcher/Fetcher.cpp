@@ -82,6 +82,7 @@ Fetcher::Fetcher() :
     m_idealMode(false),
     m_checkLatencyMismatch(false),
     m_currentFetchThread(0),
+    m_fetchedThisCycle(false),
     m_bpred(0),
     m_cacheSystem(0),
     m_emulator(0),
@@ -193,7 +194,7 @@ bool Fetcher::CanFetch( Thread* thread, PC pc, OpInfo** infoArray, int numOp )
         // 直列化しないといけない命令がコア内にいたらストール
         // In serializing state.
         if( IsSerializingRequired( thread ) ){
-            ++m_stallCycles.currentSyscall;
+            IncrementCycleCounter( &m_stallCycles.currentSyscall );
             param.canFetch = false;
             return param.canFetch;
         }
@@ -231,13 +232,13 @@ bool Fetcher::CanFetch( Thread* thread, PC pc, OpInfo** infoArray, int numOp )
 
         // checkpointMaster のチェック
         if( !thread->GetCheckpointMaster()->CanCreate( numCheckpointReq ) ) {
-            ++m_stallCycles.checkpoint;
+            IncrementCycleCounter( &m_stallCycles.checkpoint );
             param.canFetch = false;
             return param.canFetch;
         }
 
         if( !thread->GetInorderList()->CanAllocate( numOp ) ){
-            ++m_stallCycles.inorderList;
+            IncrementCycleCounter( &m_stallCycles.inorderList );
             param.canFetch = false;
             return param.canFetch;
         }
@@ -251,7 +252,7 @@ bool Fetcher::CanFetch( Thread* thread, PC pc, OpInfo** infoArray, int numOp )
                 return param.canFetch;
             }
             else {
-                ++m_stallCycles.nextSyscall;
+                IncrementCycleCounter( &m_stallCycles.nextSyscall );
                 param.canFetch = false;
                 return param.canFetch;
             }
@@ -443,6 +444,7 @@ void Fetcher::Evaluate()
     }
 
     m_evaluated = updated;
+    m_fetchedThisCycle = false;
     BaseType::Evaluate();
 }
 
@@ -462,7 +464,7 @@ void Fetcher::Update()
         return;
     }
     if( m_evaluated.reqSerializing ){
-        ++m_stallCycles.currentSyscall;
+        IncrementCycleCounter( &m_stallCycles.currentSyscall );
         return;
     }
 
@@ -471,6 +473,7 @@ void Fetcher::Update()
     PC fetchGroupPC = fetchThread->GetFetchPC();
     if( fetchGroupPC != m_evaluated.fetchPC ){
         // Branch prediction miss recovery is done 
+        m_fetchedThisCycle = true;
         return;
     }
 
@@ -580,12 +583,28 @@ void Fetcher::Update()
     // 1個以上の命令をフェッチしたらフェッチグループ数を増やす
     if( numFetchedPC > 0 ){
         m_numFetchGroup++;
+        m_fetchedThisCycle = true;
     }
 
     m_numFetchedPC += numFetchedPC;
 }
 
 
+// The fetcher is idle if it does not fetch any ops.
+// Only a single thread core without hooks is supported, because a steerer
+// and hooks may change their states in every cycle.
+s64 Fetcher::GetIdleCycles()
+{
+    if( m_fetchedThisCycle ||
+        m_thread.GetSize() != 1 ||
+        s_fetchSteeringHook.IsAnyHookRegistered() ||
+        s_fetchDecisionHook.IsAnyHookRegistered()
+    ){
+        return 0;
+    }
+    return BaseType::GetIdleCycles();
+}
+
 // Decide a thread that fetches ops in this cycle.
 Thread* Fetcher::GetFetchThread( bool update )
 {
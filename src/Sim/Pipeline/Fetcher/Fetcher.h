@@ -155,6 +155,9 @@ namespace Onikiri
         virtual void Update();
         virtual void Commit(OpIterator op);
 
+        // ClockedResourceIF
+        virtual s64 GetIdleCycles();
+
         // 実行終了時に呼ばれる
         void Finished(OpIterator op);
 
@@ -210,6 +213,8 @@ namespace Onikiri
         bool m_checkLatencyMismatch;
         // 次にフェッチを行うスレッドのインデックス
         int m_currentFetchThread;
+        // Whether ops are fetched or a fetch PC is changed in this cycle.
+        bool m_fetchedThisCycle;
 
         // Updated content decided by Evaluate() in this cycle.
         struct Evaluated
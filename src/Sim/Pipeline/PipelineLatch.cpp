@@ -126,6 +126,16 @@ void PipelineLatch::Transition()
     }
 }
 
+s64 PipelineLatch::GetIdleCycles()
+{
+    if( m_latchIn.size() > 0 || 
+        ( m_latchOut.size() > 0 && !IsStalledFinishedCycle() ) 
+    ){
+        return 0;
+    }
+    return BaseType::GetIdleCycles();
+}
+
 // Stall handlers, which are called in stall begin/end
 void PipelineLatch::BeginStall()
 {
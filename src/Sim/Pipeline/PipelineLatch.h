@@ -85,6 +85,9 @@ namespace Onikiri
         // A cycle transition handler
         virtual void Transition();
 
+        // Ops on the latch are processed in a next cycle if it is not stalled.
+        virtual s64 GetIdleCycles();
+
         // Stall handlers, which are called in stall begin/end
         virtual void BeginStall();
         virtual void EndStall();
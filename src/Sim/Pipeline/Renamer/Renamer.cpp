@@ -226,19 +226,19 @@ bool Renamer::CanRename( RenamingOpArray* renamingOps )
     
     // regDepPred のチェック
     if( !m_regDepPred[localTID]->CanAllocate( renamingOps->data(), numOps ) ) {
-        ++m_stallCycles.regDepPred;
+        IncrementCycleCounter( &m_stallCycles.regDepPred );
         return false;
     }
 
     // memDepPred のチェック
     if( !m_memDepPred[localTID]->CanAllocate( renamingOps->data(), numOps ) ) {
-        ++m_stallCycles.memDepPred;
+        IncrementCycleCounter( &m_stallCycles.memDepPred );
         return false;
     }
 
     // memOrderManager のチェック
     if( !m_memOrderManager[localTID]->CanAllocate( renamingOps->data(), numOps ) ) {
-        ++m_stallCycles.memOrderManager;
+        IncrementCycleCounter( &m_stallCycles.memOrderManager );
         return false;
     }
 
@@ -293,6 +293,16 @@ void Renamer::Evaluate()
     } 
 }
 
+// Ops on the latch are checked by the latch itself.
+// Hooks for evaluation may change their states in every cycle.
+s64 Renamer::GetIdleCycles()
+{
+    if( s_renameEvaluateHook.IsAnyHookRegistered() ){
+        return 0;
+    }
+    return BaseType::GetIdleCycles();
+}
+
 // Dispatch all ops in the latch if a renamer is not stalled.
 void Renamer::Update()
 {
@@ -94,6 +94,7 @@ namespace Onikiri
 
         // --- ClockedResourceIF
         virtual void Evaluate();
+        virtual s64 GetIdleCycles();
 
         DispatchSteererIF* GetSteerer() const { return m_steerer; }
 
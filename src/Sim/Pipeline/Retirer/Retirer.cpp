@@ -99,6 +99,9 @@ void Retirer::Initialize( InitPhase phase )
     if( phase == INIT_PRE_CONNECTION ){
         SetPriority( RP_COMMIT );
         LoadParam();
+
+        g_dumper.RegisterStatCounter( this, "NumRetiredOps",   &m_numRetiredOps );
+        g_dumper.RegisterStatCounter( this, "NumRetiredInsns", &m_numRetiredInsns );
     }
     else if( phase == INIT_POST_CONNECTION ){
         DisableLatch();
@@ -192,6 +195,52 @@ void Retirer::Update()
     UpdateCommit();
 }
 
+// The retirer is idle while a head op cannot commit. Only a single thread 
+// core without hooks is supported, because a thread is selected in turn and
+// hooks may change their states in every cycle.
+s64 Retirer::GetIdleCycles()
+{
+    if( m_thread.GetSize() != 1 ||
+        !m_thread[0]->IsActive() ||
+        s_commitSteeringHook.IsAnyHookRegistered() ||
+        s_commitDecisionHook.IsAnyHookRegistered() ||
+        m_evaluated.committing.size() > 0 ||
+        m_evaluated.exceptionOccur
+    ){
+        return 0;
+    }
+
+    // The head op must be decided not to commit before 
+    // reserving a store port in CanCommitOp().
+    InorderList* inorderList = m_thread[0]->GetInorderList();
+    OpIterator headOp = inorderList->GetFrontOp();
+    if( !headOp.IsNull() ){
+        OpIterator frontOp = inorderList->GetFrontOpOfSamePC( headOp );
+        if( headOp->GetException().exception ||
+            frontOp.IsNull() ||
+            frontOp->GetStatus() >= m_committableStatus
+        ){
+            return 0;
+        }
+    }
+
+    s64 cycles = BaseType::GetIdleCycles();
+    if( !IsStalledFinishedCycle() ){
+        // CheckCommitCounters() must detect the limit in the same cycle.
+        cycles = std::min( cycles, (s64)( m_noCommitLimit - m_noCommittedCycle ) );
+    }
+    return std::max( cycles, (s64)0 );
+}
+
+void Retirer::SkipIdleCycles( s64 cycles )
+{
+    // 'm_noCommittedCycle' is incremented in UpdateCommit().
+    if( !IsStalledFinishedCycle() ){
+        m_noCommittedCycle += (int)cycles;
+    }
+    BaseType::SkipIdleCycles( cycles );
+}
+
 // Set the number of retired ops/insns.
 // This is called when a simulation mode is changed from an emulation mode.
 void Retirer::SetInitialNumRetiredOp( s64 numInsns, s64 numOp, s64 simulationEndInsns )
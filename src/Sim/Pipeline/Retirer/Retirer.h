@@ -111,6 +111,10 @@ namespace Onikiri
         virtual void Transition();
         virtual void Update();
 
+        // ClockedResourceIF
+        virtual s64  GetIdleCycles();
+        virtual void SkipIdleCycles( s64 cycles );
+
         // accessors
         bool IsEndOfProgram()       const { return m_endOfProgram;      }
         s64 GetNumRetiredOp()       const { return m_numRetiredOps;     }
@@ -55,6 +55,10 @@ void AgeIssueSelector::Finalize()
     ReleaseParam();
 }
 
+// The ready ops in a scheduler are kept in age order (OpList::push_inorder),
+// so only the woke up ops in this cycle are sorted and merged with them.
+// This finishes when 'issueWidth' ops are selected, and does not look at
+// the other ready ops.
 void AgeIssueSelector::EvaluateSelect( Scheduler* scheduler )
 {
     // Select issued ops.
@@ -64,19 +68,36 @@ void AgeIssueSelector::EvaluateSelect( Scheduler* scheduler )
     const OpList& readyOps = scheduler->GetReadyOps();
     const SchedulingOps& wokeUpOps = scheduler->GetWokeUpOps();
 
-    pool_vector< OpIterator > readyAndWokeUpOps;
-    for( auto op : readyOps ) {
-        readyAndWokeUpOps.push_back( op );
-    }
-    for( auto op : wokeUpOps ) {
-        readyAndWokeUpOps.push_back( op );
+    m_sortedWokeUpOps.assign( wokeUpOps.begin(), wokeUpOps.end() );
+    if( m_sortedWokeUpOps.size() > 1 ){
+        std::sort( m_sortedWokeUpOps.begin(), m_sortedWokeUpOps.end(),
+            []( OpIterator lhs, OpIterator rhs ) { return lhs->GetGlobalSerialID() < rhs->GetGlobalSerialID(); }
+        );
     }
 
-    std::sort( readyAndWokeUpOps.begin(), readyAndWokeUpOps.end(),
-        []( OpIterator lhs, OpIterator rhs ) { return lhs->GetGlobalSerialID() < rhs->GetGlobalSerialID(); }
-    );
+    OpList::const_iterator ready = readyOps.begin();
+    OpList::const_iterator readyEnd = readyOps.end();
+    size_t wokeUp = 0;
+    size_t wokeUpEnd = m_sortedWokeUpOps.size();
+
+    while( true ) {
+        // Pick the older one of the heads of the two lists.
+        OpIterator op;
+        if( ready != readyEnd && 
+            ( wokeUp == wokeUpEnd || 
+              (*ready)->GetGlobalSerialID() < m_sortedWokeUpOps[ wokeUp ]->GetGlobalSerialID() )
+        ){
+            op = *ready;
+            ++ready;
+        }
+        else if( wokeUp != wokeUpEnd ){
+            op = m_sortedWokeUpOps[ wokeUp ];
+            ++wokeUp;
+        }
+        else{
+            break;
+        }
 
-    for( auto op : readyAndWokeUpOps ) {
         if( scheduler->CanSelect( op ) ) {
             scheduler->ReserveSelect( op );
             ++issueCount;
@@ -88,4 +109,6 @@ void AgeIssueSelector::EvaluateSelect( Scheduler* scheduler )
             g_dumper.Dump( DS_WAITING_UNIT, op );
         }
     }
+
+    m_sortedWokeUpOps.clear();
 }
@@ -61,7 +61,11 @@ namespace Onikiri
         END_PARAM_MAP()
         BEGIN_RESOURCE_MAP()
         END_RESOURCE_MAP()
-        
+
+    protected:
+        // Woke up ops sorted in age order.
+        // This is a member for reusing its buffer in each cycle.
+        std::vector< OpIterator > m_sortedWokeUpOps;
     };
 }
 
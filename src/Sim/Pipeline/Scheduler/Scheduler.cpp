@@ -255,6 +255,31 @@ void Scheduler::Update()
     }
 }
 
+// The scheduler is idle if there are no ready ops and no ops are woke up 
+// or selected in a last cycle. Not ready ops are woke up only by events.
+s64 Scheduler::GetIdleCycles()
+{
+    if( m_readyOp.size() > 0 ||
+        m_evaluated.deps.size() > 0 ||
+        m_evaluated.wokeUp.size() > 0 ||
+        m_evaluated.selected.size() > 0 
+    ){
+        return 0;
+    }
+    return BaseType::GetIdleCycles();
+}
+
+void Scheduler::SkipIdleCycles( s64 cycles )
+{
+    // Reservation wheels of execution units proceed in Update().
+    if( !IsStalledFinishedCycle() ){
+        typedef std::vector<ExecUnitIF*>::iterator iterator;
+        for( iterator i = m_execUnit.begin(); i != m_execUnit.end(); ++i ){
+            (*i)->SkipIdleCycles( cycles );
+        }
+    }
+    BaseType::SkipIdleCycles( cycles );
+}
 
 void Scheduler::Commit( OpIterator op )
 {
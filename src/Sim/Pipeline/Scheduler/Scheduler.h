@@ -113,6 +113,8 @@ namespace Onikiri
         virtual void Evaluate();
         virtual void Transition();
         virtual void Update();
+        virtual s64  GetIdleCycles();
+        virtual void SkipIdleCycles( s64 cycles );
 
         virtual void Commit( OpIterator op );
         virtual void Cancel( OpIterator op );
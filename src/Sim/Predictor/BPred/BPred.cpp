@@ -262,6 +262,40 @@ void BPred::Commit( OpIterator op )
 
 }
 
+// Train the predictors with a branch outcome resolved outside of the pipeline.
+void BPred::Warmup( int localTID, const PC& pc, const OpClass& opClass, bool taken, const PC& takenPC )
+{
+    if( m_perfect || !opClass.IsBranch() ){
+        return;
+    }
+
+    // The tables are updated in the same way as Predict() and Commit().
+    BTBPredict btbPred = m_btb->Predict( pc );
+    if( btbPred.hit ){
+        switch( btbPred.type ){
+        case BT_CALL:
+            m_ras[localTID]->Push( pc );
+            break;
+        case BT_RETURN:
+            m_ras[localTID]->Pop();
+            break;
+        case BT_CONDITIONAL_RETURN:
+            if( taken ){
+                m_ras[localTID]->Pop();
+            }
+            break;
+        default:
+            break;
+        }
+
+        if( btbPred.dirPredict && opClass.IsConditionalBranch() ){
+            m_dirPred->Warmup( localTID, pc, taken );
+        }
+    }
+
+    m_btb->Update( opClass, taken, takenPC, btbPred );
+}
+
 // Detect branch miss prediction and recovery if prediction is incorrect.
 void BPred::RecoveryFromBPredMiss( OpIterator branch )
 {
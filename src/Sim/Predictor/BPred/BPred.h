@@ -87,6 +87,10 @@ namespace Onikiri
         void Finished( OpIterator op );
         void Commit( OpIterator op );
 
+        // Train the BTB, RAS and direction predictor with a branch executed 
+        // outside of the pipeline, without ops (functional warming).
+        void Warmup( int localTID, const PC& pc, const OpClass& opClass, bool taken, const PC& takenPC );
+
         // Is in a perfect prediction mode or not.
         bool IsPerfect() const { return m_perfect; }
 
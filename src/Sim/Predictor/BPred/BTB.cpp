@@ -92,11 +92,14 @@ BTBPredict BTB::Predict(const PC& pc)
 // update BTB
 void BTB::Update(const OpIterator& op, const BTBPredict& predict)
 {
-    if(!op->GetTaken())
-        return;
+    Update( op->GetOpClass(), op->GetTaken(), op->GetTakenPC(), predict );
+}
 
+void BTB::Update(const OpClass& opClass, bool taken, const PC& takenPC, const BTBPredict& predict)
+{
+    if(!taken)
+        return;
 
-    const OpClass& opClass = op->GetOpClass();
     bool conditinal = opClass.IsConditionalBranch();
     BranchTypeUtility util;
 
@@ -104,7 +107,7 @@ void BTB::Update(const OpIterator& op, const BTBPredict& predict)
     BTBPredict result;
     result.predIndexPC = predict.predIndexPC;
     result.hit         = true;
-    result.target      = op->GetTakenPC();
+    result.target      = takenPC;
     result.dirPredict  = conditinal;
     result.type        = util.OpClassToBranchType( opClass );
 
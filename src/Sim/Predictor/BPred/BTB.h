@@ -59,7 +59,13 @@ namespace Onikiri
     private:
         static const int WORD_BITS = SimISAInfo::INSTRUCTION_WORD_BYTE_SHIFT;
         typedef shttl::static_off_hasher<u64, WORD_BITS> HasherType;
-        typedef shttl::setassoc_table< std::pair<u64, BTBPredict>, HasherType> SetAssocTableType;
+        typedef std::pair<u64, BTBPredict> PairType;
+        typedef shttl::setassoc_table< 
+            PairType, 
+            HasherType, 
+            shttl::lru<u64>,
+            shttl::setassoc_table_strage_soa< shttl::setassoc_table_line_base< PairType > >
+        > SetAssocTableType;
         SetAssocTableType* m_table;
 
         int m_numEntryBits;
@@ -109,6 +115,7 @@ namespace Onikiri
 
         // BTBをupdateする
         void Update(const OpIterator& op, const BTBPredict& predict);
+        void Update(const OpClass& opClass, bool taken, const PC& takenPC, const BTBPredict& predict);
     };
 
 }; // namespace Onikiri
@@ -53,6 +53,11 @@ namespace Onikiri {
 
         // リタイア
         virtual void Retired(OpIterator opIterator) = 0;
+
+        // Train the predictor with a branch outcome that is resolved 
+        // outside of the pipeline (functional warming in a skip phase).
+        // Predictors that do not support warming do nothing.
+        virtual void Warmup(int localTID, const PC& predIndexPC, bool taken) {}
     };
 
 }; // namespace Onikiri
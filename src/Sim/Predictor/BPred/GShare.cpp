@@ -69,6 +69,10 @@ void GShare::Initialize(InitPhase phase)
 {
     if(phase == INIT_PRE_CONNECTION){
         LoadParam(); // m_jBitSize, m_kBitSizeの初期化
+
+        g_dumper.RegisterStatCounter( this, "NumPred", &m_numPred );
+        g_dumper.RegisterStatCounter( this, "NumHit",  &m_numHit );
+        g_dumper.RegisterStatCounter( this, "NumMiss", &m_numMiss );
     }
     else if(phase == INIT_POST_CONNECTION){
         // メンバ変数が正しく初期化されているかのチェック
@@ -151,6 +155,13 @@ void GShare::Retired(OpIterator op)
     ++m_numRetire;
 }
 
+void GShare::Warmup(int localTID, const PC& predIndexPC, bool taken)
+{
+    int phtIndex = GetPHTIndex( localTID, predIndexPC );
+    m_pht->Update( phtIndex, taken );
+    m_globalHistory[localTID]->Predicted( taken );
+}
+
 // PCに対応するPHTのインデックスを返す
 int GShare::GetPHTIndex(int localThreadID, const PC& pc)
 {
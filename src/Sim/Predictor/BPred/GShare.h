@@ -125,6 +125,9 @@ namespace Onikiri
         // opのretire時の動作
         void Retired(OpIterator op);
 
+        // Update the PHT and the global history with a resolved branch direction.
+        void Warmup(int localTID, const PC& predIndexPC, bool taken);
+
         // PCに対応するPHTのインデックスを返す
         int GetPHTIndex(int localThreadID, const PC& pc);
 
@@ -106,7 +106,7 @@ void RMT::Initialize(InitPhase phase)
             logicalRegNum[segment]++;
 
             // 論理レジスタ→物理レジスタの割り当て
-            (*m_allocationTable)[i] = phyRegNo;
+            m_allocationTable.Set( i, phyRegNo );
 
             // レジスタの状態の初期化
             // ここで初期化されなかったものはallocateされる時に初期化される
@@ -143,7 +143,7 @@ int RMT::PeekReg(int lno) const
         "illegal register No.: %d\n", lno
     );
 
-    return ( m_allocationTable.GetCurrent() )[lno];
+    return m_allocationTable[lno];
 }
 
 
@@ -205,10 +205,10 @@ void RMT::AllocateRegBody( HookParam* param )
 
     // regがcommit時に解放する物理レジスタをm_releaseTableに登録
     // それまでregの論理レジスタに割り当てられていた物理レジスタを解放する
-    m_releaseTable[ phyRegNo ] = ( m_allocationTable.GetCurrent() )[ lno ];
+    m_releaseTable[ phyRegNo ] = m_allocationTable[ lno ];
 
     // <論理レジスタ、物理レジスタ>のマッピングテーブルを更新
-    ( m_allocationTable.GetCurrent() )[ lno ] = phyRegNo;
+    m_allocationTable.Set( lno, phyRegNo );
 
     param->physicalRegNum = phyRegNo;
 }
@@ -32,7 +32,7 @@
 #ifndef __RMT_H__
 #define __RMT_H__
 
-#include "Sim/Foundation/Checkpoint/CheckpointedData.h"
+#include "Sim/Foundation/Checkpoint/CheckpointedArray.h"
 #include "Interface/EmulatorIF.h"
 #include "Sim/Dependency/PhyReg/PhyReg.h"
 #include "Sim/Register/RegisterFile.h"
@@ -73,9 +73,9 @@ namespace Onikiri
         RegisterFreeList* m_regFreeList;
 
         // 論理レジスタ番号をキーとした、物理レジスタのマッピングテーブル
-        CheckpointedData<
-            boost::array< int, SimISAInfo::MAX_REG_COUNT >
-        > m_allocationTable;
+        // Only updated entries are journaled for checkpoints, because 
+        // copying the whole table for each checkpoint is expensive.
+        CheckpointedArray< int, SimISAInfo::MAX_REG_COUNT > m_allocationTable;
 
         // opのデスティネーション・レジスタのコミット時に解放される物理レジスタのマッピングテーブル
         // opのデスティネーション・レジスタの物理レジスタ番号をキーとする
@@ -44,6 +44,7 @@
 #include "Sim/Memory/MemOrderManager/MemOrderManager.h"
 #include "Sim/Pipeline/Scheduler/Scheduler.h"
 #include "Sim/Pipeline/Fetcher/Fetcher.h"
+#include "Sim/Dumper/Dumper.h"
 
 
 using namespace Onikiri;
@@ -78,6 +79,12 @@ void Recoverer::Initialize( InitPhase phase )
 {
     if( phase == INIT_PRE_CONNECTION ){
         LoadParam();
+
+        g_dumper.RegisterStatCounter( this, "BranchPredRecovery.NumRecovery", &m_brPredRecoveryCount );
+        g_dumper.RegisterStatCounter( this, "BranchPredRecovery.NumOps",      &m_brPredRecoveryOps );
+        g_dumper.RegisterStatCounter( this, "LatPredRecovery.NumRecovery",    &m_latPredRecoveryCount );
+        g_dumper.RegisterStatCounter( this, "LatPredRecovery.NumOps",         &m_latPredRecoveryOps );
+        g_dumper.RegisterStatCounter( this, "ExceptionRecovery.NumRecovery",  &m_exceptionRecoveryCount );
     }
     else if( phase == INIT_POST_CONNECTION ){
 
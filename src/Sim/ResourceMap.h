@@ -53,6 +53,7 @@
 #include "Sim/Memory/Prefetcher/PrefetcherBase.h"
 #include "Sim/Memory/Prefetcher/StreamPrefetcher.h"
 #include "Sim/Memory/Prefetcher/StridePrefetcher.h"
+#include "Sim/Memory/DRAM/DRAMController.h"
 
 #include "Sim/ExecUnit/ExecUnit.h"
 #include "Sim/ExecUnit/PipelinedExecUnit.h"
@@ -135,6 +136,7 @@ BEGIN_RESOURCE_TYPE_MAP()
     RESOURCE_INTERFACE_ENTRY(PrefetcherIF)
     RESOURCE_TYPE_ENTRY(StreamPrefetcher)
     RESOURCE_TYPE_ENTRY(StridePrefetcher)
+    RESOURCE_TYPE_ENTRY(DRAMController)
 
     RESOURCE_TYPE_ENTRY(ExecUnit)
     RESOURCE_TYPE_ENTRY(PipelinedExecUnit)
@@ -66,7 +66,8 @@ void EmulationSystem::Run()
                 executeInsns,
                 &archStateList[pid].registerValue[0],
                 &insnCount, 
-                NULL
+                NULL,
+                GetSkipObserver()
             );
         totalInsnCount.push_back( insnCount );
     }
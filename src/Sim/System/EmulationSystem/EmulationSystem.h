@@ -43,6 +43,10 @@ namespace Onikiri
         EmulationSystem();
         void Run();
         void Terminate();
+
+    protected:
+        // An observer passed to EmulatorIF::Skip().
+        virtual SkipObserverIF* GetSkipObserver() { return NULL; }
     };
 }; // namespace Onikiri
 
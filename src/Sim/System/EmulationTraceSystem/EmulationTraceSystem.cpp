@@ -40,19 +40,111 @@ using namespace boost;
 using namespace Onikiri;
 
 
+EmulationTraceSystem::EmulationTraceSystem()
+{
+    m_traceContext = NULL;
+}
+
 void EmulationTraceSystem::Run()
 {
     SystemContext* context = GetSystemContext();
     if (!context) {
         THROW_RUNTIME_ERROR("System context is not set");
     }
+
+    const String& format = context->traceParam.format;
+    if( format == "Binary" ){
+        RunBinary();
+    }
+    else if( format == "Text" ){
+        RunText();
+    }
+    else{
+        THROW_RUNTIME_ERROR( 
+            "An unknown trace format '%s' is specified. "
+            "'/Session/Simulator/System/EmulationTrace/@Format' must be 'Binary' or 'Text'.",
+            format.c_str()
+        );
+    }
+}
+
+void EmulationTraceSystem::RunBinary()
+{
+    SystemContext* context = GetSystemContext();
+    int processCount = context->emulator->GetProcessCount();
+    ArchitectureStateList& archStateList = context->architectureStateList;
+
+    m_traceContext = context;
+    m_writers.clear();
+    for( int pid = 0; pid < processCount; pid++ ){
+        OpTraceHeader header;
+        header.targetArchitecture = context->targetArchitecture;
+        header.pid = pid;
+        header.blockInsns = context->traceParam.blockInsns;
+        header.initialRegisterValue = archStateList[pid].registerValue;
+
+        String fileName = 
+            g_env.GetHostWorkPath() + context->traceParam.fileName + "." + lexical_cast<String>(pid) + ".trace";
+        boost::shared_ptr<OpTraceWriter> writer( new OpTraceWriter() );
+        writer->Open( fileName, header );
+        m_writers.push_back( writer );
+    }
+
+    EmulationSystem::Run();
+
+    for( int pid = 0; pid < processCount; pid++ ){
+        m_writers[pid]->Close();
+    }
+    m_writers.clear();
+}
+
+void EmulationTraceSystem::OnSkippedOp(
+    const PC& pc,
+    OpInfo* opInfo,
+    bool taken,
+    const PC& takenPC,
+    const MemAccess* memAccess
+){
+    // Skip() has already written the results of this op to the register array.
+    const vector<u64>& regs = m_traceContext->architectureStateList[ pc.pid ].registerValue;
+
+    OpTraceRecord record;
+    record.pc = pc;
+    record.microOpIndex = opInfo->GetMicroOpIndex();
+    record.microOpNum   = opInfo->GetMicroOpNum();
+    record.opClassCode  = opInfo->GetOpClass().GetCode();
+
+    record.srcNum = opInfo->GetSrcNum();
+    for( int i = 0; i < record.srcNum; i++ ){
+        record.srcOperand[i] = opInfo->GetSrcOperand(i);
+    }
+    record.dstNum = opInfo->GetDstNum();
+    for( int i = 0; i < record.dstNum; i++ ){
+        int dst = opInfo->GetDstOperand(i);
+        record.dstOperand[i] = dst;
+        record.dstValue[i] = dst >= 0 ? regs[dst] : 0;
+    }
+
+    record.taken   = taken;
+    record.takenPC = takenPC;
+    if( memAccess ){
+        record.memAccessed = true;
+        record.memAccess   = *memAccess;
+    }
+
+    m_writers[ pc.pid ]->Write( record );
+}
+
+void EmulationTraceSystem::RunText()
+{
+    SystemContext* context = GetSystemContext();
     int processCount = context->emulator->GetProcessCount();
 
     vector<ofstream*> ofsList;
     ofsList.resize( processCount );
     for( int pid = 0; pid < processCount; pid++ ){
         String fileName = 
-            g_env.GetHostWorkPath() + "./emulator." + lexical_cast<String>(pid) + ".log";
+            g_env.GetHostWorkPath() + context->traceParam.fileName + "." + lexical_cast<String>(pid) + ".log";
         ofsList[pid] = new ofstream( fileName );
     }
 
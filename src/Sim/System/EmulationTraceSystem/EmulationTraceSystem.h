@@ -32,17 +32,42 @@
 #ifndef __EMULATION_TRACE_SYSTEM_H__
 #define __EMULATION_TRACE_SYSTEM_H__
 
-#include "Sim/System/SystemBase.h"
+#include "Sim/System/EmulationSystem/EmulationSystem.h"
+#include "Sim/System/EmulationTraceSystem/OpTrace.h"
 
 
 namespace Onikiri 
 {
 
     // A system that generates an emulation log.
-    class EmulationTraceSystem : public SystemBase
+    // In the 'Binary' format, ops are executed by EmulatorIF::Skip() and 
+    // written to an op trace of each process (see OpTrace.h).
+    // In the 'Text' format, a text line is written for each op.
+    class EmulationTraceSystem : 
+        public EmulationSystem,
+        public SkipObserverIF
     {
     public:
+        EmulationTraceSystem();
         void Run();
+
+        // SkipObserverIF
+        virtual void OnSkippedOp(
+            const PC& pc,
+            OpInfo* opInfo,
+            bool taken,
+            const PC& takenPC,
+            const MemAccess* memAccess
+        );
+
+    protected:
+        virtual SkipObserverIF* GetSkipObserver() { return this; }
+
+        void RunBinary();
+        void RunText();
+
+        SystemContext* m_traceContext;
+        std::vector< boost::shared_ptr<OpTraceWriter> > m_writers;
     };
     
 }; // namespace Onikiri
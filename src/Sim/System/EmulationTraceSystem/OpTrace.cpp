@@ -0,0 +1,576 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+
+
+#include <pch.h>
+
+#include "Sim/System/EmulationTraceSystem/OpTrace.h"
+
+using namespace std;
+using namespace Onikiri;
+
+// Format version
+static const char OP_TRACE_SIGNATURE[] = "OnikiriOpTrace";
+static const u32  OP_TRACE_VERSION = 1;
+
+// Flags of a record
+static const int RECORD_TAKEN           = 1 << 0;
+static const int RECORD_MEM_ACCESSED    = 1 << 1;
+static const int RECORD_MEM_SIGN        = 1 << 2;
+static const int RECORD_PC_JUMPED       = 1 << 3;   // A PC is not the next PC of the previous op.
+static const int RECORD_MEM_FAILED      = 1 << 4;   // A memory access result is not MAR_SUCCESS.
+
+//
+// Variable length integers
+//
+static void PutVarint( vector<u8>* buf, u64 value )
+{
+    while( value >= 0x80 ){
+        buf->push_back( (u8)( value | 0x80 ) );
+        value >>= 7;
+    }
+    buf->push_back( (u8)value );
+}
+
+static void PutSignedVarint( vector<u8>* buf, s64 value )
+{
+    // Zigzag encoding
+    PutVarint( buf, ( (u64)value << 1 ) ^ (u64)( value >> 63 ) );
+}
+
+static u64 GetVarint( const vector<u8>& buf, size_t* pos )
+{
+    u64 value = 0;
+    for( int shift = 0; shift < 64; shift += 7 ){
+        if( *pos >= buf.size() ){
+            THROW_RUNTIME_ERROR( "An op trace block is broken." );
+        }
+        u8 byte = buf[ (*pos)++ ];
+        value |= (u64)( byte & 0x7f ) << shift;
+        if( !( byte & 0x80 ) ){
+            return value;
+        }
+    }
+    THROW_RUNTIME_ERROR( "An op trace block is broken." );
+    return 0;
+}
+
+static s64 GetSignedVarint( const vector<u8>& buf, size_t* pos )
+{
+    u64 value = GetVarint( buf, pos );
+    return (s64)( value >> 1 ) ^ -(s64)( value & 1 );
+}
+
+// The PC of the op following 'record'.
+static u64 GetNextPC( const OpTraceRecord& record )
+{
+    if( record.microOpIndex < record.microOpNum - 1 ){
+        return record.pc.address;
+    }
+    return record.taken ? 
+        record.takenPC.address : record.pc.address + SimISAInfo::INSTRUCTION_WORD_BYTE_SIZE;
+}
+
+//
+// Fixed size values in the header, the index and the footer.
+// These are written in the host byte order like checkpoints.
+//
+template <typename T>
+static void WriteValue( ofstream& file, const T& value )
+{
+    file.write( reinterpret_cast<const char*>( &value ), sizeof(T) );
+}
+
+template <typename T>
+static T ReadValue( ifstream& file, const String& fileName )
+{
+    T value;
+    file.read( reinterpret_cast<char*>( &value ), sizeof(T) );
+    if( !file ){
+        THROW_RUNTIME_ERROR( "The op trace '%s' is broken or truncated.", fileName.c_str() );
+    }
+    return value;
+}
+
+OpTraceRecord::OpTraceRecord() :
+    microOpIndex( 0 ),
+    microOpNum( 1 ),
+    opClassCode( OpClassCode::UNDEF ),
+    srcNum( 0 ),
+    dstNum( 0 ),
+    taken( false ),
+    memAccessed( false )
+{
+    for( int i = 0; i < SimISAInfo::MAX_SRC_REG_COUNT; i++ ){
+        srcOperand[i] = -1;
+        srcValue[i] = 0;
+    }
+    for( int i = 0; i < SimISAInfo::MAX_DST_REG_COUNT; i++ ){
+        dstOperand[i] = -1;
+        dstValue[i] = 0;
+    }
+}
+
+//
+// --- Writer
+//
+OpTraceWriter::OpTraceWriter() :
+    m_blockInsns( 0 ),
+    m_blockInsnCount( 0 ),
+    m_insnCount( 0 ),
+    m_opCount( 0 ),
+    m_nextPC( 0 ),
+    m_prevMemAddress( 0 )
+{
+}
+
+OpTraceWriter::~OpTraceWriter()
+{
+    // Close() must be called explicitly, because it may throw an exception.
+}
+
+void OpTraceWriter::Open( const String& fileName, const OpTraceHeader& header )
+{
+    if( header.blockInsns <= 0 ){
+        THROW_RUNTIME_ERROR( "The number of the instructions in an op trace block must be positive." );
+    }
+
+    m_fileName = fileName;
+    m_file.open( fileName.c_str(), ios::out | ios::binary | ios::trunc );
+    if( !m_file.is_open() ){
+        THROW_RUNTIME_ERROR( "Could not open '%s'.", fileName.c_str() );
+    }
+
+    m_blockInsns = header.blockInsns;
+    m_registerValue = header.initialRegisterValue;
+    m_index.clear();
+    m_insnCount = 0;
+    m_opCount   = 0;
+
+    m_file.write( OP_TRACE_SIGNATURE, sizeof(OP_TRACE_SIGNATURE) );
+    WriteValue( m_file, OP_TRACE_VERSION );
+    WriteValue( m_file, (u32)header.targetArchitecture.size() );
+    m_file.write( header.targetArchitecture.data(), header.targetArchitecture.size() );
+    WriteValue( m_file, (s32)header.pid );
+    WriteValue( m_file, (s32)header.blockInsns );
+    WriteValue( m_file, (u32)m_registerValue.size() );
+    if( !m_registerValue.empty() ){
+        m_file.write( 
+            reinterpret_cast<const char*>( &m_registerValue[0] ), 
+            sizeof(u64) * m_registerValue.size() 
+        );
+    }
+
+    BeginBlock();
+}
+
+// A block starts with a snapshot of the registers, so it can be decoded independently.
+void OpTraceWriter::BeginBlock()
+{
+    m_block.clear();
+    m_blockInsnCount = 0;
+    m_nextPC = 0;
+    m_prevMemAddress = 0;
+
+    IndexEntry entry;
+    entry.offset    = 0;    // Set on flushing
+    entry.firstInsn = m_insnCount;
+    entry.firstOp   = m_opCount;
+    m_index.push_back( entry );
+
+    for( size_t i = 0; i < m_registerValue.size(); i++ ){
+        PutVarint( &m_block, m_registerValue[i] );
+    }
+}
+
+void OpTraceWriter::FlushBlock()
+{
+    string compressed;
+    {
+        boost::iostreams::filtering_ostream stream;
+        stream.push( boost::iostreams::zlib_compressor() );
+        stream.push( boost::iostreams::back_inserter( compressed ) );
+        stream.write( reinterpret_cast<const char*>( &m_block[0] ), m_block.size() );
+        stream.reset();
+    }
+
+    m_index.back().offset = (u64)m_file.tellp();
+    WriteValue( m_file, (u64)m_block.size() );
+    WriteValue( m_file, (u64)compressed.size() );
+    m_file.write( compressed.data(), compressed.size() );
+    if( !m_file ){
+        THROW_RUNTIME_ERROR( "Writing the op trace '%s' failed.", m_fileName.c_str() );
+    }
+}
+
+void OpTraceWriter::Write( const OpTraceRecord& record )
+{
+    ASSERT( m_file.is_open() );
+
+    int flags = 0;
+    flags |= record.taken ? RECORD_TAKEN : 0;
+    flags |= record.pc.address != m_nextPC ? RECORD_PC_JUMPED : 0;
+    if( record.memAccessed ){
+        flags |= RECORD_MEM_ACCESSED;
+        flags |= record.memAccess.sign ? RECORD_MEM_SIGN : 0;
+        flags |= record.memAccess.result != MemAccess::MAR_SUCCESS ? RECORD_MEM_FAILED : 0;
+    }
+
+    m_block.push_back( (u8)flags );
+    if( flags & RECORD_PC_JUMPED ){
+        PutSignedVarint( &m_block, (s64)( record.pc.address - m_nextPC ) );
+    }
+    PutVarint( &m_block, record.opClassCode );
+    PutVarint( &m_block, record.microOpIndex );
+    PutVarint( &m_block, record.microOpNum );
+
+    // Operands are written with +1, because an invalid operand is -1.
+    PutVarint( &m_block, record.srcNum );
+    for( int i = 0; i < record.srcNum; i++ ){
+        PutVarint( &m_block, (u64)( record.srcOperand[i] + 1 ) );
+    }
+    PutVarint( &m_block, record.dstNum );
+    for( int i = 0; i < record.dstNum; i++ ){
+        int dst = record.dstOperand[i];
+        PutVarint( &m_block, (u64)( dst + 1 ) );
+        if( dst >= 0 && (size_t)dst < m_registerValue.size() ){
+            PutSignedVarint( &m_block, (s64)( record.dstValue[i] - m_registerValue[dst] ) );
+            m_registerValue[dst] = record.dstValue[i];
+        }
+        else{
+            PutVarint( &m_block, record.dstValue[i] );
+        }
+    }
+
+    if( record.taken ){
+        PutSignedVarint( &m_block, (s64)( record.takenPC.address - record.pc.address ) );
+    }
+    if( record.memAccessed ){
+        const MemAccess& access = record.memAccess;
+        PutSignedVarint( &m_block, (s64)( access.address.address - m_prevMemAddress ) );
+        PutVarint( &m_block, access.size );
+        PutVarint( &m_block, access.value );
+        if( flags & RECORD_MEM_FAILED ){
+            PutVarint( &m_block, access.result );
+        }
+        m_prevMemAddress = access.address.address;
+    }
+
+    m_nextPC = GetNextPC( record );
+    m_opCount++;
+
+    // A block is closed at an instruction boundary.
+    if( record.microOpIndex >= record.microOpNum - 1 ){
+        m_insnCount++;
+        m_blockInsnCount++;
+        if( m_blockInsnCount >= m_blockInsns ){
+            FlushBlock();
+            BeginBlock();
+        }
+    }
+}
+
+void OpTraceWriter::Close()
+{
+    if( !m_file.is_open() ){
+        return;
+    }
+
+    if( m_blockInsnCount > 0 || m_index.back().firstOp != m_opCount ){
+        FlushBlock();
+    }
+    else{
+        m_index.pop_back();
+    }
+
+    u64 indexOffset = (u64)m_file.tellp();
+    WriteValue( m_file, (u64)m_index.size() );
+    for( size_t i = 0; i < m_index.size(); i++ ){
+        WriteValue( m_file, m_index[i].offset );
+        WriteValue( m_file, m_index[i].firstInsn );
+        WriteValue( m_file, m_index[i].firstOp );
+    }
+
+    // Footer
+    WriteValue( m_file, indexOffset );
+    WriteValue( m_file, m_insnCount );
+    WriteValue( m_file, m_opCount );
+    WriteValue( m_file, OP_TRACE_VERSION );
+
+    if( !m_file ){
+        THROW_RUNTIME_ERROR( "Writing the op trace '%s' failed.", m_fileName.c_str() );
+    }
+    m_file.close();
+}
+
+//
+// --- Reader
+//
+static const size_t OP_TRACE_FOOTER_SIZE = sizeof(u64) * 3 + sizeof(u32);
+
+OpTraceReader::OpTraceReader() :
+    m_insnCount( 0 ),
+    m_opCount( 0 ),
+    m_currentInsn( 0 ),
+    m_nextBlock( 0 ),
+    m_blockPos( 0 ),
+    m_nextPC( 0 ),
+    m_prevMemAddress( 0 )
+{
+}
+
+OpTraceReader::~OpTraceReader()
+{
+}
+
+void OpTraceReader::Open( const String& fileName )
+{
+    m_fileName = fileName;
+    m_file.open( fileName.c_str(), ios::in | ios::binary );
+    if( !m_file.is_open() ){
+        THROW_RUNTIME_ERROR( "Could not open '%s'.", fileName.c_str() );
+    }
+
+    char signature[ sizeof(OP_TRACE_SIGNATURE) ];
+    m_file.read( signature, sizeof(signature) );
+    if( !m_file || 
+        memcmp( signature, OP_TRACE_SIGNATURE, sizeof(signature) ) != 0 ||
+        ReadValue<u32>( m_file, fileName ) != OP_TRACE_VERSION 
+    ){
+        THROW_RUNTIME_ERROR( "'%s' is not an op trace or its version is not supported.", fileName.c_str() );
+    }
+
+    vector<char> arch( ReadValue<u32>( m_file, fileName ) );
+    if( !arch.empty() ){
+        m_file.read( &arch[0], arch.size() );
+    }
+    m_header.targetArchitecture = String( string( arch.begin(), arch.end() ) );
+    m_header.pid        = ReadValue<s32>( m_file, fileName );
+    m_header.blockInsns = ReadValue<s32>( m_file, fileName );
+    m_header.initialRegisterValue.resize( ReadValue<u32>( m_file, fileName ) );
+    for( size_t i = 0; i < m_header.initialRegisterValue.size(); i++ ){
+        m_header.initialRegisterValue[i] = ReadValue<u64>( m_file, fileName );
+    }
+
+    // Footer and index
+    m_file.seekg( -(streamoff)OP_TRACE_FOOTER_SIZE, ios::end );
+    u64 indexOffset = ReadValue<u64>( m_file, fileName );
+    m_insnCount     = ReadValue<s64>( m_file, fileName );
+    m_opCount       = ReadValue<s64>( m_file, fileName );
+    if( ReadValue<u32>( m_file, fileName ) != OP_TRACE_VERSION ){
+        THROW_RUNTIME_ERROR( "The op trace '%s' is not closed correctly.", fileName.c_str() );
+    }
+
+    m_file.seekg( (streamoff)indexOffset, ios::beg );
+    m_index.resize( (size_t)ReadValue<u64>( m_file, fileName ) );
+    for( size_t i = 0; i < m_index.size(); i++ ){
+        m_index[i].offset    = ReadValue<u64>( m_file, fileName );
+        m_index[i].firstInsn = ReadValue<s64>( m_file, fileName );
+        m_index[i].firstOp   = ReadValue<s64>( m_file, fileName );
+    }
+
+    m_registerValue = m_header.initialRegisterValue;
+    m_block.clear();
+    m_blockPos = 0;
+    m_nextBlock = 0;
+    m_currentInsn = 0;
+}
+
+void OpTraceReader::Close()
+{
+    if( m_file.is_open() ){
+        m_file.close();
+    }
+    m_block.clear();
+    m_blockPos = 0;
+}
+
+void OpTraceReader::Reopen()
+{
+    // Blocks are read from their offsets in the index, so no position 
+    // has to be restored.
+    m_file.close();
+    m_file.clear();
+    m_file.open( m_fileName.c_str(), ios::in | ios::binary );
+    if( !m_file.is_open() ){
+        THROW_RUNTIME_ERROR( "Could not reopen '%s'.", m_fileName.c_str() );
+    }
+}
+
+void OpTraceReader::LoadBlock( size_t block )
+{
+    ASSERT( block < m_index.size() );
+
+    m_file.clear();
+    m_file.seekg( (streamoff)m_index[block].offset, ios::beg );
+    size_t rawSize        = (size_t)ReadValue<u64>( m_file, m_fileName );
+    size_t compressedSize = (size_t)ReadValue<u64>( m_file, m_fileName );
+
+    vector<char> compressed( compressedSize );
+    if( compressedSize > 0 ){
+        m_file.read( &compressed[0], compressedSize );
+    }
+    if( !m_file ){
+        THROW_RUNTIME_ERROR( "The op trace '%s' is broken or truncated.", m_fileName.c_str() );
+    }
+
+    m_block.resize( rawSize );
+    {
+        boost::iostreams::filtering_istream stream;
+        stream.push( boost::iostreams::zlib_decompressor() );
+        stream.push( boost::iostreams::array_source( compressed.empty() ? NULL : &compressed[0], compressedSize ) );
+        if( rawSize > 0 ){
+            stream.read( reinterpret_cast<char*>( &m_block[0] ), rawSize );
+        }
+        if( (size_t)stream.gcount() != rawSize ){
+            THROW_RUNTIME_ERROR( "The op trace '%s' is broken or truncated.", m_fileName.c_str() );
+        }
+    }
+
+    m_blockPos = 0;
+    m_nextPC = 0;
+    m_prevMemAddress = 0;
+    for( size_t i = 0; i < m_registerValue.size(); i++ ){
+        m_registerValue[i] = GetVarint( m_block, &m_blockPos );
+    }
+
+    m_currentInsn = m_index[block].firstInsn;
+    m_nextBlock = block + 1;
+}
+
+bool OpTraceReader::Read( OpTraceRecord* record )
+{
+    if( m_blockPos >= m_block.size() ){
+        if( m_nextBlock >= m_index.size() ){
+            return false;
+        }
+        LoadBlock( m_nextBlock );
+    }
+
+    int pid = m_header.pid;
+    int flags = m_block[ m_blockPos++ ];
+
+    u64 address = m_nextPC;
+    if( flags & RECORD_PC_JUMPED ){
+        address += (u64)GetSignedVarint( m_block, &m_blockPos );
+    }
+    record->pc = PC( pid, pid, address );
+    record->opClassCode  = (OpClassCode::OpClassCode)GetVarint( m_block, &m_blockPos );
+    record->microOpIndex = (int)GetVarint( m_block, &m_blockPos );
+    record->microOpNum   = (int)GetVarint( m_block, &m_blockPos );
+
+    record->srcNum = (int)GetVarint( m_block, &m_blockPos );
+    if( record->srcNum > SimISAInfo::MAX_SRC_REG_COUNT ){
+        THROW_RUNTIME_ERROR( "The op trace '%s' has too many source operands.", m_fileName.c_str() );
+    }
+    for( int i = 0; i < record->srcNum; i++ ){
+        int src = (int)GetVarint( m_block, &m_blockPos ) - 1;
+        record->srcOperand[i] = src;
+        record->srcValue[i] = 
+            ( src >= 0 && (size_t)src < m_registerValue.size() ) ? m_registerValue[src] : 0;
+    }
+
+    record->dstNum = (int)GetVarint( m_block, &m_blockPos );
+    if( record->dstNum > SimISAInfo::MAX_DST_REG_COUNT ){
+        THROW_RUNTIME_ERROR( "The op trace '%s' has too many destination operands.", m_fileName.c_str() );
+    }
+    for( int i = 0; i < record->dstNum; i++ ){
+        int dst = (int)GetVarint( m_block, &m_blockPos ) - 1;
+        record->dstOperand[i] = dst;
+        if( dst >= 0 && (size_t)dst < m_registerValue.size() ){
+            m_registerValue[dst] += (u64)GetSignedVarint( m_block, &m_blockPos );
+            record->dstValue[i] = m_registerValue[dst];
+        }
+        else{
+            record->dstValue[i] = GetVarint( m_block, &m_blockPos );
+        }
+    }
+
+    record->taken = ( flags & RECORD_TAKEN ) != 0;
+    record->takenPC = PC( pid, pid, address + SimISAInfo::INSTRUCTION_WORD_BYTE_SIZE );
+    if( record->taken ){
+        record->takenPC.address = address + (u64)GetSignedVarint( m_block, &m_blockPos );
+    }
+
+    record->memAccessed = ( flags & RECORD_MEM_ACCESSED ) != 0;
+    if( record->memAccessed ){
+        MemAccess& access = record->memAccess;
+        m_prevMemAddress += (u64)GetSignedVarint( m_block, &m_blockPos );
+        access.address = Addr( pid, pid, m_prevMemAddress );
+        access.size    = (int)GetVarint( m_block, &m_blockPos );
+        access.sign    = ( flags & RECORD_MEM_SIGN ) != 0;
+        access.value   = GetVarint( m_block, &m_blockPos );
+        access.result  = ( flags & RECORD_MEM_FAILED ) ? 
+            (MemAccess::Result)GetVarint( m_block, &m_blockPos ) : MemAccess::MAR_SUCCESS;
+    }
+    else{
+        record->memAccess = MemAccess();
+    }
+
+    m_nextPC = GetNextPC( *record );
+    if( record->microOpIndex >= record->microOpNum - 1 ){
+        m_currentInsn++;
+    }
+    return true;
+}
+
+void OpTraceReader::SeekInsn( s64 insn )
+{
+    if( insn < 0 || insn > m_insnCount ){
+        THROW_RUNTIME_ERROR( "'%lld' is out of the range of the op trace '%s'.", (long long)insn, m_fileName.c_str() );
+    }
+
+    // Find the last block that begins at or before 'insn'.
+    size_t block = 0;
+    for( size_t lo = 0, hi = m_index.size(); lo < hi; ){
+        size_t mid = ( lo + hi ) / 2;
+        if( m_index[mid].firstInsn <= insn ){
+            block = mid;
+            lo = mid + 1;
+        }
+        else{
+            hi = mid;
+        }
+    }
+
+    if( block >= m_index.size() ){
+        // An empty trace
+        m_block.clear();
+        m_blockPos = 0;
+        return;
+    }
+
+    LoadBlock( block );
+    OpTraceRecord record;
+    while( m_currentInsn < insn && Read( &record ) ){
+    }
+}
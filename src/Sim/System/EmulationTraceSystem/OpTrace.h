@@ -0,0 +1,185 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+//
+// A compact binary trace of executed ops.
+//
+// A trace file has the ops of one process. Ops are grouped in blocks, each
+// of which starts at an instruction boundary and has 'blockInsns' instructions.
+// A block is compressed independently and has a snapshot of the registers at
+// its beginning, so a reader can seek to any block with the index at the end
+// of the file.
+//
+// In a block, each op is encoded with variable length integers:
+// a PC is encoded as a difference from the next PC of the previous op,
+// register values as differences from their previous values, and 
+// memory addresses as differences from the previous memory address.
+// Source operand values are not written and are reconstructed from 
+// the destination values of the previous ops by a reader.
+//
+// File layout:
+//   header | block 0 | block 1 | ... | index | footer
+//
+
+#ifndef SIM_SYSTEM_EMULATION_TRACE_SYSTEM_OP_TRACE_H
+#define SIM_SYSTEM_EMULATION_TRACE_SYSTEM_OP_TRACE_H
+
+#include "Interface/Addr.h"
+#include "Interface/MemAccess.h"
+#include "Interface/OpClassCode.h"
+#include "Sim/ISAInfo.h"
+
+namespace Onikiri
+{
+    struct OpTraceHeader
+    {
+        String targetArchitecture;
+        int pid;
+        int blockInsns;             // The number of the instructions in a block.
+        std::vector<u64> initialRegisterValue;
+
+        OpTraceHeader() : pid(0), blockInsns(0) {}
+    };
+
+    struct OpTraceRecord
+    {
+        PC  pc;
+        int microOpIndex;
+        int microOpNum;
+        OpClassCode::OpClassCode opClassCode;
+
+        int srcNum;
+        int dstNum;
+        int srcOperand[ SimISAInfo::MAX_SRC_REG_COUNT ];
+        int dstOperand[ SimISAInfo::MAX_DST_REG_COUNT ];
+        u64 srcValue[ SimISAInfo::MAX_SRC_REG_COUNT ];  // Only set by a reader
+        u64 dstValue[ SimISAInfo::MAX_DST_REG_COUNT ];
+
+        bool taken;
+        PC   takenPC;
+
+        bool memAccessed;
+        MemAccess memAccess;
+
+        OpTraceRecord();
+    };
+
+    class OpTraceWriter
+    {
+    public:
+        OpTraceWriter();
+        ~OpTraceWriter();
+
+        void Open( const String& fileName, const OpTraceHeader& header );
+        void Write( const OpTraceRecord& record );
+        void Close();
+        bool IsOpened() const { return m_file.is_open(); }
+
+    protected:
+        struct IndexEntry
+        {
+            u64 offset;     // A file offset of a block
+            s64 firstInsn;  // The index of the first instruction in a block
+            s64 firstOp;
+        };
+
+        std::ofstream m_file;
+        String m_fileName;
+        int m_blockInsns;
+
+        std::vector<u64> m_registerValue;
+        std::vector<u8>  m_block;       // An uncompressed current block
+        std::vector<IndexEntry> m_index;
+        s64 m_blockInsnCount;
+        s64 m_insnCount;
+        s64 m_opCount;
+        u64 m_nextPC;
+        u64 m_prevMemAddress;
+
+        void BeginBlock();
+        void FlushBlock();
+    };
+
+    class OpTraceReader
+    {
+    public:
+        OpTraceReader();
+        ~OpTraceReader();
+
+        void Open( const String& fileName );
+        void Close();
+
+        // Reopen a trace file, so that a forked process does not share 
+        // a file offset with other processes.
+        void Reopen();
+
+        const OpTraceHeader& GetHeader() const { return m_header; }
+        s64 GetInsnCount() const { return m_insnCount; }
+        s64 GetOpCount() const   { return m_opCount; }
+
+        // Read a next op. Returns false at the end of a trace.
+        bool Read( OpTraceRecord* record );
+
+        // Seek to the first op of the 'insn'-th instruction.
+        void SeekInsn( s64 insn );
+
+        // The values of the registers after the ops read so far.
+        const std::vector<u64>& GetRegisterValue() const { return m_registerValue; }
+
+    protected:
+        struct IndexEntry
+        {
+            u64 offset;
+            s64 firstInsn;
+            s64 firstOp;
+        };
+
+        std::ifstream m_file;
+        String m_fileName;
+        OpTraceHeader m_header;
+        std::vector<IndexEntry> m_index;
+        s64 m_insnCount;
+        s64 m_opCount;
+
+        s64 m_currentInsn;  // The index of the instruction of a next op
+        size_t m_nextBlock;
+        std::vector<u8> m_block;    // An uncompressed current block
+        size_t m_blockPos;
+        std::vector<u64> m_registerValue;
+        u64 m_nextPC;
+        u64 m_prevMemAddress;
+
+        void LoadBlock( size_t block );
+    };
+
+}   // namespace Onikiri
+
+#endif // #ifndef SIM_SYSTEM_EMULATION_TRACE_SYSTEM_OP_TRACE_H
@@ -0,0 +1,121 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+#include <pch.h>
+
+#include "Sim/System/EmulationWarmupSystem/EmulationWarmupSystem.h"
+
+#include "Sim/Core/Core.h"
+#include "Sim/Thread/Thread.h"
+#include "Sim/Memory/Cache/Cache.h"
+#include "Sim/Memory/Cache/CacheSystem.h"
+#include "Sim/Pipeline/Fetcher/Fetcher.h"
+#include "Sim/Predictor/BPred/BPred.h"
+
+using namespace std;
+using namespace boost;
+using namespace Onikiri;
+
+EmulationWarmupSystem::EmulationWarmupSystem()
+{
+    m_enableBPred = false;
+    m_enableCache = false;
+}
+
+void EmulationWarmupSystem::Run()
+{
+    SystemContext* context = GetSystemContext();
+    if (!context) {
+        THROW_RUNTIME_ERROR("System context is not set");
+    }
+
+    m_enableBPred = context->warmupParam.enableBPred;
+    m_enableCache = context->warmupParam.enableCache;
+
+    int processCount = context->emulator->GetProcessCount();
+    m_warmupStates.resize( processCount );
+    for( int pid = 0; pid < processCount; pid++ ){
+        WarmupState& state = m_warmupStates[pid];
+        state.thread = context->threads[pid];
+        state.lastInsnLine = ~(u64)0;
+    }
+
+    EmulationSystem::Run();
+}
+
+void EmulationWarmupSystem::OnSkippedOp(
+    const PC& pc,
+    OpInfo* opInfo,
+    bool taken,
+    const PC& takenPC,
+    const MemAccess* memAccess
+){
+    WarmupState& state = m_warmupStates[ pc.pid ];
+    Core* core = state.thread->GetCore();
+    const OpClass& opClass = opInfo->GetOpClass();
+
+    if( m_enableCache ){
+        CacheSystem* cacheSystem = core->GetCacheSystem();
+
+        // The instruction cache is read only when a fetched line is changed, 
+        // because successive reads of the same line do not change the table.
+        Cache* insnCache = cacheSystem->GetFirstLevelInsnCache();
+        u64 insnLine = pc.address >> insnCache->GetOffsetBitSize();
+        if( insnLine != state.lastInsnLine ){
+            state.lastInsnLine = insnLine;
+            CacheAccess insnAccess;
+            insnAccess.address = pc;
+            insnAccess.type = CacheAccess::OT_READ;
+            insnCache->Read( insnAccess, NULL );
+        }
+
+        // Caches are updated immediately because access queues are disabled
+        // out of a simulation mode.
+        if( memAccess && memAccess->result == MemAccess::MAR_SUCCESS ){
+            Cache* dataCache = cacheSystem->GetFirstLevelDataCache();
+            CacheAccess dataAccess( *memAccess );
+            dataAccess.address.tid = pc.tid;
+            if( opClass.IsStore() ){
+                dataAccess.type = CacheAccess::OT_WRITE;
+                dataCache->Write( dataAccess, NULL );
+            }
+            else{
+                dataAccess.type = CacheAccess::OT_READ;
+                dataCache->Read( dataAccess, NULL );
+            }
+        }
+    }
+
+    if( m_enableBPred && opClass.IsBranch() ){
+        BPred* bPred = core->GetFetcher()->GetBPred();
+        bPred->Warmup( state.thread->GetLocalThreadID(), pc, opClass, taken, takenPC );
+    }
+}
@@ -0,0 +1,78 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+#ifndef SIM_SYSTEM_EMULATION_WARMUP_SYSTEM_EMULATION_WARMUP_SYSTEM_H
+#define SIM_SYSTEM_EMULATION_WARMUP_SYSTEM_EMULATION_WARMUP_SYSTEM_H
+
+#include "Sim/System/EmulationSystem/EmulationSystem.h"
+
+namespace Onikiri 
+{
+    class Thread;
+
+    // A system that runs in an emulation mode and warms caches and branch 
+    // predictors up functionally with the skipped ops.
+    // No timing is simulated and no op is constructed in this system.
+    class EmulationWarmupSystem : 
+        public EmulationSystem,
+        public SkipObserverIF
+    {
+    public:
+        EmulationWarmupSystem();
+        void Run();
+
+        // SkipObserverIF
+        virtual void OnSkippedOp(
+            const PC& pc,
+            OpInfo* opInfo,
+            bool taken,
+            const PC& takenPC,
+            const MemAccess* memAccess
+        );
+
+    protected:
+        virtual SkipObserverIF* GetSkipObserver() { return this; }
+
+        bool m_enableBPred;
+        bool m_enableCache;
+
+        // Per-process state for warming.
+        struct WarmupState
+        {
+            Thread* thread;
+            u64 lastInsnLine;  // The last accessed line of an instruction cache.
+        };
+        std::vector<WarmupState> m_warmupStates;
+    };
+}; // namespace Onikiri
+
+#endif // SIM_SYSTEM_EMULATION_WARMUP_SYSTEM_EMULATION_WARMUP_SYSTEM_H
+
@@ -69,6 +69,8 @@ void ForwardEmulator::SetContext( const ArchitectureStateList& context )
     m_context = context;
     m_inflightOps.clear();
     m_inflightOps.resize( m_context.size() );
+    m_storeIndex.clear();
+    m_storeIndex.resize( m_context.size() );
 
     m_threadContext.resize( m_context.size() );
     for( size_t i = 0; i < m_context.size(); ++i ){
@@ -153,6 +155,11 @@ void ForwardEmulator::OnFetch( OpIterator simOp )
         m_emulator->Execute( emuOp, opInfo );
         UpdateArchContext( context, emuOp, opInfo, entry->updatePC, true );
         UpdateFixedPath( simOp );
+
+        if( entry->isStore ){
+            const MemAccess& access = entry->memAccess;
+            m_storeIndex[ tid ].Insert( entry->retireId, entry, access.address.address, access.size );
+        }
     }
 }
 
@@ -252,6 +259,11 @@ void ForwardEmulator::OnCommit( OpIterator simOp )
 
 
 
+    if( front->isStore ){
+        const MemAccess& access = front->memAccess;
+        m_storeIndex[ tid ].Erase( front->retireId, access.address.address, access.size );
+    }
+
     inflightOps->pop_front();
 }
 
@@ -363,19 +375,19 @@ ForwardEmulator::InflightOp*
 {
     const MemAccess& access = consumerLoad.memAccess;
     int tid = access.address.tid;
-    InflightOpList* inflightOps = &m_inflightOps[ tid ];
 
-    InflightOpList::reverse_iterator end = inflightOps->rend();
-    for( InflightOpList::reverse_iterator i = inflightOps->rbegin(); i != end; ++i ){
-        if( !i->isStore ){
-            continue;
-        }
-        if( consumerLoad.retireId < i->retireId ){
+    // Only stores that may overlap 'access' are searched from the back.
+    m_storeIndex[ tid ].Find( access.address.address, access.size, &m_candidates );
+
+    InflightStoreIndex::EntryList::reverse_iterator end = m_candidates.rend();
+    for( InflightStoreIndex::EntryList::reverse_iterator i = m_candidates.rbegin(); i != end; ++i ){
+        InflightOp* store = i->value;
+        if( consumerLoad.retireId < store->retireId ){
             continue;
         }
 
-        if( m_memOperations.IsOverlapped( access, i->memAccess ) ){
-            return &(*i);
+        if( m_memOperations.IsOverlapped( access, store->memAccess ) ){
+            return store;
         }
     }
     return NULL;
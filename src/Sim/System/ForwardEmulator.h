@@ -41,6 +41,7 @@
 #include "Sim/System/EmulationSystem/EmulationOp.h"
 #include "Sim/Op/OpArray/OpArray.h"
 #include "Sim/Memory/MemOrderManager/MemOrderOperations.h"
+#include "Sim/Memory/MemOrderManager/MemAccessIndex.h"
 
 namespace Onikiri 
 {
@@ -141,6 +142,11 @@ namespace Onikiri
 
         typedef pool_list< InflightOp > InflightOpList;
         std::vector< InflightOpList >   m_inflightOps;
+
+        // Address indices of in-flight stores in each thread, which are ordered by retirement ids.
+        typedef MemAccessIndex< InflightOp* > InflightStoreIndex;
+        std::vector< InflightStoreIndex >   m_storeIndex;
+        InflightStoreIndex::EntryList       m_candidates;   // A work area for searching.
         std::vector< ThreadContext >    m_threadContext;
 
         bool m_enable;
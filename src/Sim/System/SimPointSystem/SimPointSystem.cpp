@@ -0,0 +1,393 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+
+#include <pch.h>
+
+#include "Sim/System/SimPointSystem/SimPointSystem.h"
+
+using namespace std;
+using namespace boost;
+using namespace Onikiri;
+
+namespace
+{
+    // The maximum number of k-means iterations
+    const int KMEANS_MAX_ITERATION = 100;
+
+    double SquaredDistance( const vector<double>& a, const vector<double>& b )
+    {
+        double sum = 0;
+        for( size_t i = 0; i < a.size(); i++ ){
+            double d = a[i] - b[i];
+            sum += d * d;
+        }
+        return sum;
+    }
+}
+
+SimPointSystem::SimPointSystem()
+{
+    m_blockStart  = 0;
+    m_blockInsns  = 0;
+    m_lastPC      = 0;
+    m_reqTermination = false;
+}
+
+void SimPointSystem::Run()
+{
+    SystemContext* context = GetSystemContext();
+    if (!context) {
+        THROW_RUNTIME_ERROR("System context is not set");
+    }
+    if( context->emulator->GetProcessCount() != 1 ){
+        THROW_RUNTIME_ERROR( "'SimPointProfile' mode supports only a single process." );
+    }
+
+    const SystemContext::SimPointParam& param = context->simPointParam;
+    if( param.intervalInsns <= 0 || param.maxK <= 0 || param.dimensions <= 0 ){
+        THROW_RUNTIME_ERROR( 
+            "'@IntervalInsns', '@MaxK' and '@Dimensions' in "
+            "'/Session/Simulator/System/SimPoint' must be positive." 
+        );
+    }
+    m_random.seed( (u32)param.seed );
+
+    String fileName = g_env.GetHostWorkPath() + param.fileName + ".bb";
+    m_bbvFile.open( fileName.c_str() );
+    if( !m_bbvFile ){
+        THROW_RUNTIME_ERROR( "Could not open '%s'.", fileName.c_str() );
+    }
+
+    // Each interval is executed by one Skip() call.
+    // A trailing interval shorter than '@IntervalInsns' is not profiled.
+    ArchitectureState& state = context->architectureStateList[0];
+    s64 executedInsns = 0;
+    m_reqTermination = false;
+    while( !m_reqTermination && state.pc.address != 0 && executedInsns < context->executionInsns ){
+        u64 insns = (u64)std::min( param.intervalInsns, context->executionInsns - executedInsns );
+        u64 executed = 0;
+        state.pc = 
+            context->emulator->Skip(
+                state.pc,
+                insns,
+                &state.registerValue[0],
+                &executed,
+                NULL,
+                this
+            );
+        executedInsns += executed;
+        if( executed == (u64)param.intervalInsns ){
+            EndInterval();
+        }
+    }
+    m_bbvFile.close();
+
+    ChooseSimPoints();
+    WriteSimPoints();
+
+    context->executedInsns.assign( 1, executedInsns );
+    context->executedCycles = 0;
+}
+
+void SimPointSystem::Terminate()
+{
+    m_reqTermination = true;
+    if( m_context ){
+        m_context->emulator->TerminateSkip();
+    }
+}
+
+// A basic block ends at a branch op. A new instruction is counted when
+// the address is changed, because an instruction may be split into 
+// several ops.
+void SimPointSystem::OnSkippedOp(
+    const PC& pc,
+    OpInfo* opInfo,
+    bool taken,
+    const PC& takenPC,
+    const MemAccess* memAccess
+){
+    if( m_blockInsns == 0 ){
+        m_blockStart = pc.address;
+        m_lastPC     = pc.address;
+        m_blockInsns = 1;
+    }
+    else if( pc.address != m_lastPC ){
+        m_lastPC = pc.address;
+        m_blockInsns++;
+    }
+
+    if( opInfo->GetOpClass().IsBranch() ){
+        u32 id = GetBlockID( m_blockStart );
+        if( m_blockCounts[id] == 0 ){
+            m_touchedBlocks.push_back( id );
+        }
+        m_blockCounts[id] += m_blockInsns;
+        m_blockInsns = 0;
+    }
+}
+
+u32 SimPointSystem::GetBlockID( u64 address )
+{
+    unordered_map<u64, u32>::iterator i = m_blockID.find( address );
+    if( i != m_blockID.end() ){
+        return i->second;
+    }
+
+    u32 id = (u32)m_blockCounts.size();
+    m_blockID[address] = id;
+    m_blockCounts.push_back( 0 );
+
+    // Elements of the projection matrix are uniformly distributed in [-1, 1].
+    uniform_real_distribution<double> distribution( -1.0, 1.0 );
+    Vector row( m_context->simPointParam.dimensions );
+    for( size_t d = 0; d < row.size(); d++ ){
+        row[d] = distribution( m_random );
+    }
+    m_projection.push_back( row );
+    return id;
+}
+
+// Write the BBV of the current interval and project it.
+// The BBV is normalized so that the sum of its elements is 1 before projection.
+void SimPointSystem::EndInterval()
+{
+    std::sort( m_touchedBlocks.begin(), m_touchedBlocks.end() );
+
+    u64 totalInsns = 0;
+    for( size_t i = 0; i < m_touchedBlocks.size(); i++ ){
+        totalInsns += m_blockCounts[ m_touchedBlocks[i] ];
+    }
+
+    Vector projected( m_context->simPointParam.dimensions, 0.0 );
+    m_bbvFile << "T";
+    for( size_t i = 0; i < m_touchedBlocks.size(); i++ ){
+        u32 id = m_touchedBlocks[i];
+        u64 count = m_blockCounts[id];
+
+        // Block IDs in the SimPoint format start from 1.
+        m_bbvFile << ":" << id + 1 << ":" << count << " ";
+
+        double ratio = (double)count / (double)totalInsns;
+        const Vector& row = m_projection[id];
+        for( size_t d = 0; d < projected.size(); d++ ){
+            projected[d] += ratio * row[d];
+        }
+        m_blockCounts[id] = 0;
+    }
+    m_bbvFile << "\n";
+
+    m_touchedBlocks.clear();
+    m_projectedBBVs.push_back( projected );
+}
+
+void SimPointSystem::ChooseSimPoints()
+{
+    m_simPoints.clear();
+    size_t intervals = m_projectedBBVs.size();
+    if( intervals == 0 ){
+        RUNTIME_WARNING( "No interval is profiled and no simulation point is chosen." );
+        return;
+    }
+
+    const SystemContext::SimPointParam& param = m_context->simPointParam;
+    int maxK = (int)std::min( (size_t)param.maxK, intervals );
+
+    vector< vector<Vector> > centroids( maxK + 1 );
+    vector< vector<int> > clusters( maxK + 1 );
+    vector<double> bic( maxK + 1 );
+    for( int k = 1; k <= maxK; k++ ){
+        double distortion = KMeans( k, &centroids[k], &clusters[k] );
+        bic[k] = CalculateBIC( k, distortion, clusters[k] );
+    }
+
+    // Choose the smallest 'k' whose score is above the threshold 
+    // in the range of the scores.
+    double minBIC = *std::min_element( bic.begin() + 1, bic.end() );
+    double maxBIC = *std::max_element( bic.begin() + 1, bic.end() );
+    int k = 1;
+    while( k < maxK && bic[k] - minBIC < param.bicThreshold * (maxBIC - minBIC) ){
+        k++;
+    }
+
+    // The interval closest to the centroid represents its cluster.
+    vector<s64> representative( k, -1 );
+    vector<double> minDistance( k, 0.0 );
+    vector<s64> clusterSize( k, 0 );
+    for( size_t i = 0; i < intervals; i++ ){
+        int c = clusters[k][i];
+        double distance = SquaredDistance( m_projectedBBVs[i], centroids[k][c] );
+        if( representative[c] == -1 || distance < minDistance[c] ){
+            representative[c] = (s64)i;
+            minDistance[c] = distance;
+        }
+        clusterSize[c]++;
+    }
+
+    for( int c = 0; c < k; c++ ){
+        if( representative[c] == -1 ){
+            continue;
+        }
+        SimPoint point;
+        point.interval = representative[c];
+        point.weight = (double)clusterSize[c] / (double)intervals;
+        m_simPoints.push_back( point );
+    }
+
+    struct IntervalLess
+    {
+        bool operator()( const SimPoint& lhs, const SimPoint& rhs ) const
+        {
+            return lhs.interval < rhs.interval;
+        }
+    };
+    std::sort( m_simPoints.begin(), m_simPoints.end(), IntervalLess() );
+}
+
+// The output files are in the same formats as those of SimPoint.
+// Each line of '.simpoints' is "<interval> <index>" and 
+// each line of '.weights' is "<weight> <index>".
+void SimPointSystem::WriteSimPoints()
+{
+    String baseName = g_env.GetHostWorkPath() + m_context->simPointParam.fileName;
+    String simPointsFileName = baseName + ".simpoints";
+    String weightsFileName   = baseName + ".weights";
+
+    ofstream simPointsFile( simPointsFileName.c_str() );
+    ofstream weightsFile( weightsFileName.c_str() );
+    if( !simPointsFile || !weightsFile ){
+        THROW_RUNTIME_ERROR( "Could not open '%s' or '%s'.", simPointsFileName.c_str(), weightsFileName.c_str() );
+    }
+
+    for( size_t i = 0; i < m_simPoints.size(); i++ ){
+        simPointsFile << m_simPoints[i].interval << " " << i << "\n";
+        weightsFile   << m_simPoints[i].weight   << " " << i << "\n";
+    }
+}
+
+// Centroids are initialized with randomly chosen intervals.
+double SimPointSystem::KMeans( int k, vector<Vector>* centroids, vector<int>* clusters )
+{
+    const vector<Vector>& points = m_projectedBBVs;
+    size_t dims = points[0].size();
+
+    vector<size_t> order( points.size() );
+    for( size_t i = 0; i < order.size(); i++ ){
+        order[i] = i;
+    }
+    std::shuffle( order.begin(), order.end(), m_random );
+
+    centroids->resize( k );
+    for( int c = 0; c < k; c++ ){
+        (*centroids)[c] = points[ order[c] ];
+    }
+    clusters->assign( points.size(), -1 );
+
+    double distortion = 0;
+    for( int iteration = 0; iteration < KMEANS_MAX_ITERATION; iteration++ ){
+        bool changed = false;
+        distortion = 0;
+        for( size_t i = 0; i < points.size(); i++ ){
+            int nearest = 0;
+            double minDistance = SquaredDistance( points[i], (*centroids)[0] );
+            for( int c = 1; c < k; c++ ){
+                double distance = SquaredDistance( points[i], (*centroids)[c] );
+                if( distance < minDistance ){
+                    nearest = c;
+                    minDistance = distance;
+                }
+            }
+            if( (*clusters)[i] != nearest ){
+                (*clusters)[i] = nearest;
+                changed = true;
+            }
+            distortion += minDistance;
+        }
+        if( !changed ){
+            break;
+        }
+
+        // An empty cluster keeps its previous centroid.
+        vector<Vector> sums( k, Vector( dims, 0.0 ) );
+        vector<s64> counts( k, 0 );
+        for( size_t i = 0; i < points.size(); i++ ){
+            int c = (*clusters)[i];
+            for( size_t d = 0; d < dims; d++ ){
+                sums[c][d] += points[i][d];
+            }
+            counts[c]++;
+        }
+        for( int c = 0; c < k; c++ ){
+            if( counts[c] == 0 ){
+                continue;
+            }
+            for( size_t d = 0; d < dims; d++ ){
+                (*centroids)[c][d] = sums[c][d] / (double)counts[c];
+            }
+        }
+    }
+    return distortion;
+}
+
+// The Bayesian information criterion of a clustering with the identical 
+// spherical Gaussian assumption (Pelleg and Moore, X-means).
+double SimPointSystem::CalculateBIC( int k, double distortion, const vector<int>& clusters )
+{
+    double r = (double)clusters.size();
+    double m = (double)m_projectedBBVs[0].size();
+
+    double variance = 
+        clusters.size() > (size_t)k ? distortion / (r - k) : 0.0;
+    variance = std::max( variance, numeric_limits<double>::min() );
+
+    vector<s64> clusterSize( k, 0 );
+    for( size_t i = 0; i < clusters.size(); i++ ){
+        clusterSize[ clusters[i] ]++;
+    }
+
+    const double pi = 3.14159265358979323846;
+    double logLikelihood = 0;
+    for( int c = 0; c < k; c++ ){
+        double rc = (double)clusterSize[c];
+        if( rc == 0 ){
+            continue;
+        }
+        logLikelihood += 
+            rc * log( rc ) - rc * log( r ) -
+            rc / 2.0 * log( 2.0 * pi ) -
+            rc * m / 2.0 * log( variance ) -
+            ( rc - k ) / 2.0;
+    }
+
+    double params = ( k - 1 ) + m * k + 1;
+    return logLikelihood - params / 2.0 * log( r );
+}
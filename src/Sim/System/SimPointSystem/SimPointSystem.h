@@ -0,0 +1,117 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+
+#ifndef SIM_SYSTEM_SIMPOINT_SYSTEM_SIMPOINT_SYSTEM_H
+#define SIM_SYSTEM_SIMPOINT_SYSTEM_SIMPOINT_SYSTEM_H
+
+#include <random>
+#include "Sim/System/SystemBase.h"
+
+namespace Onikiri 
+{
+    // A system that profiles basic block vectors (BBVs) of fixed size intervals
+    // in an emulation mode and chooses simulation points like SimPoint.
+    //
+    // A BBV of each interval is the number of the instructions executed in
+    // each basic block. The BBVs are written in the SimPoint frequency vector 
+    // format, so they can also be analyzed with the original SimPoint tool.
+    // The BBVs are randomly projected to a low dimension and clustered by 
+    // k-means. 'k' is the smallest one whose BIC score is above the 
+    // threshold, as SimPoint does.
+    // The interval closest to the centroid of each cluster is chosen as 
+    // a simulation point and weighted by the size of the cluster.
+    class SimPointSystem : 
+        public SystemBase,
+        public SkipObserverIF
+    {
+    public:
+        struct SimPoint
+        {
+            s64 interval;   // The index of the chosen interval
+            double weight;  // The ratio of the intervals in its cluster
+        };
+
+        SimPointSystem();
+        void Run();
+        void Terminate();
+
+        // Simulation points sorted by their intervals.
+        const std::vector<SimPoint>& GetSimPoints() const
+        {
+            return m_simPoints;
+        }
+
+        // SkipObserverIF
+        virtual void OnSkippedOp(
+            const PC& pc,
+            OpInfo* opInfo,
+            bool taken,
+            const PC& takenPC,
+            const MemAccess* memAccess
+        );
+
+    protected:
+        typedef std::vector<double> Vector;
+
+        // Basic blocks are identified by their start addresses.
+        unordered_map<u64, u32> m_blockID;
+        u64 m_blockStart;   // The start address of the current basic block
+        u64 m_blockInsns;   // The number of the executed instructions in the current block
+        u64 m_lastPC;       // The address of the last op
+
+        // Executed instructions of each block in the current interval.
+        std::vector<u64> m_blockCounts;
+        std::vector<u32> m_touchedBlocks;
+
+        // A row of the random projection matrix for each block.
+        std::vector<Vector> m_projection;
+        std::vector<Vector> m_projectedBBVs;
+        std::vector<SimPoint> m_simPoints;
+
+        std::mt19937 m_random;
+        std::ofstream m_bbvFile;
+        bool m_reqTermination;
+
+        u32  GetBlockID( u64 address );
+        void EndInterval();
+        void ChooseSimPoints();
+        void WriteSimPoints();
+
+        // Run k-means and return the sum of the squared distances.
+        double KMeans( int k, std::vector<Vector>* centroids, std::vector<int>* clusters );
+        double CalculateBIC( int k, double distortion, const std::vector<int>& clusters );
+    };
+    
+}; // namespace Onikiri
+
+#endif // SIM_SYSTEM_SIMPOINT_SYSTEM_SIMPOINT_SYSTEM_H
+
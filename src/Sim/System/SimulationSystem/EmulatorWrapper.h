@@ -37,16 +37,34 @@
 
 namespace Onikiri 
 {
+    // All accesses from the simulation models to an emulator go through
+    // this wrapper. When cores are simulated on multiple host threads, 
+    // the accesses are serialized here because the emulator is not thread safe.
     class EmulatorWrapper : 
         public EmulatorIF, 
+        public MemIF,
         public PhysicalResourceNode
     {
         EmulatorIF* m_body;
+        bool m_serialize;
+        std::recursive_mutex m_mutex;
+
+        // A recursive mutex is used because the emulator calls back to
+        // the simulation models (ex. ForwardEmulator) during execution.
+        std::unique_lock<std::recursive_mutex> Lock()
+        {
+            if( m_serialize ){
+                return std::unique_lock<std::recursive_mutex>( m_mutex );
+            }
+            return std::unique_lock<std::recursive_mutex>();
+        }
+
     public:
 
         EmulatorWrapper()
         {
             m_body = NULL;
+            m_serialize = false;
         }
 
         ~EmulatorWrapper()
@@ -59,6 +77,12 @@ namespace Onikiri
             m_body = body;
         }
 
+        // Serialize accesses to the emulator from multiple host threads.
+        void SetSerialization( bool serialize )
+        {
+            m_serialize = serialize;
+        }
+
         //
         // PhysicalResourceNode
         //
@@ -75,21 +99,26 @@ namespace Onikiri
         //
         std::pair<OpInfo**, int> GetOp(PC pc)
         {
+            std::unique_lock<std::recursive_mutex> lock = Lock();
             return m_body->GetOp( pc );
         }
 
         MemIF* GetMemImage()
         {
-            return m_body->GetMemImage();
+            // The memory image is also accessed through this wrapper 
+            // when accesses are serialized.
+            return m_serialize ? this : m_body->GetMemImage();
         }
 
         void Execute( OpStateIF* opStateIF, OpInfo* opInfo )
         {
+            std::unique_lock<std::recursive_mutex> lock = Lock();
             m_body->Execute( opStateIF, opInfo );
         }
 
         void Commit( OpStateIF* opStateIF, OpInfo* opInfo )
         {
+            std::unique_lock<std::recursive_mutex> lock = Lock();
             m_body->Commit( opStateIF, opInfo );
         }
 
@@ -113,9 +142,9 @@ namespace Onikiri
             return m_body->GetISAInfo();
         }
 
-        PC Skip(PC pc, u64 skipCount, u64* regArray, u64* executedInsnCount, u64* executedOpCount)
+        PC Skip(PC pc, u64 skipCount, u64* regArray, u64* executedInsnCount, u64* executedOpCount, SkipObserverIF* observer)
         {
-            return m_body->Skip( pc, skipCount, regArray, executedInsnCount, executedOpCount );
+            return m_body->Skip( pc, skipCount, regArray, executedInsnCount, executedOpCount, observer );
         }
 
         void TerminateSkip()
@@ -127,6 +156,36 @@ namespace Onikiri
         {
             m_body->SetExtraOpDecoder( extraOpDecoder );
         }
+
+        void SaveProcessState( int pid, CheckpointWriter* writer )
+        {
+            m_body->SaveProcessState( pid, writer );
+        }
+
+        void RestoreProcessState( int pid, CheckpointReader* reader )
+        {
+            m_body->RestoreProcessState( pid, reader );
+        }
+
+        void ReopenHostFiles()
+        {
+            m_body->ReopenHostFiles();
+        }
+
+        //
+        // MemIF
+        //
+        void Read( MemAccess* access )
+        {
+            std::unique_lock<std::recursive_mutex> lock = Lock();
+            m_body->GetMemImage()->Read( access );
+        }
+
+        void Write( MemAccess* access )
+        {
+            std::unique_lock<std::recursive_mutex> lock = Lock();
+            m_body->GetMemImage()->Write( access );
+        }
     };
 }
 
@@ -34,6 +34,7 @@
 #include "Sim/System/SimulationSystem/SimulationSystem.h"
 
 #include "Sim/Dumper/Dumper.h"
+#include "Sim/Foundation/Profiler/HostProfiler.h"
 #include "Sim/Foundation/Hook/HookUtil.h"
 
 #include "Sim/Foundation/TimeWheel/TimeWheel.h"
@@ -43,6 +44,7 @@
 #include "Sim/Pipeline/Scheduler/Scheduler.h"
 #include "Sim/Pipeline/Retirer/Retirer.h"
 #include "Sim/InorderList/InorderList.h"
+#include "Sim/Memory/Cache/CacheSystem.h"
 
 
 namespace Onikiri
@@ -64,6 +66,29 @@ SimulationSystem::SimulationSystem()
 {
     m_context = NULL;
     m_reqTeminatation = false;
+    m_parallel = false;
+
+    PartitionTask task = { this };
+    m_partitionTask = task;
+}
+
+SimulationSystem::~SimulationSystem()
+{
+    m_threadPool.Stop();
+
+    // Detach the caches and the emulator from the parallel engine.
+    if( m_parallel ){
+        PhysicalResourceArray<Cache>& caches = m_context->caches;
+        for( int i = 0; i < caches.GetSize(); i++ ){
+            caches[i]->SetParallelAccessContext( NULL );
+        }
+        m_context->emulatorWrapper.SetSerialization( false );
+    }
+
+    for( size_t i = 0; i < m_partitions.size(); i++ ){
+        delete m_partitions[i];
+    }
+    m_partitions.clear();
 }
 
 // SystemIF
@@ -84,6 +109,7 @@ void SimulationSystem::Run()
         context->executedCycles = 1;
         s64 numInsns  = context->executionInsns;
         s64 numCycles = context->executionCycles;
+        u64 beginTimeStamp = ReadHostTimeStamp();
 
         while(true){
             context->globalClock->Tick();
@@ -106,6 +132,7 @@ void SimulationSystem::Run()
                 }
                 retiredInsns += core->GetRetirer()->GetNumRetiredInsns();
             }
+            g_dumper.SampleStatistics( context->executedCycles, retiredInsns );
 
             // 終了条件
             if(exitSimulation || m_reqTeminatation){
@@ -123,6 +150,22 @@ void SimulationSystem::Run()
             }
 
             ++context->executedCycles;
+
+            // Skip cycles in which all resources are idle.
+            // 'numCycles' is checked and the statistics are sampled in 
+            // the last skipped cycle.
+            s64 idleCycles = GetIdleCycles();
+            if( numCycles > 0 ){
+                idleCycles = std::min( idleCycles, numCycles - context->executedCycles );
+            }
+            idleCycles = std::min( idleCycles, g_dumper.GetSkippableCycles( context->executedCycles ) );
+            if( idleCycles > 0 ){
+                SkipIdleCycles( idleCycles );
+            }
+        }
+
+        if( g_hostProfiler.IsEnabled() ){
+            g_hostProfiler.AddTotalTicks( ReadHostTimeStamp() - beginTimeStamp );
         }
 
         m_reqTeminatation = false;
@@ -176,118 +219,469 @@ void SimulationSystem::InitializeResourcesBody()
     }
 
     //
-    // Register clocked resources
+    // Assign cores and caches to partitions
+    //
+    vector<int> corePartition( core.GetSize(), 0 );
+    vector<int> cachePartition( caches.GetSize(), 0 );
+    int numPartitions = 1;
+    if( IsParallelSimulationEnabled() ){
+        numPartitions = PartitionResources( &corePartition, &cachePartition );
+    }
+    m_parallel = numPartitions > 1;
+
+    for( int i = 0; i < numPartitions; i++ ){
+        m_partitions.push_back( new Partition() );
+    }
+
+    //
+    // Register clocked resources and time wheels
     //
     for( int i = 0; i < caches.GetSize(); i++ ){
-        m_clockedResources.push_back( caches[i] );
+        Partition* partition = m_partitions[ cachePartition[i] ];
+        partition->clockedResources.push_back( caches[i] );
+        partition->timeWheels.push_back( caches[i]->GetLowerPipeline() );
     }
 
     for( int i = 0; i < core.GetSize(); i++ ){
         CoreResources& res = m_coreResources[i];
-
         res.core = core[i];
-        m_clockedResources.push_back( core[i]->GetRetirer() );
+
+        Partition* partition = m_partitions[ corePartition[i] ];
+        ClockedResourceList& clockedResources = partition->clockedResources;
+        TimeWheelList& timeWheels = partition->timeWheels;
+
+        clockedResources.push_back( core[i]->GetRetirer() );
+        timeWheels.push_back( core[i]->GetRetirer()->GetLowerPipeline() );
 
         for( int j = 0; j < core[i]->GetNumScheduler(); j++ ){
             Scheduler* scheduler = core[i]->GetScheduler( j );
-            m_clockedResources.push_back( scheduler );
+            clockedResources.push_back( scheduler );
+            timeWheels.push_back( scheduler->GetLowerPipeline() );
         }
 
-        m_clockedResources.push_back( core[i]->GetDispatcher() );
-        m_clockedResources.push_back( core[i]->GetRenamer() );
-        m_clockedResources.push_back( core[i]->GetFetcher() );
+        clockedResources.push_back( core[i]->GetDispatcher() );
+        clockedResources.push_back( core[i]->GetRenamer() );
+        clockedResources.push_back( core[i]->GetFetcher() );
+        timeWheels.push_back( core[i]->GetDispatcher()->GetLowerPipeline() );
+        timeWheels.push_back( core[i]->GetRenamer()->GetLowerPipeline() );
+        timeWheels.push_back( core[i]->GetFetcher()->GetLowerPipeline() );
 
-        m_clockedResources.push_back( core[i] );
+        clockedResources.push_back( core[i] );
     }
 
-    sort(
-        m_clockedResources.begin(), 
-        m_clockedResources.end(), 
-        ClockedResourceBase::ComparePriority() 
-    );
+    for( int i = 0; i < numPartitions; i++ ){
+        sort(
+            m_partitions[i]->clockedResources.begin(), 
+            m_partitions[i]->clockedResources.end(), 
+            ClockedResourceBase::ComparePriority() 
+        );
+    }
+
+    if( g_hostProfiler.IsEnabled() ){
+        InitializeHostProfiler();
+    }
 
     //
-    // Register time wheels 
+    // Set up the parallel engine
     //
-    for( int i = 0; i < caches.GetSize(); i++ ){
-        m_timeWheels.push_back( caches[i]->GetLowerPipeline() );
+    if( m_parallel ){
+        int sharedPartition = numPartitions - 1;
+        for( int i = 0; i < caches.GetSize(); i++ ){
+            if( cachePartition[i] == sharedPartition ){
+                caches[i]->SetParallelAccessContext( &m_sharedCacheContext );
+            }
+        }
+        m_context->emulatorWrapper.SetSerialization( true );
+
+        int hostThreads = std::min( m_context->parallelParam.hostThreads, numPartitions - 1 );
+        m_threadPool.Start( hostThreads );
+
+        g_env.PrintInternal( 
+            String().format( 
+                "Parallel simulation: %d partitions on %d host threads.\n", 
+                numPartitions - 1, 
+                hostThreads 
+            ).c_str()
+        );
     }
+}
 
-    for( int i = 0; i < core.GetSize(); i++ ){
-        CoreResources& res = m_coreResources[i];
+// Assign slots in the host profiler to clocked resources.
+// Resources are named with their names and RIDs, so resources in 
+// different simulation systems with the same name share a slot.
+void SimulationSystem::InitializeHostProfiler()
+{
+    for( size_t i = 0; i < m_partitions.size(); i++ ){
+        Partition* partition = m_partitions[i];
+        partition->priorityEventList.SetProfileTable( g_hostProfiler.CreateEventTable() );
+
+        ClockedResourceList& resources = partition->clockedResources;
+        partition->profileSlots.clear();
+        for( size_t r = 0; r < resources.size(); r++ ){
+            String name;
+            PhysicalResourceNode* node = dynamic_cast<PhysicalResourceNode*>( resources[r] );
+            if( node ){
+                name.format( "%s[%d]", node->GetName().c_str(), node->GetRID() );
+            }
+            else{
+                name = resources[r]->Who();
+            }
+            partition->profileSlots.push_back( g_hostProfiler.AddResource( name ) );
+        }
+    }
+}
 
-        res.core = core[i];
-        m_timeWheels.push_back( core[i]->GetRetirer()->GetLowerPipeline() );
+// Returns the number of next cycles in which all resources are idle.
+// A cycle can be skipped when no events are triggered and no resources
+// work in a last cycle, because next cycles repeat the last cycle until
+// a cycle where an event is triggered.
+s64 SimulationSystem::GetIdleCycles()
+{
+    if( !m_context->skipIdleCycles || m_parallel ){
+        return 0;
+    }
 
-        for( int j = 0; j < core[i]->GetNumScheduler(); j++ ){
-            Scheduler* scheduler = core[i]->GetScheduler( j );
-            m_timeWheels.push_back( scheduler->GetLowerPipeline() );
+    if( s_cycleBeginHook.IsAnyHookRegistered()   || 
+        s_cycleEvaluateHook.IsAnyHookRegistered() ||
+        s_cycleTransitionHook.IsAnyHookRegistered() ||
+        s_cycleUpdateHook.IsAnyHookRegistered() ||
+        s_cycleEndHook.IsAnyHookRegistered()
+    ){
+        return 0;
+    }
+
+    s64 cycles = ClockedResourceIF::IDLE_CYCLES_UNBOUNDED;
+    for( size_t i = 0; i < m_partitions.size(); i++ ){
+        Partition* partition = m_partitions[i];
+        if( partition->priorityEventList.HasExtractedEvent() ){
+            return 0;
         }
 
-        m_timeWheels.push_back( core[i]->GetDispatcher()->GetLowerPipeline() );
-        m_timeWheels.push_back( core[i]->GetRenamer()->GetLowerPipeline() );
-        m_timeWheels.push_back( core[i]->GetFetcher()->GetLowerPipeline() );
+        ClockedResourceList& resources = partition->clockedResources;
+        ClockedResourceList::iterator end = resources.end();
+        for( ClockedResourceList::iterator r = resources.begin(); r != end; ++r ){
+            cycles = std::min( cycles, (*r)->GetIdleCycles() );
+            if( cycles == 0 ){
+                return 0;
+            }
+        }
     }
 
+    // Nothing will happen in this case and this is left to the 
+    // dead lock detection in the retirer.
+    if( cycles == ClockedResourceIF::IDLE_CYCLES_UNBOUNDED ){
+        return 0;
+    }
+    return cycles;
+}
+
+// Skip idle cycles.
+// The current cycle of dumpers is set at the beginning of a next simulated
+// cycle, because dumpers are not called in idle cycles.
+void SimulationSystem::SkipIdleCycles( s64 cycles )
+{
+    for( size_t i = 0; i < m_partitions.size(); i++ ){
+        ClockedResourceList& resources = m_partitions[i]->clockedResources;
+        ClockedResourceList::iterator end = resources.end();
+        for( ClockedResourceList::iterator r = resources.begin(); r != end; ++r ){
+            (*r)->SkipIdleCycles( cycles );
+        }
+    }
 
+    GlobalClock* globalClock = m_context->globalClock;
+    globalClock->SetTick( globalClock->GetTick() + cycles );
+    m_context->executedCycles += cycles;
 }
 
-void SimulationSystem::CycleBegin()
+// Returns whether the parallel simulation engine can be used.
+bool SimulationSystem::IsParallelSimulationEnabled()
 {
-    ClockedResourceList::iterator end = m_clockedResources.end();
-    for( ClockedResourceList::iterator i = m_clockedResources.begin(); i != end; ++i ){
-        (*i)->Begin();
+    if( m_context->parallelParam.hostThreads <= 1 ){
+        return false;
+    }
+
+#ifndef ONIKIRI_PARALLEL_SIMULATION
+    THROW_RUNTIME_ERROR( 
+        "'System/Parallel/@HostThreads' is more than 1, "
+        "but this simulator is not built with ONIKIRI_PARALLEL_SIMULATION." 
+    );
+    return false;
+#else
+    // Hooked methods and dumpers are not thread safe.
+    if( s_cycleBeginHook.IsAnyHookRegistered()   || 
+        s_cycleEvaluateHook.IsAnyHookRegistered() ||
+        s_cycleTransitionHook.IsAnyHookRegistered() ||
+        s_cycleUpdateHook.IsAnyHookRegistered() ||
+        s_cycleEndHook.IsAnyHookRegistered()
+    ){
+        RUNTIME_WARNING( "Parallel simulation is disabled because cycle hooks are registered." );
+        return false;
     }
+
+    if( g_dumper.IsEnabled() ){
+        RUNTIME_WARNING( "Parallel simulation is disabled because dumpers are enabled." );
+        return false;
+    }
+
+    return true;
+#endif
 }
 
-void SimulationSystem::CycleEvaluate()
+// Partition cores and caches for the parallel engine.
+// Cores that share first level caches are in the same partition, because 
+// they access the caches directly from their pipelines. A cache reached 
+// from a single partition is in that partition and the other caches are
+// in the last shared partition. Returns the number of partitions including
+// the shared partition, or 1 when there is no parallelism.
+int SimulationSystem::PartitionResources( vector<int>* corePartition, vector<int>* cachePartition )
 {
-    m_priorityEventList.ExtractEvent( &m_timeWheels );
+    PhysicalResourceArray<Core>&  core   = m_context->cores;
+    PhysicalResourceArray<Cache>& caches = m_context->caches;
+    int numCores = core.GetSize();
+
+    // Cores that reach each cache.
+    map< Cache*, vector<int> > reachingCores;
+    vector< vector<Cache*> > firstLevelCaches( numCores );
+    for( int i = 0; i < numCores; i++ ){
+        CacheSystem* cacheSystem = core[i]->GetCacheSystem();
+        if( !cacheSystem ){
+            continue;
+        }
 
-    m_priorityEventList.BeginEvaluate();
+        firstLevelCaches[i].push_back( cacheSystem->GetFirstLevelDataCache() );
+        firstLevelCaches[i].push_back( cacheSystem->GetFirstLevelInsnCache() );
+        for( size_t j = 0; j < firstLevelCaches[i].size(); j++ ){
+            for( Cache* cache = firstLevelCaches[i][j]; cache; cache = cache->GetNextCache() ){
+                vector<int>& cores = reachingCores[ cache ];
+                if( find( cores.begin(), cores.end(), i ) == cores.end() ){
+                    cores.push_back( i );
+                }
+            }
+        }
+    }
 
-    ClockedResourceList::iterator end = m_clockedResources.end();
-    for( ClockedResourceList::iterator i = m_clockedResources.begin(); i != end; ++i ){
-        ClockedResourceIF* res = *i;
-        m_priorityEventList.TriggerEvaluate( res->GetPriority() );
-        res->Evaluate();
+    // Merge groups of cores that share first level caches.
+    vector<int> group( numCores );
+    for( int i = 0; i < numCores; i++ ){
+        group[i] = i;
+    }
+    for( int i = 0; i < numCores; i++ ){
+        for( size_t j = 0; j < firstLevelCaches[i].size(); j++ ){
+            if( !firstLevelCaches[i][j] ){
+                continue;
+            }
+            const vector<int>& cores = reachingCores[ firstLevelCaches[i][j] ];
+            for( size_t k = 0; k < cores.size(); k++ ){
+                int from = group[ cores[k] ];
+                int to   = group[i];
+                for( int c = 0; c < numCores; c++ ){
+                    if( group[c] == from ){
+                        group[c] = to;
+                    }
+                }
+            }
+        }
+    }
+
+    // Number the groups.
+    map<int, int> partitionOfGroup;
+    for( int i = 0; i < numCores; i++ ){
+        if( partitionOfGroup.find( group[i] ) == partitionOfGroup.end() ){
+            int index = (int)partitionOfGroup.size();
+            partitionOfGroup[ group[i] ] = index;
+        }
+        (*corePartition)[i] = partitionOfGroup[ group[i] ];
+    }
+
+    int numCorePartitions = (int)partitionOfGroup.size();
+    if( numCorePartitions < 2 ){
+        fill( corePartition->begin(), corePartition->end(), 0 );
+        fill( cachePartition->begin(), cachePartition->end(), 0 );
+        return 1;
+    }
+
+    int sharedPartition = numCorePartitions;
+    for( int i = 0; i < caches.GetSize(); i++ ){
+        const vector<int>& cores = reachingCores[ caches[i] ];
+        int partition = sharedPartition;
+        for( size_t j = 0; j < cores.size(); j++ ){
+            int corePart = (*corePartition)[ cores[j] ];
+            if( j == 0 ){
+                partition = corePart;
+            }
+            else if( partition != corePart ){
+                partition = sharedPartition;
+                break;
+            }
+        }
+        (*cachePartition)[i] = partition;
     }
 
-    m_priorityEventList.EndEvaluate();
+    return numCorePartitions + 1;
 }
 
-void SimulationSystem::CycleTransition()
+void SimulationSystem::PartitionBegin( Partition* partition )
 {
-    ClockedResourceList::iterator end = m_clockedResources.end();
-    for( ClockedResourceList::iterator i = m_clockedResources.begin(); i != end; ++i ){
+    ClockedResourceList& resources = partition->clockedResources;
+    if( g_hostProfiler.IsEnabled() ){
+        for( size_t i = 0; i < resources.size(); i++ ){
+            u64 begin = ReadHostTimeStamp();
+            resources[i]->Begin();
+            g_hostProfiler.AddResourceTicks( 
+                partition->profileSlots[i], HostProfiler::PHASE_BEGIN, ReadHostTimeStamp() - begin 
+            );
+        }
+        return;
+    }
+
+    ClockedResourceList::iterator end = resources.end();
+    for( ClockedResourceList::iterator i = resources.begin(); i != end; ++i ){
+        (*i)->Begin();
+    }
+}
+
+void SimulationSystem::PartitionEvaluate( Partition* partition )
+{
+    PriorityEventList& priorityEventList = partition->priorityEventList;
+    priorityEventList.ExtractEvent( &partition->timeWheels );
+
+    priorityEventList.BeginEvaluate();
+
+    ClockedResourceList& resources = partition->clockedResources;
+    if( g_hostProfiler.IsEnabled() ){
+        for( size_t i = 0; i < resources.size(); i++ ){
+            ClockedResourceIF* res = resources[i];
+            priorityEventList.TriggerEvaluate( res->GetPriority() );
+            u64 begin = ReadHostTimeStamp();
+            res->Evaluate();
+            g_hostProfiler.AddResourceTicks( 
+                partition->profileSlots[i], HostProfiler::PHASE_EVALUATE, ReadHostTimeStamp() - begin 
+            );
+        }
+    }
+    else{
+        ClockedResourceList::iterator end = resources.end();
+        for( ClockedResourceList::iterator i = resources.begin(); i != end; ++i ){
+            ClockedResourceIF* res = *i;
+            priorityEventList.TriggerEvaluate( res->GetPriority() );
+            res->Evaluate();
+        }
+    }
+
+    priorityEventList.EndEvaluate();
+}
+
+void SimulationSystem::PartitionTransition( Partition* partition )
+{
+    ClockedResourceList& resources = partition->clockedResources;
+    if( g_hostProfiler.IsEnabled() ){
+        for( size_t i = 0; i < resources.size(); i++ ){
+            u64 begin = ReadHostTimeStamp();
+            resources[i]->Transition();
+            g_hostProfiler.AddResourceTicks( 
+                partition->profileSlots[i], HostProfiler::PHASE_TRANSITION, ReadHostTimeStamp() - begin 
+            );
+        }
+        return;
+    }
+
+    ClockedResourceList::iterator end = resources.end();
+    for( ClockedResourceList::iterator i = resources.begin(); i != end; ++i ){
         (*i)->Transition();
     }
 }
 
-void SimulationSystem::CycleUpdate()
+void SimulationSystem::PartitionUpdate( Partition* partition )
 {   
-    m_priorityEventList.BeginUpdate();
+    PriorityEventList& priorityEventList = partition->priorityEventList;
+    priorityEventList.BeginUpdate();
+
+    ClockedResourceList& resources = partition->clockedResources;
+    if( g_hostProfiler.IsEnabled() ){
+        for( size_t i = 0; i < resources.size(); i++ ){
+            ClockedResourceIF* res = resources[i];
+            priorityEventList.TriggerUpdate( res->GetPriority() );
+            u64 begin = ReadHostTimeStamp();
+            res->TriggerUpdate();
+            g_hostProfiler.AddResourceTicks( 
+                partition->profileSlots[i], HostProfiler::PHASE_UPDATE, ReadHostTimeStamp() - begin 
+            );
+        }
+    }
+    else{
+        ClockedResourceList::iterator end = resources.end();
+        for( ClockedResourceList::iterator i = resources.begin(); i != end; ++i ){
+            ClockedResourceIF* res = *i;
+            priorityEventList.TriggerUpdate( res->GetPriority() );
+            res->TriggerUpdate();
+        }
+    }
 
-    ClockedResourceList::iterator end = m_clockedResources.end();
-    for( ClockedResourceList::iterator i = m_clockedResources.begin(); i != end; ++i ){
-        ClockedResourceIF* res = *i;
-        m_priorityEventList.TriggerUpdate( res->GetPriority() );
-        res->TriggerUpdate();
+    priorityEventList.EndUpdate();
+}
+
+void SimulationSystem::PartitionEnd( Partition* partition )
+{
+    ClockedResourceList& resources = partition->clockedResources;
+    if( g_hostProfiler.IsEnabled() ){
+        for( size_t i = 0; i < resources.size(); i++ ){
+            u64 begin = ReadHostTimeStamp();
+            resources[i]->End();
+            g_hostProfiler.AddResourceTicks( 
+                partition->profileSlots[i], HostProfiler::PHASE_END, ReadHostTimeStamp() - begin 
+            );
+        }
+        return;
+    }
+
+    ClockedResourceList::iterator end = resources.end();
+    for( ClockedResourceList::iterator i = resources.begin(); i != end; ++i ){
+        (*i)->End();
+    }
+}
+
+void SimulationSystem::CycleBegin()
+{
+    for( size_t i = 0; i < m_partitions.size(); i++ ){
+        PartitionBegin( m_partitions[i] );
+    }
+}
+
+void SimulationSystem::CycleEvaluate()
+{
+    for( size_t i = 0; i < m_partitions.size(); i++ ){
+        PartitionEvaluate( m_partitions[i] );
+    }
+}
+
+void SimulationSystem::CycleTransition()
+{
+    for( size_t i = 0; i < m_partitions.size(); i++ ){
+        PartitionTransition( m_partitions[i] );
     }
+}
 
-    m_priorityEventList.EndUpdate();
+void SimulationSystem::CycleUpdate()
+{   
+    for( size_t i = 0; i < m_partitions.size(); i++ ){
+        PartitionUpdate( m_partitions[i] );
+    }
 }
 
 void SimulationSystem::CycleEnd()
 {
-    ClockedResourceList::iterator end = m_clockedResources.end();
-    for( ClockedResourceList::iterator i = m_clockedResources.begin(); i != end; ++i ){
-        (*i)->End();
+    for( size_t i = 0; i < m_partitions.size(); i++ ){
+        PartitionEnd( m_partitions[i] );
     }
 }
 
 void SimulationSystem::SimulateCycle()
 {
+    if( m_parallel ){
+        SimulateCycleParallel();
+        return;
+    }
+
     if( s_cycleBeginHook.IsAnyHookRegistered()   || 
         s_cycleEvaluateHook.IsAnyHookRegistered() ||
         s_cycleTransitionHook.IsAnyHookRegistered() ||
@@ -309,3 +703,44 @@ void SimulationSystem::SimulateCycle()
     }
 
 }
+
+// Simulate a cycle in the parallel engine.
+// The core partitions are simulated in parallel, and then the shared 
+// partition is simulated on this thread after all of them finish.
+void SimulationSystem::SimulateCycleParallel()
+{
+    int numCorePartitions = (int)m_partitions.size() - 1;
+
+    m_sharedCacheContext.parallelPhase = true;
+    m_threadPool.Run( m_partitionTask, numCorePartitions );
+    m_sharedCacheContext.parallelPhase = false;
+
+    // Invalidate lines in previous level caches deferred in the parallel phase.
+    vector< Cache::ParallelAccessContext::DeferredInvalidation >& invalidations = 
+        m_sharedCacheContext.deferredInvalidations;
+    for( size_t i = 0; i < invalidations.size(); i++ ){
+        if( invalidations[i].coherence ){
+            invalidations[i].cache->InvalidateByCoherence( invalidations[i].addr );
+        }
+        else{
+            invalidations[i].cache->Invalidate( invalidations[i].addr );
+        }
+    }
+    invalidations.clear();
+
+    SimulatePartitionCycle( m_partitions.back() );
+}
+
+void SimulationSystem::SimulatePartitionCycle( Partition* partition )
+{
+    PartitionBegin( partition );
+    PartitionEvaluate( partition );
+    PartitionTransition( partition );
+    PartitionUpdate( partition );
+    PartitionEnd( partition );
+}
+
+void SimulationSystem::PartitionTask::operator()( int index ) const
+{
+    system->SimulatePartitionCycle( system->m_partitions[ index ] );
+}
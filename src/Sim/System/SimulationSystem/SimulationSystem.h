@@ -36,6 +36,7 @@
 #include "Sim/Pipeline/Pipeline.h"
 #include "Sim/Memory/Cache/Cache.h"
 #include "Sim/Foundation/Event/PriorityEventList.h"
+#include "Utility/HostThreadPool.h"
 
 namespace Onikiri 
 {
@@ -44,6 +45,7 @@ namespace Onikiri
 
     public:
         SimulationSystem();
+        virtual ~SimulationSystem();
         void Run();
 
         // SystemIF
@@ -83,16 +85,42 @@ namespace Onikiri
         std::vector<MemoryResources> m_memResources;
 
         typedef std::vector<ClockedResourceIF*> ClockedResourceList;
-        ClockedResourceList m_clockedResources;
-
         typedef PriorityEventList::TimeWheelList TimeWheelList;
-        TimeWheelList m_timeWheels;
 
-        PriorityEventList m_priorityEventList;
+        // Clocked resources and time wheels simulated on the same host thread.
+        struct Partition
+        {
+            ClockedResourceList clockedResources;
+            TimeWheelList       timeWheels;
+            PriorityEventList   priorityEventList;
+            std::vector<int>    profileSlots;   // Slots of 'clockedResources' in the host profiler
+        };
+
+        // All resources are in one partition in the serial engine.
+        // In the parallel engine, each partition has cores that share first
+        // level caches, and the last partition has caches shared between 
+        // the other partitions. The core partitions are simulated in parallel 
+        // and the shared partition is simulated after them in each cycle.
+        std::vector<Partition*> m_partitions;
+        bool m_parallel;
+
+        struct PartitionTask
+        {
+            SimulationSystem* system;
+            void operator()( int index ) const;
+        };
+        HostThreadPool m_threadPool;
+        HostThreadPool::Task m_partitionTask;
+        Cache::ParallelAccessContext m_sharedCacheContext;
 
         bool m_reqTeminatation;
 
         void SimulateCycle();
+        void SimulateCycleParallel();
+        void SimulatePartitionCycle( Partition* partition );
+
+        s64  GetIdleCycles();
+        void SkipIdleCycles( s64 cycles );
 
         void CycleBegin();
         void CycleEvaluate();
@@ -101,8 +129,18 @@ namespace Onikiri
         void CycleUpdate();
         void CycleEnd();
 
+        void PartitionBegin( Partition* partition );
+        void PartitionEvaluate( Partition* partition );
+        void PartitionTransition( Partition* partition );
+        void PartitionUpdate( Partition* partition );
+        void PartitionEnd( Partition* partition );
+
         void InitializeResources();
         void InitializeResourcesBody();
+        void InitializeHostProfiler();
+
+        bool IsParallelSimulationEnabled();
+        int  PartitionResources( std::vector<int>* corePartition, std::vector<int>* cachePartition );
     };
 }; // namespace Onikiri
 
@@ -42,6 +42,7 @@ SystemBase::SystemContext::SystemContext()
 {
     executionCycles = 0;    
     executionInsns = 0;
+    skipIdleCycles = true;
     executedCycles = 0; 
     
     globalClock = 0;
@@ -68,6 +68,7 @@ namespace Onikiri
 
             s64 executionCycles;    
             s64 executionInsns;
+            bool skipIdleCycles;    // Skip cycles in which all resources are idle.
 
             s64 executedCycles; 
             std::vector<s64> executedInsns; // Executed insns in each thread.
@@ -92,6 +93,39 @@ namespace Onikiri
             };
             InorderParam inorderParam;
 
+            struct WarmupParam
+            {
+                bool enableBPred;
+                bool enableCache;
+            };
+            WarmupParam warmupParam;
+
+            struct SimPointParam
+            {
+                s64 intervalInsns;
+                s64 warmupInsns;
+                int maxK;
+                int dimensions;
+                int seed;
+                double bicThreshold;
+                String fileName;
+            };
+            SimPointParam simPointParam;
+
+            struct TraceParam
+            {
+                String format;
+                String fileName;
+                int blockInsns;
+            };
+            TraceParam traceParam;
+
+            struct ParallelParam
+            {
+                int hostThreads;
+            };
+            ParallelParam parallelParam;
+
             struct DebugParam
             {
                 int debugPort;
@@ -34,6 +34,7 @@
 #include "Sim/System/SystemManager.h"
 
 #include "Sim/Dumper/Dumper.h"
+#include "Sim/Foundation/Profiler/HostProfiler.h"
 #include "Emu/EmulatorFactory.h"
 
 #include "Sim/Pipeline/Fetcher/Fetcher.h"
@@ -43,13 +44,22 @@
 #include "Sim/Dependency/PhyReg/PhyReg.h"
 
 #include "Sim/System/EmulationSystem/EmulationSystem.h"
+#include "Sim/System/EmulationWarmupSystem/EmulationWarmupSystem.h"
 #include "Sim/System/InorderSystem/InorderSystem.h"
 #include "Sim/System/EmulationTraceSystem/EmulationTraceSystem.h"
 #include "Sim/System/SimulationSystem/SimulationSystem.h"
 #include "Sim/System/EmulationDebugSystem/EmulationDebugSystem.h"
+#include "Sim/System/SimPointSystem/SimPointSystem.h"
 #include "Sim/System/ForwardEmulator.h"
+#include "Sim/System/TraceEmulator/TraceEmulator.h"
 
 #include "Sim/Foundation/Hook/HookUtil.h"
+#include "Utility/CheckpointStream.h"
+
+#if defined(HOST_IS_LINUX) || defined(HOST_IS_CYGWIN)
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 
 namespace Onikiri
 {
@@ -62,10 +72,13 @@ using namespace Onikiri;
 SystemManager::SystemManager()
 {
     m_system = NULL;
+    m_traceEmulator = NULL;
     
     m_simulationCycles = 0;
     m_simulationInsns = 0;
     m_skipInsns = 0;
+    m_sweepProcesses = 1;
+    m_runSeconds = 0.0;
 }
 
 SystemManager::~SystemManager()
@@ -88,6 +101,7 @@ void SystemManager::Initialize()
 void SystemManager::Finalize()
 {
     g_dumper.Finalize();
+    g_hostProfiler.Finalize();
 
     m_context.emulatorWrapper.ReleaseParam();
     ReleaseParam();
@@ -95,6 +109,7 @@ void SystemManager::Finalize()
     if( m_context.emulator ){
         delete m_context.emulator;
         m_context.emulator = NULL;
+        m_traceEmulator = NULL;
     }
     if( m_context.resBuilder ){
         delete m_context.resBuilder;
@@ -116,9 +131,34 @@ void SystemManager::InitializeEmulator()
         );
     }
 
-    // Set the emulator
-    EmulatorFactory emulatorFactory;
-    m_context.emulator = emulatorFactory.Create( m_context.targetArchitecture, this );
+    // When 'TraceFile' is set in the process configurations, op traces are 
+    // replayed instead of executing the processes in an emulator.
+    std::vector<String> traceFiles;
+    for( int i = 0; i < processConfigCount; i++ ){
+        ParamXMLPath path;
+        path.AddArray( "/Session/Emulator/Processes/Process", i );
+        path.AddAttribute( "TraceFile" );
+        String traceFile;
+        g_paramDB.Get( path, &traceFile, false );
+        traceFiles.push_back( traceFile );
+    }
+    size_t traceFileCount = 
+        traceFiles.size() - std::count( traceFiles.begin(), traceFiles.end(), String("") );
+
+    if( traceFileCount > 0 ){
+        if( traceFileCount != traceFiles.size() ){
+            THROW_RUNTIME_ERROR( "'TraceFile' must be set in all or none of the 'Process' nodes." );
+        }
+        for( size_t i = 0; i < traceFiles.size(); i++ ){
+            traceFiles[i] = g_env.GetHostWorkPath() + traceFiles[i];
+        }
+        m_traceEmulator = new TraceEmulator( m_context.targetArchitecture, traceFiles );
+        m_context.emulator = m_traceEmulator;
+    }
+    else{
+        EmulatorFactory emulatorFactory;
+        m_context.emulator = emulatorFactory.Create( m_context.targetArchitecture, this );
+    }
     m_context.emulator->SetExtraOpDecoder( &m_extraOpDecoder );
     SimISAInfo::TestISAInfo( m_context.emulator->GetISAInfo() );
 
@@ -160,7 +200,12 @@ void SystemManager::InitializeResources()
 
     InitializeSimulationContext();
 
-    g_dumper.Initialize( m_context.cores, m_context.threads );
+    // In 'Sweep' mode, dumpers are opened only in the forked processes,
+    // each of which writes files with the name of its configuration.
+    if( m_context.mode != "Sweep" || m_sweepConfiguration != "" ){
+        g_dumper.Initialize( m_context.cores, m_context.threads, m_sweepConfiguration );
+    }
+    g_hostProfiler.Initialize();
 
     g_env.PrintInternal("initialized.\n");
 }
@@ -240,6 +285,11 @@ bool SystemManager::SetSimulationContext( const ArchitectureStateList& archState
             m_context.threads[pid]->InitializeContext( pc );
             m_context.threads[pid]->Activate( true );
 
+            // Ops fetched from here are matched with the trace from the current position.
+            if( m_traceEmulator ){
+                m_traceEmulator->SetRetireIDBase( pid, m_context.threads[pid]->GetOpRetiredID() );
+            }
+
             RegDepPredIF* regDepPred = m_context.threads[pid]->GetRegDepPred();
             RegisterFile* regFile    = m_context.threads[pid]->GetCore()->GetRegisterFile();
 
@@ -285,6 +335,15 @@ void SystemManager::RunEmulation( SystemContext* context )
     emulationSystem.Run();
 }
 
+void SystemManager::RunEmulationWarmup( SystemContext* context )
+{
+    EmulationWarmupSystem emulationWarmupSystem;
+    SystemAttacher attacher(this, &emulationWarmupSystem);
+    NotifyChangingMode(PhysicalResourceNode::SM_EMULATION);
+    emulationWarmupSystem.SetSystemContext(context);
+    emulationWarmupSystem.Run();
+}
+
 void SystemManager::RunEmulationTrace( SystemContext* context )
 {
     EmulationTraceSystem emulationTraceSystem;
@@ -305,6 +364,15 @@ void SystemManager::RunEmulationDebug( SystemContext* context )
 
 void SystemManager::RunInorder( SystemContext* context )
 {
+    // InorderSystem numbers the ops of all the processes with a single 
+    // counter from 0, so they cannot be matched with the traces of the processes.
+    if( m_traceEmulator ){
+        if( m_traceEmulator->GetProcessCount() > 1 ){
+            THROW_RUNTIME_ERROR( "Inorder execution of multiple op traces is not supported." );
+        }
+        m_traceEmulator->SetRetireIDBase( 0, 0 );
+    }
+
     InorderSystem inorderSystem;
     SystemAttacher attacher(this, &inorderSystem);
     NotifyChangingMode(PhysicalResourceNode::SM_INORDER);
@@ -312,6 +380,332 @@ void SystemManager::RunInorder( SystemContext* context )
     inorderSystem.Run();
 }
 
+// When '@RestoreCheckpoint' is set, the skip phase starts from the checkpoint
+// and '@SkipInsns' instructions are executed from there (e.g. for warming up).
+// When '@SaveCheckpoint' is set, the state after the skip phase is saved.
+void SystemManager::RunSkip( SkipRunner runSkip )
+{
+    int processCount = m_context.emulator->GetProcessCount();
+    std::vector<s64> restoredInsns( processCount, 0 );
+    bool restored = m_restoreCheckpoint != "";
+    if( restored ){
+        RestoreCheckpoint( m_restoreCheckpoint, &restoredInsns );
+    }
+
+    m_context.executionInsns  = m_skipInsns;
+    m_context.executionCycles = 0;
+    if( !restored || m_skipInsns > 0 ){
+        (this->*runSkip)( &m_context );
+        m_skippedInsns = m_context.executedInsns;
+    }
+    else{
+        m_skippedInsns.clear();
+    }
+
+    m_skippedInsns.resize( std::max( m_skippedInsns.size(), restoredInsns.size() ), 0 );
+    for( size_t i = 0; i < restoredInsns.size(); i++ ){
+        m_skippedInsns[i] += restoredInsns[i];
+    }
+
+    if( m_saveCheckpoint != "" ){
+        SaveCheckpoint( m_saveCheckpoint );
+    }
+}
+
+// Checkpoint format version
+static const char CHECKPOINT_SIGNATURE[] = "OnikiriCheckpoint";
+static const u32  CHECKPOINT_VERSION = 2;
+
+void SystemManager::SaveCheckpoint( const String& fileName )
+{
+    g_env.PrintInternal( "Saving a checkpoint ... " );
+
+    String path = g_env.GetHostWorkPath() + fileName;
+    boost::iostreams::file_sink file( path, std::ios::binary );
+    if( !file.is_open() ){
+        THROW_RUNTIME_ERROR( "Could not open '%s'.", path.c_str() );
+    }
+    boost::iostreams::filtering_ostream stream;
+    stream.push( boost::iostreams::gzip_compressor() );
+    stream.push( file );
+    WriteCheckpoint( &stream );
+
+    g_env.PrintInternal( "saved to '%s'.\n", path.c_str() );
+}
+
+void SystemManager::RestoreCheckpoint( const String& fileName, std::vector<s64>* skippedInsns )
+{
+    g_env.PrintInternal( "Restoring a checkpoint ... " );
+
+    String path = g_env.GetHostWorkPath() + fileName;
+    boost::iostreams::file_source file( path, std::ios::binary );
+    if( !file.is_open() ){
+        THROW_RUNTIME_ERROR( "Could not open '%s'.", path.c_str() );
+    }
+    boost::iostreams::filtering_istream stream;
+    stream.push( boost::iostreams::gzip_decompressor() );
+    stream.push( file );
+    ReadCheckpoint( &stream, path, skippedInsns );
+
+    g_env.PrintInternal( "restored from '%s'.\n", path.c_str() );
+}
+
+void SystemManager::WriteCheckpoint( std::ostream* stream )
+{
+    CheckpointWriter writer( stream );
+    writer.WriteString( CHECKPOINT_SIGNATURE );
+    writer.Write( CHECKPOINT_VERSION );
+    writer.WriteString( m_context.targetArchitecture );
+
+    int processCount = m_context.emulator->GetProcessCount();
+    writer.Write( processCount );
+    for( int pid = 0; pid < processCount; pid++ ){
+        const ArchitectureState& state = m_context.architectureStateList[pid];
+        writer.Write( (size_t)pid < m_skippedInsns.size() ? m_skippedInsns[pid] : (s64)0 );
+        writer.Write( state.pc.pid );
+        writer.Write( state.pc.tid );
+        writer.Write( state.pc.address );
+        writer.Write( state.microOpIndex );
+        writer.WriteVector( state.registerValue );
+        m_context.emulator->SaveProcessState( pid, &writer );
+    }
+}
+
+void SystemManager::ReadCheckpoint( std::istream* stream, const String& path, std::vector<s64>* skippedInsns )
+{
+    CheckpointReader reader( stream );
+    if( reader.ReadString() != CHECKPOINT_SIGNATURE || reader.Read<u32>() != CHECKPOINT_VERSION ){
+        THROW_RUNTIME_ERROR( "'%s' is not a checkpoint file or its version is not supported.", path.c_str() );
+    }
+    String arch = reader.ReadString();
+    if( arch != m_context.targetArchitecture ){
+        THROW_RUNTIME_ERROR( 
+            "The checkpoint '%s' is created for '%s', but the target architecture is '%s'.", 
+            path.c_str(), arch.c_str(), m_context.targetArchitecture.c_str()
+        );
+    }
+
+    int processCount = m_context.emulator->GetProcessCount();
+    if( reader.Read<int>() != processCount ){
+        THROW_RUNTIME_ERROR( "The number of the processes in the checkpoint '%s' does not match.", path.c_str() );
+    }
+
+    int logicalRegCount = m_context.emulator->GetISAInfo()->GetRegisterCount();
+    skippedInsns->assign( processCount, 0 );
+    for( int pid = 0; pid < processCount; pid++ ){
+        ArchitectureState& state = m_context.architectureStateList[pid];
+        (*skippedInsns)[pid] = reader.Read<s64>();
+        state.pc.pid = reader.Read<int>();
+        state.pc.tid = reader.Read<int>();
+        state.pc.address = reader.Read<u64>();
+        state.microOpIndex = reader.Read<int>();
+        reader.ReadVector( &state.registerValue );
+        if( (int)state.registerValue.size() != logicalRegCount ){
+            THROW_RUNTIME_ERROR( "The number of the registers in the checkpoint '%s' does not match.", path.c_str() );
+        }
+        m_context.emulator->RestoreProcessState( pid, &reader );
+    }
+}
+
+// Profile the whole execution and then create a checkpoint for each simulation point.
+// The initial state is kept in memory and restored after profiling, and the execution 
+// is replayed from it to the simulation points in order.
+// A checkpoint is taken '@WarmupInsns' instructions before its simulation point,
+// so the skipped instructions can be used for warming with '@SkipInsns'.
+void SystemManager::RunSimPointProfile( SystemContext* context )
+{
+    std::stringstream initialState( std::ios::in | std::ios::out | std::ios::binary );
+    m_skippedInsns.clear();
+    WriteCheckpoint( &initialState );
+
+    std::vector<SimPointSystem::SimPoint> simPoints;
+    {
+        SimPointSystem simPointSystem;
+        SystemAttacher attacher(this, &simPointSystem);
+        NotifyChangingMode(PhysicalResourceNode::SM_EMULATION);
+        simPointSystem.SetSystemContext(context);
+        simPointSystem.Run();
+        simPoints = simPointSystem.GetSimPoints();
+    }
+    std::vector<s64> profiledInsns = context->executedInsns;
+
+    std::vector<s64> restoredInsns;
+    ReadCheckpoint( &initialState, "(initial state)", &restoredInsns );
+
+    const SystemContext::SimPointParam& param = context->simPointParam;
+    s64 currentInsns = 0;
+    m_simPointIntervals.clear();
+    m_simPointWeights.clear();
+    for( size_t i = 0; i < simPoints.size(); i++ ){
+        s64 start = std::max( simPoints[i].interval * param.intervalInsns - param.warmupInsns, (s64)0 );
+
+        context->executionInsns  = start - currentInsns;
+        context->executionCycles = 0;
+        RunEmulation( context );
+        currentInsns += context->executedInsns[0];
+        m_skippedInsns.assign( 1, currentInsns );
+
+        String fileName;
+        fileName.format( "%s.%d.ckpt", param.fileName.c_str(), (int)i );
+        SaveCheckpoint( fileName );
+
+        m_simPointIntervals.push_back( simPoints[i].interval );
+        m_simPointWeights.push_back( simPoints[i].weight );
+    }
+
+    context->executedInsns  = profiledInsns;
+    context->executedCycles = 0;
+}
+
+// Load configurations from '/Session/Simulator/System/Sweep/Configuration'.
+// Each configuration has parameter expressions in 'Parameter/@Expression', and 
+// its result is written to the result XML file with '.<Name>' before the extension.
+void SystemManager::LoadSweepConfigurations( std::vector<SweepConfiguration>* configs )
+{
+    const ParamXMLPath basePath = "/Session/Simulator/System/Sweep/";
+    int configCount = 0;
+    g_paramDB.Get( basePath + "#Configuration", &configCount, false );
+
+    configs->clear();
+    for( int i = 0; i < configCount; i++ ){
+        ParamXMLPath configPath;
+        configPath.SetArray( basePath, "Configuration", i );
+
+        SweepConfiguration config;
+        if( !g_paramDB.Get( configPath + "@Name", &config.name, false ) || config.name == "" ){
+            config.name.format( "%d", i );
+        }
+
+        int paramCount = 0;
+        g_paramDB.Get( configPath + "#Parameter", &paramCount, false );
+        for( int j = 0; j < paramCount; j++ ){
+            ParamXMLPath paramPath;
+            paramPath.SetArray( configPath, "Parameter", j );
+            String expression;
+            g_paramDB.Get( paramPath + "@Expression", &expression );
+            config.parameters.push_back( expression );
+        }
+
+        String fileName = g_env.GetOutputXMLFileName();
+        if( fileName != "" ){
+            size_t ext = fileName.rfind( '.' );
+            size_t dir = fileName.find_last_of( "/\\" );
+            if( ext == String::npos || ( dir != String::npos && ext < dir ) ){
+                ext = fileName.size();
+            }
+            fileName.insert( ext, "." + config.name );
+        }
+        config.outputXMLFileName = fileName;
+
+        configs->push_back( config );
+    }
+}
+
+// Run the skip phase once and simulate each configuration from its result.
+// Each configuration is simulated in a forked process, so the post-skip
+// architecture state and the memory image of the emulator are shared 
+// without re-loading and re-executing the program. A forked process rebuilds 
+// the resources with its parameters and finishes as a usual session, 
+// which writes its own result XML.
+void SystemManager::RunSweep()
+{
+    std::vector<SweepConfiguration> configs;
+    LoadSweepConfigurations( &configs );
+    if( configs.empty() ){
+        THROW_RUNTIME_ERROR( "No '/Session/Simulator/System/Sweep/Configuration' node is found in 'Sweep' mode." );
+    }
+
+#if defined(HOST_IS_LINUX) || defined(HOST_IS_CYGWIN)
+    // Run emulation
+    RunSkip( &SystemManager::RunEmulation );
+
+    int maxProcesses = m_sweepProcesses;
+    if( maxProcesses <= 0 ){
+        maxProcesses = std::max( (int)std::thread::hardware_concurrency(), 1 );
+    }
+
+    std::map<pid_t, String> running;
+    size_t next = 0;
+    while( next < configs.size() || !running.empty() ){
+        if( next < configs.size() && (int)running.size() < maxProcesses ){
+            const SweepConfiguration& config = configs[next];
+            next++;
+
+            g_env.PrintInternal( "Sweep configuration '%s' ... started.\n", config.name.c_str() );
+            g_env.FlushPrint();
+
+            pid_t pid = fork();
+            if( pid < 0 ){
+                THROW_RUNTIME_ERROR( "Could not fork a process for the configuration '%s'.", config.name.c_str() );
+            }
+            if( pid == 0 ){
+                RunSweepConfiguration( config );
+                return;
+            }
+            running[pid] = config.name;
+            continue;
+        }
+
+        int status = 0;
+        pid_t pid = waitpid( -1, &status, 0 );
+        if( pid < 0 ){
+            THROW_RUNTIME_ERROR( "Waiting sweep processes failed." );
+        }
+        std::map<pid_t, String>::iterator i = running.find( pid );
+        if( i == running.end() ){
+            continue;
+        }
+        if( WIFEXITED( status ) && WEXITSTATUS( status ) == 0 ){
+            g_env.PrintInternal( "Sweep configuration '%s' ... finished.\n", i->second.c_str() );
+        }
+        else{
+            RUNTIME_WARNING( "The process for the sweep configuration '%s' terminated abnormally.", i->second.c_str() );
+        }
+        running.erase( i );
+    }
+
+    m_context.executedInsns.clear();
+    m_context.executedCycles = 0;
+#else
+    THROW_RUNTIME_ERROR( "'Sweep' mode requires fork() and is not supported on this host." );
+#endif
+}
+
+// Simulate a sweep configuration in a forked process.
+void SystemManager::RunSweepConfiguration( const SweepConfiguration& config )
+{
+    g_env.BeginForkedSession( config.outputXMLFileName );
+
+    // Opened files of the processes share their offsets with the parent and
+    // the other forked processes until they are reopened.
+    m_context.emulator->ReopenHostFiles();
+
+    // Release the resources used in the skip phase before applying the parameters,
+    // because their parameters are written back to the parameter DB on releasing.
+    // No dumper is opened in the skip phase, so this only drops the stat counters
+    // of the released resources.
+    g_dumper.Finalize();
+    g_hostProfiler.Finalize();
+    delete m_context.resBuilder;
+    m_context.resBuilder = new ResourceBuilder();
+
+    for( size_t i = 0; i < config.parameters.size(); i++ ){
+        g_paramDB.AddParameter( config.parameters[i] );
+    }
+    LoadParam();    // '@SimulationInsns' and so on may be changed by the configuration.
+    m_sweepConfiguration = config.name;
+    InitializeResources();
+
+    // Run simulation
+    m_context.executionInsns  = m_simulationInsns;
+    m_context.executionCycles = m_simulationCycles;
+    m_context.executedInsns.clear();
+    m_context.executedCycles = 0;
+    if( SetSimulationContext( m_context.architectureStateList ) ){
+        RunSimulation( &m_context );
+    }
+}
+
 void SystemManager::SetSystem( SystemIF* system )
 {
     m_system = system;
@@ -365,6 +759,7 @@ void SystemManager::Main()
 void SystemManager::Run()
 {
     const String& mode = m_context.mode;
+    std::chrono::steady_clock::time_point beginTime = std::chrono::steady_clock::now();
 
     m_context.executionInsns  = m_simulationInsns;
     m_context.executionCycles = m_simulationCycles;
@@ -389,10 +784,7 @@ void SystemManager::Run()
     }
     else if( mode == "Inorder" ) {
         // Run emulation
-        m_context.executionInsns  = m_skipInsns;
-        m_context.executionCycles = 0;
-        RunEmulation( &m_context );
-        m_skippedInsns = m_context.executedInsns;
+        RunSkip( &SystemManager::RunEmulation );
 
         // Run inorder
         m_context.executionInsns  = m_simulationInsns;
@@ -405,10 +797,7 @@ void SystemManager::Run()
     }
     else if( mode == "SkipByInorder" ) {
         // Run inorder
-        m_context.executionInsns  = m_skipInsns;
-        m_context.executionCycles = 0;
-        RunInorder( &m_context );
-        m_skippedInsns = m_context.executedInsns;
+        RunSkip( &SystemManager::RunInorder );
 
         // Run simulation
         m_context.executionInsns  = m_simulationInsns;
@@ -422,10 +811,7 @@ void SystemManager::Run()
     else if( mode == "Simulation" ){
 
         // Run emulation
-        m_context.executionInsns  = m_skipInsns;
-        m_context.executionCycles = 0;
-        RunEmulation( &m_context );
-        m_skippedInsns = m_context.executedInsns;
+        RunSkip( &SystemManager::RunEmulation );
 
         // Run simulation
         m_context.executionInsns  = m_simulationInsns;
@@ -436,12 +822,45 @@ void SystemManager::Run()
             RunSimulation( &m_context );
         }
     }
+    else if( mode == "SkipWithWarmup" ){
+
+        // Run emulation with warming caches/predictors up
+        RunSkip( &SystemManager::RunEmulationWarmup );
+
+        // Run simulation
+        m_context.executionInsns  = m_simulationInsns;
+        m_context.executionCycles = m_simulationCycles;
+        m_context.executedInsns.clear();
+        m_context.executedCycles = 0;
+        if( SetSimulationContext( m_context.architectureStateList ) ){
+            RunSimulation( &m_context );
+        }
+    }
+    else if( mode == "CreateCheckpoint" ){
+        if( m_saveCheckpoint == "" ){
+            THROW_RUNTIME_ERROR( "'@SaveCheckpoint' must be set in 'CreateCheckpoint' mode." );
+        }
+
+        // Run emulation and save its result
+        RunSkip( &SystemManager::RunEmulation );
+        m_context.executedInsns.clear();
+        m_context.executedCycles = 0;
+    }
+    else if( mode == "SimPointProfile" ){
+        if( m_context.executionInsns == 0 ){
+            RUNTIME_WARNING( "'@SimulationInsns' is 0 and nothing is executed in 'SimPointProfile' mode." );
+        }
+        RunSimPointProfile( &m_context );
+    }
+    else if( mode == "Sweep" ){
+        RunSweep();
+    }
     else{
         THROW_RUNTIME_ERROR(
             "An unknown simulation mode is specified in the"
             "'/Session/System/@Mode'\n"
             "This parameter must be one of the following strings : \n"
-            "[Emulation, Simulation, Inorder, CreateEmulationTrace, SkipByInorder]"
+            "[Emulation, Simulation, Inorder, CreateEmulationTrace, SkipByInorder, SkipWithWarmup, CreateCheckpoint, SimPointProfile, Sweep]"
         );
     }
 
@@ -457,6 +876,8 @@ void SystemManager::Run()
         }
     }
 
+    m_runSeconds = 
+        std::chrono::duration<double>( std::chrono::steady_clock::now() - beginTime ).count();
 }
 
 // SystemIF
@@ -37,6 +37,8 @@
 
 namespace Onikiri
 {
+    class TraceEmulator;
+
     class SystemManager : 
         public SystemManagerIF, SystemIF,
         public ParamExchange
@@ -105,9 +107,26 @@ namespace Onikiri
                 PARAM_ENTRY("System/@SimulationCycles", m_simulationCycles)
                 PARAM_ENTRY("System/@SimulationInsns",  m_simulationInsns)
                 PARAM_ENTRY("System/@SkipInsns",        m_skipInsns)
+                PARAM_ENTRY("System/@SaveCheckpoint",   m_saveCheckpoint)
+                PARAM_ENTRY("System/@RestoreCheckpoint",    m_restoreCheckpoint)
+                PARAM_ENTRY("System/@SkipIdleCycles",   m_context.skipIdleCycles)
                 PARAM_ENTRY("System/Inorder/@EnableBPred",      m_context.inorderParam.enableBPred  )
                 PARAM_ENTRY("System/Inorder/@EnableHMPred", m_context.inorderParam.enableHMPred )
                 PARAM_ENTRY("System/Inorder/@EnableCache",      m_context.inorderParam.enableCache  )
+                PARAM_ENTRY("System/Warmup/@EnableBPred",       m_context.warmupParam.enableBPred  )
+                PARAM_ENTRY("System/Warmup/@EnableCache",       m_context.warmupParam.enableCache  )
+                PARAM_ENTRY("System/SimPoint/@IntervalInsns",   m_context.simPointParam.intervalInsns )
+                PARAM_ENTRY("System/SimPoint/@WarmupInsns",     m_context.simPointParam.warmupInsns )
+                PARAM_ENTRY("System/SimPoint/@MaxK",            m_context.simPointParam.maxK )
+                PARAM_ENTRY("System/SimPoint/@Dimensions",      m_context.simPointParam.dimensions )
+                PARAM_ENTRY("System/SimPoint/@Seed",            m_context.simPointParam.seed )
+                PARAM_ENTRY("System/SimPoint/@BICThreshold",    m_context.simPointParam.bicThreshold )
+                PARAM_ENTRY("System/SimPoint/@FileName",        m_context.simPointParam.fileName )
+                PARAM_ENTRY("System/EmulationTrace/@Format",    m_context.traceParam.format )
+                PARAM_ENTRY("System/EmulationTrace/@FileName",  m_context.traceParam.fileName )
+                PARAM_ENTRY("System/EmulationTrace/@BlockInsns",    m_context.traceParam.blockInsns )
+                PARAM_ENTRY("System/Parallel/@HostThreads",     m_context.parallelParam.hostThreads )
+                PARAM_ENTRY("System/Sweep/@Processes",          m_sweepProcesses )
                 PARAM_ENTRY("System/Debug/@DebugPort",  m_context.debugParam.debugPort  )
             END_PARAM_PATH()
             BEGIN_PARAM_PATH( "Result/" )
@@ -115,7 +134,11 @@ namespace Onikiri
                 PARAM_ENTRY("System/@ExecutedInsns",    m_executedInsns)
                 PARAM_ENTRY("System/@SkippedInsns",     m_skippedInsns)
                 PARAM_ENTRY("System/@IPC",              m_ipc)
+                PARAM_ENTRY("System/@RunSeconds",       m_runSeconds)
                 PARAM_ENTRY("System/@ProcessMemoryUsage",   m_processMemoryUsage)
+                PARAM_ENTRY("System/SimPoint/@Intervals",   m_simPointIntervals)
+                PARAM_ENTRY("System/SimPoint/@Weights",     m_simPointWeights)
+                PARAM_ENTRY("System/Sweep/@Configuration",  m_sweepConfiguration)
             END_PARAM_PATH()
         END_PARAM_MAP()
 
@@ -125,6 +148,7 @@ namespace Onikiri
 
         SystemContext m_context;
         SystemIF*     m_system;
+        TraceEmulator* m_traceEmulator; // The emulator that replays op traces, or NULL
 
         s64 m_simulationCycles; // simulation を行うサイクル数
         s64 m_executedCycles;   // 実際に実行されたサイクル数
@@ -132,11 +156,28 @@ namespace Onikiri
         s64 m_simulationInsns;  // simulation を行う命令数
         s64 m_skipInsns;        // はじめにskipする命令数
 
+        String m_saveCheckpoint;    // A checkpoint file written after the skip phase
+        String m_restoreCheckpoint; // A checkpoint file from which the skip phase starts
+
         std::vector<s64> m_executedInsns;   // 実際に実行された命令数
         std::vector<s64> m_skippedInsns;    // 実際にスキップ実行されたサイクル数
 
         std::vector<double> m_ipc;          // ipc
+        double m_runSeconds;    // Host wall time of Run(), which excludes initialization and finalization
         std::vector<u64> m_processMemoryUsage;  // プロセス毎のメモリ使用量
+        std::vector<s64> m_simPointIntervals;   // Intervals chosen as simulation points
+        std::vector<double> m_simPointWeights;  // Weights of the simulation points
+
+        int    m_sweepProcesses;        // The maximum number of sweep processes running at once
+        String m_sweepConfiguration;    // The name of a configuration simulated in this process
+
+        // A machine configuration simulated from the post-skip state in 'Sweep' mode
+        struct SweepConfiguration
+        {
+            String name;
+            String outputXMLFileName;
+            std::vector<String> parameters; // Parameter expressions as those of '-x'
+        };
         ExtraOpDecoder m_extraOpDecoder;
 
         virtual void InitializeEmulator();
@@ -152,9 +193,24 @@ namespace Onikiri
 
         virtual void RunSimulation( SystemContext* context );
         virtual void RunEmulation( SystemContext* context );
+        virtual void RunEmulationWarmup( SystemContext* context );
         virtual void RunEmulationTrace( SystemContext* context );
         virtual void RunEmulationDebug( SystemContext* context );
         virtual void RunInorder( SystemContext* context );
+        virtual void RunSimPointProfile( SystemContext* context );
+
+        // Run the skip phase once and simulate each sweep configuration from its result.
+        virtual void RunSweep();
+        virtual void RunSweepConfiguration( const SweepConfiguration& config );
+        virtual void LoadSweepConfigurations( std::vector<SweepConfiguration>* configs );
+
+        // Run the skip phase with 'runSkip' and save/restore a checkpoint around it.
+        typedef void (SystemManager::*SkipRunner)( SystemContext* context );
+        virtual void RunSkip( SkipRunner runSkip );
+        virtual void SaveCheckpoint( const String& fileName );
+        virtual void RestoreCheckpoint( const String& fileName, std::vector<s64>* skippedInsns );
+        virtual void WriteCheckpoint( std::ostream* stream );
+        virtual void ReadCheckpoint( std::istream* stream, const String& path, std::vector<s64>* skippedInsns );
 
         virtual void NotifyProcessTerminationBody( ProcessNotifyParam* );
         virtual void NotifySyscallReadFileToMemoryBody( ProcessNotifyParam* );
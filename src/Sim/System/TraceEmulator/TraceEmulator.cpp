@@ -0,0 +1,533 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+#include <pch.h>
+
+#include "Sim/System/TraceEmulator/TraceEmulator.h"
+#include "Emu/EmulatorFactory.h"
+#include "Utility/CheckpointStream.h"
+
+using namespace std;
+using namespace boost;
+using namespace Onikiri;
+
+
+//
+// TraceOpInfo
+//
+TraceOpInfo::TraceOpInfo( const OpTraceRecord& record ) :
+    m_opClass( record.opClassCode ),
+    m_srcNum( record.srcNum ),
+    m_dstNum( record.dstNum ),
+    m_microOpNum( record.microOpNum ),
+    m_microOpIndex( record.microOpIndex ),
+    m_branchTargetKnown( false ),
+    m_branchTarget( 0 ),
+    m_memAccessKnown( false ),
+    m_memAddress( 0 ),
+    m_memSize( 0 )
+{
+    for( int i = 0; i < m_srcNum; i++ ){
+        m_srcOperand[i] = record.srcOperand[i];
+    }
+    for( int i = 0; i < m_dstNum; i++ ){
+        m_dstOperand[i] = record.dstOperand[i];
+    }
+}
+
+void TraceOpInfo::Observe( const OpTraceRecord& record )
+{
+    if( record.taken ){
+        m_branchTargetKnown = true;
+        m_branchTarget = record.takenPC.address;
+    }
+    if( record.memAccessed ){
+        m_memAccessKnown = true;
+        m_memAddress = record.memAccess.address.address;
+        m_memSize    = record.memAccess.size;
+    }
+}
+
+const char* TraceOpInfo::GetMnemonic() const
+{
+    return OpClassCode::ToString( m_opClass.GetCode() );
+}
+
+
+//
+// TraceEmulator
+//
+TraceEmulator::TraceEmulator( const String& targetArchitecture, const vector<String>& traceFiles ) :
+    m_isaInfo( NULL ),
+    m_reqSkipTermination( false )
+{
+    EmulatorFactory emulatorFactory;
+    m_isaInfo = emulatorFactory.CreateISAInfo( targetArchitecture );
+
+    for( size_t pid = 0; pid < traceFiles.size(); pid++ ){
+        OpenTrace( (int)pid, traceFiles[pid], targetArchitecture );
+    }
+}
+
+TraceEmulator::~TraceEmulator()
+{
+    m_processes.clear();
+    if( m_isaInfo ){
+        delete m_isaInfo;
+        m_isaInfo = NULL;
+    }
+}
+
+// Open a trace and build a static op table by scanning the whole trace.
+void TraceEmulator::OpenTrace( int pid, const String& fileName, const String& targetArchitecture )
+{
+    boost::shared_ptr<ProcessTrace> process( new ProcessTrace() );
+    process->fileName = fileName;
+    process->reader.Open( fileName );
+
+    const OpTraceHeader& header = process->reader.GetHeader();
+    if( header.targetArchitecture != targetArchitecture ){
+        THROW_RUNTIME_ERROR(
+            "The op trace '%s' is for '%s', but the target architecture is '%s'.",
+            fileName.c_str(),
+            header.targetArchitecture.c_str(),
+            targetArchitecture.c_str()
+        );
+    }
+    if( (int)header.initialRegisterValue.size() != m_isaInfo->GetRegisterCount() ){
+        THROW_RUNTIME_ERROR( "The number of the registers in the op trace '%s' is incorrect.", fileName.c_str() );
+    }
+
+    process->entryPoint = PC( pid, pid, 0 );
+    process->opCount = 0;
+
+    OpTraceRecord record;
+    while( process->reader.Read( &record ) ){
+        if( process->opCount == 0 ){
+            process->entryPoint.address = record.pc.address;
+        }
+        process->opCount++;
+
+        OpInfoArray& ops = process->opInfoMap[ record.pc.address ];
+        if( ops.empty() ){
+            ops.resize( record.microOpNum, NULL );
+        }
+        if( record.microOpIndex >= (int)ops.size() ){
+            THROW_RUNTIME_ERROR( 
+                "The op trace '%s' has inconsistent micro ops at '%08x%08x'.", 
+                fileName.c_str(),
+                (u32)(record.pc.address >> 32),
+                (u32)(record.pc.address & 0xffffffff)
+            );
+        }
+
+        OpInfo*& opInfo = ops[ record.microOpIndex ];
+        if( !opInfo ){
+            opInfo = m_opInfoPool.construct( record );
+        }
+        static_cast<TraceOpInfo*>( opInfo )->Observe( record );
+    }
+
+    process->reader.SeekInsn( 0 );
+    process->windowBase   = 0;
+    process->position     = 0;
+    process->insnPosition = 0;
+    process->inorderNext  = 0;
+    process->retireIDBase = 0;
+
+    m_processes.push_back( process );
+}
+
+TraceEmulator::ProcessTrace* TraceEmulator::GetProcess( int pid ) const
+{
+    ASSERT( pid >= 0 && (size_t)pid < m_processes.size(), "Invalid pid '%d'.", pid );
+    return m_processes[pid].get();
+}
+
+const OpTraceRecord* TraceEmulator::GetRecord( ProcessTrace* process, s64 index )
+{
+    if( index < process->windowBase || index >= process->opCount ){
+        return NULL;
+    }
+
+    while( process->windowBase + (s64)process->window.size() <= index ){
+        OpTraceRecord record;
+        if( !process->reader.Read( &record ) ){
+            return NULL;
+        }
+        int pid = process->entryPoint.pid;
+        record.pc = PC( pid, pid, record.pc.address );
+        record.takenPC = PC( pid, pid, record.takenPC.address );
+        record.memAccess.address = Addr( pid, pid, record.memAccess.address.address );
+        process->window.push_back( record );
+    }
+    return &process->window[ (size_t)( index - process->windowBase ) ];
+}
+
+// Release the committed records.
+void TraceEmulator::ReleaseRecords( ProcessTrace* process )
+{
+    while( process->windowBase < process->position && !process->window.empty() ){
+        process->window.pop_front();
+        process->windowBase++;
+    }
+}
+
+// Advance the committed position of 'process' over 'record'.
+void TraceEmulator::Advance( ProcessTrace* process, const OpTraceRecord& record )
+{
+    process->position++;
+    if( record.microOpIndex >= record.microOpNum - 1 ){
+        process->insnPosition++;
+    }
+}
+
+void TraceEmulator::SetRetireIDBase( int pid, u64 retireID )
+{
+    ProcessTrace* process = GetProcess( pid );
+    process->retireIDBase = process->position - (s64)retireID;
+    process->inorderNext  = process->position;
+}
+
+std::pair<OpInfo**, int> TraceEmulator::GetOp( PC pc )
+{
+    ProcessTrace* process = GetProcess( pc.pid );
+    OpInfoMap::iterator i = process->opInfoMap.find( pc.address );
+    if( i == process->opInfoMap.end() ){
+        // This PC is never executed in the trace.
+        return std::pair<OpInfo**, int>( (OpInfo**)NULL, 0 );
+    }
+
+    OpInfoArray& ops = i->second;
+    for( size_t index = 0; index < ops.size(); index++ ){
+        if( !ops[index] ){
+            return std::pair<OpInfo**, int>( (OpInfo**)NULL, 0 );
+        }
+    }
+    return std::pair<OpInfo**, int>( &ops[0], (int)ops.size() );
+}
+
+MemIF* TraceEmulator::GetMemImage()
+{
+    return this;
+}
+
+void TraceEmulator::Execute( OpStateIF* opState, OpInfo* opInfo )
+{
+    TraceOpInfo* traceOpInfo = static_cast<TraceOpInfo*>( opInfo );
+    PC pc = opState->GetPC();
+    ProcessTrace* process = GetProcess( pc.pid );
+    int microOpIndex = traceOpInfo->GetMicroOpIndex();
+
+    const OpTraceRecord* record = NULL;
+    s64 retireID = opState->GetPipelineRetireID();
+    if( retireID >= 0 ){
+        // An op in a simulator is matched by its retire ID.
+        record = GetRecord( process, process->retireIDBase + retireID );
+        if( record && ( record->pc.address != pc.address || record->microOpIndex != microOpIndex ) ){
+            record = NULL;
+        }
+    }
+    else{
+        s64 begin = std::max( process->inorderNext, process->windowBase );
+        for( s64 index = begin; index < begin + IN_ORDER_SEARCH_OPS; index++ ){
+            const OpTraceRecord* candidate = GetRecord( process, index );
+            if( !candidate ){
+                break;
+            }
+            if( candidate->pc.address == pc.address && candidate->microOpIndex == microOpIndex ){
+                record = candidate;
+                process->inorderNext = index + 1;
+                break;
+            }
+        }
+    }
+
+    if( record ){
+        ExecuteRecord( opState, traceOpInfo, *record );
+    }
+    else{
+        ExecuteWrongPath( opState, traceOpInfo );
+    }
+}
+
+void TraceEmulator::ExecuteRecord( OpStateIF* opState, TraceOpInfo* opInfo, const OpTraceRecord& record )
+{
+    PC pc = opState->GetPC();
+
+    for( int i = 0; i < record.dstNum; i++ ){
+        opState->SetDst( i, record.dstValue[i] );
+    }
+
+    opState->SetTaken( record.taken );
+    if( record.taken ){
+        opState->SetTakenPC( PC( pc.pid, pc.tid, record.takenPC.address ) );
+    }
+    else if( opInfo->IsBranchTargetKnown() ){
+        // A not-taken branch is given its target as a live emulator does.
+        opState->SetTakenPC( PC( pc.pid, pc.tid, opInfo->GetBranchTarget() ) );
+    }
+    else{
+        opState->SetTakenPC( PC( pc.pid, pc.tid, pc.address + SimISAInfo::INSTRUCTION_WORD_BYTE_SIZE ) );
+    }
+
+    if( record.memAccessed ){
+        MemAccess access = record.memAccess;
+        access.address.pid = pc.pid;
+        access.address.tid = pc.tid;
+        access.result = MemAccess::MAR_SUCCESS;
+        if( opInfo->GetOpClass().IsLoad() ){
+            // The memory image is filled with the loaded value, so the
+            // load gets the value unless it is forwarded from a store.
+            MemAccess fill = access;
+            Write( &fill );
+            opState->Read( &access );
+        }
+        else{
+            opState->Write( &access );
+        }
+    }
+}
+
+// Execute an op that does not match the trace. The results are dummy
+// because the op is flushed by the recovery of a mispredicted branch.
+void TraceEmulator::ExecuteWrongPath( OpStateIF* opState, TraceOpInfo* opInfo )
+{
+    PC pc = opState->GetPC();
+    const OpClass& opClass = opInfo->GetOpClass();
+
+    for( int i = 0; i < opInfo->GetDstNum(); i++ ){
+        opState->SetDst( i, 0 );
+    }
+
+    bool taken = 
+        opClass.IsBranch() && 
+        !opClass.IsConditionalBranch() && 
+        opInfo->IsBranchTargetKnown();
+    opState->SetTaken( taken );
+    opState->SetTakenPC( 
+        PC( pc.pid, pc.tid, 
+            opInfo->IsBranchTargetKnown() ? 
+                opInfo->GetBranchTarget() : 
+                pc.address + SimISAInfo::INSTRUCTION_WORD_BYTE_SIZE 
+        )
+    );
+
+    if( opClass.IsMem() && opInfo->IsMemAccessKnown() ){
+        MemAccess access;
+        access.address = Addr( pc.pid, pc.tid, opInfo->GetMemAddress() );
+        access.size    = opInfo->GetMemSize();
+        if( opClass.IsLoad() ){
+            opState->Read( &access );
+        }
+        else{
+            opState->Write( &access );
+        }
+    }
+}
+
+void TraceEmulator::Commit( OpStateIF* opState, OpInfo* opInfo )
+{
+    PC pc = opState->GetPC();
+    ProcessTrace* process = GetProcess( pc.pid );
+
+    s64 retireID = opState->GetPipelineRetireID();
+    s64 index = retireID >= 0 ? process->retireIDBase + retireID : process->position;
+
+    const OpTraceRecord* record = GetRecord( process, index );
+    if( !record ){
+        THROW_RUNTIME_ERROR( 
+            "The op trace '%s' ended before the simulation finished. "
+            "Set the number of the simulated instructions within the length of the trace.",
+            process->fileName.c_str()
+        );
+    }
+    if( record->pc.address != pc.address || record->microOpIndex != opInfo->GetMicroOpIndex() ){
+        THROW_RUNTIME_ERROR( 
+            "A committed op '%s' does not match the op trace '%s' (the '%lld'-th op).",
+            opState->GetPC().ToString().c_str(),
+            process->fileName.c_str(),
+            (long long)index
+        );
+    }
+
+    // Ops are committed in order.
+    ASSERT( index == process->position, "An op is committed out of order." );
+    Advance( process, *record );
+    ReleaseRecords( process );
+}
+
+int TraceEmulator::GetProcessCount() const
+{
+    return (int)m_processes.size();
+}
+
+PC TraceEmulator::GetEntryPoint( int pid ) const
+{
+    return GetProcess( pid )->entryPoint;
+}
+
+u64 TraceEmulator::GetInitialRegValue( int pid, int index ) const
+{
+    return GetProcess( pid )->reader.GetHeader().initialRegisterValue[ index ];
+}
+
+ISAInfoIF* TraceEmulator::GetISAInfo()
+{
+    return m_isaInfo;
+}
+
+PC TraceEmulator::Skip( PC pc, u64 skipCount, u64* regArray, u64* executedInsnCount, u64* executedOpCount, SkipObserverIF* observer )
+{
+    ProcessTrace* process = GetProcess( pc.pid );
+
+    u64 insnCount = 0;
+    u64 opCount = 0;
+    while( insnCount < skipCount && pc.address != 0 && !m_reqSkipTermination ){
+        const OpTraceRecord* record = GetRecord( process, process->position );
+        if( !record ){
+            // The end of the trace
+            pc.address = 0;
+            break;
+        }
+
+        for( int i = 0; i < record->dstNum; i++ ){
+            int dst = record->dstOperand[i];
+            if( dst >= 0 ){
+                regArray[dst] = record->dstValue[i];
+            }
+        }
+        if( observer ){
+            OpInfo* opInfo = GetOp( record->pc ).first[ record->microOpIndex ];
+            observer->OnSkippedOp( 
+                PC( pc.pid, pc.tid, record->pc.address ),
+                opInfo,
+                record->taken,
+                PC( pc.pid, pc.tid, record->takenPC.address ),
+                record->memAccessed ? &record->memAccess : NULL
+            );
+        }
+
+        opCount++;
+        if( record->microOpIndex >= record->microOpNum - 1 ){
+            insnCount++;
+            pc.address = record->takenPC.address;
+        }
+        Advance( process, *record );
+        ReleaseRecords( process );
+    }
+
+    process->inorderNext = process->position;
+
+    // Reset a termination request flag
+    m_reqSkipTermination = false;
+
+    if( executedInsnCount )
+        *executedInsnCount = insnCount;
+    if( executedOpCount )
+        *executedOpCount = opCount;
+    return pc;
+}
+
+void TraceEmulator::TerminateSkip()
+{
+    m_reqSkipTermination = true;
+}
+
+void TraceEmulator::SetExtraOpDecoder( ExtraOpDecoderIF* extraOpDecoder )
+{
+    // Ops in traces are already decoded.
+}
+
+void TraceEmulator::SaveProcessState( int pid, CheckpointWriter* writer )
+{
+    ProcessTrace* process = GetProcess( pid );
+    writer->Write( process->position );
+    writer->Write( process->insnPosition );
+}
+
+void TraceEmulator::RestoreProcessState( int pid, CheckpointReader* reader )
+{
+    ProcessTrace* process = GetProcess( pid );
+    process->position     = reader->Read<s64>();
+    process->insnPosition = reader->Read<s64>();
+
+    process->reader.SeekInsn( process->insnPosition );
+    process->window.clear();
+    process->windowBase  = process->position;
+    process->inorderNext = process->position;
+}
+
+void TraceEmulator::ReopenHostFiles()
+{
+    for( size_t pid = 0; pid < m_processes.size(); pid++ ){
+        m_processes[pid]->reader.Reopen();
+    }
+}
+
+// The memory image is a sparse set of pages, which holds the values that 
+// are loaded in the traces or stored by the simulated ops.
+u8* TraceEmulator::GetMemByte( const Addr& addr )
+{
+    const u64 pageSize = (u64)1 << MEM_PAGE_BITS;
+    u64 key = ( addr.address >> MEM_PAGE_BITS ) ^ ( (u64)addr.pid << ( 64 - 8 ) );
+    vector<u8>& page = m_memPages[ key ];
+    if( page.empty() ){
+        page.resize( pageSize, 0 );
+    }
+    return &page[ addr.address & ( pageSize - 1 ) ];
+}
+
+void TraceEmulator::Read( MemAccess* access )
+{
+    bool littleEndian = m_isaInfo->IsLittleEndian();
+    u64 value = 0;
+    for( int i = 0; i < access->size; i++ ){
+        Addr addr = access->address;
+        addr.address += i;
+        int shift = littleEndian ? i*8 : ( access->size - 1 - i )*8;
+        value |= (u64)*GetMemByte( addr ) << shift;
+    }
+    access->value  = value;
+    access->result = MemAccess::MAR_SUCCESS;
+}
+
+void TraceEmulator::Write( MemAccess* access )
+{
+    bool littleEndian = m_isaInfo->IsLittleEndian();
+    for( int i = 0; i < access->size; i++ ){
+        Addr addr = access->address;
+        addr.address += i;
+        int shift = littleEndian ? i*8 : ( access->size - 1 - i )*8;
+        *GetMemByte( addr ) = (u8)( access->value >> shift );
+    }
+    access->result = MemAccess::MAR_SUCCESS;
+}
@@ -0,0 +1,189 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+//
+// An emulator that replays op traces instead of executing target programs.
+//
+// Op traces are written by EmulationTraceSystem in the 'Binary' format
+// (see OpTrace.h). Each trace file is treated as one process.
+//
+// When a trace is opened, it is scanned once for building a static op table
+// that maps a PC to OpInfo, which is returned by GetOp() to a fetcher.
+// In execution, an op in a simulator is matched with a trace record by
+// its retire ID, and its results (destination values, branch outcomes and
+// memory accesses) are taken from the record. An op that does not match
+// its record is on a wrong path and is executed with dummy results.
+// Other ops such as ones in a forward emulator are matched with trace
+// records in program order.
+//
+// A memory image is filled with the values of loads in the traces, and
+// system calls are not emulated at all.
+//
+
+#ifndef SIM_SYSTEM_TRACE_EMULATOR_TRACE_EMULATOR_H
+#define SIM_SYSTEM_TRACE_EMULATOR_TRACE_EMULATOR_H
+
+#include "Interface/EmulatorIF.h"
+#include "Interface/OpClass.h"
+#include "Sim/System/EmulationTraceSystem/OpTrace.h"
+
+namespace Onikiri
+{
+    // Static information of an op in a trace.
+    class TraceOpInfo : public OpInfo
+    {
+    public:
+        TraceOpInfo( const OpTraceRecord& record );
+
+        // Update information observed in a record of this op.
+        void Observe( const OpTraceRecord& record );
+
+        // A branch target and a memory access observed last, which are 
+        // used for executing this op on a wrong path.
+        bool IsBranchTargetKnown() const { return m_branchTargetKnown; }
+        u64  GetBranchTarget() const     { return m_branchTarget; }
+        bool IsMemAccessKnown() const    { return m_memAccessKnown; }
+        u64  GetMemAddress() const       { return m_memAddress; }
+        int  GetMemSize() const          { return m_memSize; }
+
+        // OpInfo
+        virtual const OpClass& GetOpClass() const       { return m_opClass; }
+        virtual int GetSrcOperand(const int index) const { return m_srcOperand[index]; }
+        virtual int GetDstOperand(const int index) const { return m_dstOperand[index]; }
+        virtual int GetSrcNum() const       { return m_srcNum; }
+        virtual int GetDstNum() const       { return m_dstNum; }
+        virtual int GetMicroOpNum() const   { return m_microOpNum; }
+        virtual int GetMicroOpIndex() const { return m_microOpIndex; }
+        virtual const char* GetMnemonic() const;
+
+    protected:
+        OpClass m_opClass;
+        int m_srcNum;
+        int m_dstNum;
+        int m_srcOperand[ SimISAInfo::MAX_SRC_REG_COUNT ];
+        int m_dstOperand[ SimISAInfo::MAX_DST_REG_COUNT ];
+        int m_microOpNum;
+        int m_microOpIndex;
+
+        bool m_branchTargetKnown;
+        u64  m_branchTarget;
+        bool m_memAccessKnown;
+        u64  m_memAddress;
+        int  m_memSize;
+    };
+
+    class TraceEmulator : 
+        public EmulatorIF,
+        public MemIF
+    {
+    public:
+        // 'traceFiles' are the op trace files of the processes.
+        TraceEmulator( const String& targetArchitecture, const std::vector<String>& traceFiles );
+        virtual ~TraceEmulator();
+
+        // Set the retire ID of an op that is fetched next in 'pid' by a 
+        // simulator. This must be called when the simulator starts at
+        // the current position of the trace of 'pid'.
+        void SetRetireIDBase( int pid, u64 retireID );
+
+        // EmulatorIF
+        virtual std::pair<OpInfo**, int> GetOp(PC pc);
+        virtual MemIF* GetMemImage();
+        virtual void Execute(OpStateIF* opStateIF, OpInfo* opInfo);
+        virtual void Commit(OpStateIF* opStateIF, OpInfo* opInfo);
+        virtual int GetProcessCount() const;
+        virtual PC GetEntryPoint(int pid) const;
+        virtual u64 GetInitialRegValue(int pid, int index) const;
+        virtual ISAInfoIF* GetISAInfo();
+        virtual PC Skip(PC pc, u64 skipCount, u64* regArray, u64* executedInsnCount, u64* executedOpCount, SkipObserverIF* observer);
+        virtual void TerminateSkip();
+        virtual void SetExtraOpDecoder( ExtraOpDecoderIF* extraOpDecoder );
+        virtual void SaveProcessState( int pid, CheckpointWriter* writer );
+        virtual void RestoreProcessState( int pid, CheckpointReader* reader );
+        virtual void ReopenHostFiles();
+
+        // MemIF
+        virtual void Read( MemAccess* access );
+        virtual void Write( MemAccess* access );
+
+    protected:
+        // In-order ops are searched for in this number of next records,
+        // because a forward emulator does not execute system calls.
+        static const int IN_ORDER_SEARCH_OPS = 16;
+
+        static const int MEM_PAGE_BITS = 12;
+
+        typedef std::vector<OpInfo*> OpInfoArray;
+        typedef unordered_map< u64, OpInfoArray > OpInfoMap;
+
+        struct ProcessTrace
+        {
+            String fileName;
+            OpTraceReader reader;
+            PC  entryPoint;
+            s64 opCount;
+            OpInfoMap opInfoMap;
+
+            // Records from 'windowBase' are held in 'window'.
+            std::deque<OpTraceRecord> window;
+            s64 windowBase;
+
+            s64 position;       // The index of a next record to commit
+            s64 insnPosition;   // The index of the instruction of 'position'
+            s64 inorderNext;    // The index of a next record to execute in order
+            s64 retireIDBase;   // The index of a record whose retire ID is 0
+        };
+
+        ISAInfoIF* m_isaInfo;
+        std::vector< boost::shared_ptr<ProcessTrace> > m_processes;
+        boost::object_pool<TraceOpInfo> m_opInfoPool;
+        unordered_map< u64, std::vector<u8> > m_memPages;
+        bool m_reqSkipTermination;
+
+        void OpenTrace( int pid, const String& fileName, const String& targetArchitecture );
+        ProcessTrace* GetProcess( int pid ) const;
+
+        // Get the 'index'-th record of 'process'. Returns NULL if the record
+        // is beyond the end of the trace or has been already released.
+        const OpTraceRecord* GetRecord( ProcessTrace* process, s64 index );
+        void ReleaseRecords( ProcessTrace* process );
+        void Advance( ProcessTrace* process, const OpTraceRecord& record );
+
+        void ExecuteRecord( OpStateIF* opState, TraceOpInfo* opInfo, const OpTraceRecord& record );
+        void ExecuteWrongPath( OpStateIF* opState, TraceOpInfo* opInfo );
+
+        u8* GetMemByte( const Addr& addr );
+    };
+
+}   // namespace Onikiri
+
+#endif // SIM_SYSTEM_TRACE_EMULATOR_TRACE_EMULATOR_H
+
@@ -39,10 +39,18 @@
 
 #include "SysDeps/host_type.h"
 
-#define BOOST_NO_MT
-#define BOOST_DISABLE_THREADS
+// Thread support of the boost pools and smart pointers is disabled for 
+// performance unless the parallel simulation engine is enabled.
+// ONIKIRI_PARALLEL_SIMULATION must be defined with a compiler flag for
+// running simulation on multiple host threads (see SimulationSystem).
+#ifndef ONIKIRI_PARALLEL_SIMULATION
+#   define BOOST_NO_MT
+#   define BOOST_DISABLE_THREADS
+#   define BOOST_SP_DISABLE_THREADS
+#elif defined ONIKIRI_USE_ONIKIRI_POOL_ALLOCATOR
+#   error "ONIKIRI_USE_ONIKIRI_POOL_ALLOCATOR is not thread safe and cannot be used with ONIKIRI_PARALLEL_SIMULATION."
+#endif
 #define BOOST_SP_USE_QUICK_ALLOCATOR
-#define BOOST_SP_DISABLE_THREADS
 #define BOOST_ALL_NO_LIB
 #define BOOST_SYSTEM_NO_LIB
 #define NO_ZLIB 0
@@ -114,6 +122,9 @@
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
 
 #include <boost/crc.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
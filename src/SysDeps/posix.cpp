@@ -112,6 +112,10 @@ namespace Onikiri {
         {
             return check_error<int, -1>( _dup(fd) );
         }
+        int posix_dup2(int fd, int fd2)
+        {
+            return check_error<int, -1>( _dup2(fd, fd2) ) == -1 ? -1 : fd2;
+        }
 
 
         int posix_fstat(int fd, posix_struct_stat* s)
@@ -181,6 +185,24 @@ namespace Onikiri {
                 return 0;
             }
         }
+
+        int posix_getpagesize()
+        {
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return (int)info.dwAllocationGranularity;
+        }
+        void* posix_mmap_private(int fd, s64 offset, size_t length)
+        {
+            // Not supported. A caller falls back to reading a file.
+            posix_errno = ENOSYS;
+            return NULL;
+        }
+        int posix_munmap(void* addr, size_t length)
+        {
+            posix_errno = EINVAL;
+            return -1;
+        }
     }
 }
 
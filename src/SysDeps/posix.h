@@ -124,6 +124,7 @@ namespace Onikiri {
         int posix_close(int fd);
         s64 posix_lseek(int fd, s64 offset, int whence);
         int posix_dup(int fd);
+        int posix_dup2(int fd, int fd2);
 
         int posix_stat(const char* path, posix_struct_stat* s);
         int posix_fstat(int fd, posix_struct_stat* s);
@@ -136,6 +137,11 @@ namespace Onikiri {
 
         int posix_truncate(const char* path, s64 length);
         int posix_ftruncate(int fd, s64 length);
+
+        // Windows では未実装．posix_mmap_private は常に NULL を返す．
+        int posix_getpagesize();
+        void* posix_mmap_private(int fd, s64 offset, size_t length);
+        int posix_munmap(void* addr, size_t length);
     }
 }
 #elif defined(HOST_IS_CYGWIN) || defined(HOST_IS_LINUX)
@@ -201,6 +207,8 @@ namespace Onikiri {
             { return close(fd); }
         inline int posix_dup(int fd)
             { return dup(fd); }
+        inline int posix_dup2(int fd, int fd2)
+            { return dup2(fd, fd2); }
 
         // <TODO> 本当は，off_tのサイズ・lseek64のサポートをチェックする．
 #if defined(HOST_IS_CYGWIN)
@@ -232,6 +240,19 @@ namespace Onikiri {
             { return truncate(path, length); }
         inline int posix_ftruncate(int fd, s64 length)
             { return ftruncate(fd, length); }
+
+        inline int posix_getpagesize()
+            { return (int)sysconf(_SC_PAGESIZE); }
+        // Map [offset, offset+length) of a file read-only and privately.
+        // 'offset' must be a multiple of posix_getpagesize().
+        // NULL is returned if the file cannot be mapped.
+        inline void* posix_mmap_private(int fd, s64 offset, size_t length)
+        {
+            void* addr = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, (off_t)offset);
+            return addr == MAP_FAILED ? NULL : addr;
+        }
+        inline int posix_munmap(void* addr, size_t length)
+            { return munmap(addr, length); }
     }
 }
 #endif
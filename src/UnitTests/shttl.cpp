@@ -215,6 +215,15 @@ namespace Onikiri
                     table( static_off_hasher< u64, 0 >(0), 8 );
                 TableTest( table, "Set associative table(full associative) test failed." );
             }
+
+            // More ways than bits in a valid mask.
+            {
+                setassoc_table< 
+                    std::pair<u64, u64>, std_hasher< u64 >, lru<u64>, 
+                    setassoc_table_strage_soa< setassoc_table_line_base< std::pair<u64, u64> > >
+                > table( std_hasher< u64 >(0, 0), 72 );
+                TableTest( table, "Set associative table(full associative, SoA strage) test failed." );
+            }
         }
 
         ONIKIRI_TEST_METHOD(SHTTL_DirectMapTable)
@@ -265,6 +274,14 @@ namespace Onikiri
                 TableTest( table, "Set associative table test failed." );
             }
 
+            {
+                setassoc_table< 
+                    std::pair<KeyType, u64>, std_hasher< KeyType >, lru<u64>, 
+                    setassoc_table_strage_soa< setassoc_table_line_base< std::pair<KeyType, u64> > >
+                > table( std_hasher< KeyType >(5, 6), 8 );
+                TableTest( table, "Set associative table(SoA strage) test failed." );
+            }
+
             // Iterator set test
             {
                 const int ways = 8;
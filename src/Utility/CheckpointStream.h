@@ -0,0 +1,142 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+//
+// Binary stream for checkpoint files
+//
+
+#ifndef UTILITY_CHECKPOINT_STREAM_H
+#define UTILITY_CHECKPOINT_STREAM_H
+
+#include <iostream>
+#include <vector>
+#include "Utility/String.h"
+#include "Utility/RuntimeError.h"
+
+namespace Onikiri
+{
+    // Values are written in the host byte order, so a checkpoint file can be
+    // restored only on a host with the same endianness.
+    class CheckpointWriter
+    {
+    public:
+        explicit CheckpointWriter( std::ostream* stream ) : m_stream( stream )
+        {
+        }
+
+        void WriteBytes( const void* data, size_t size )
+        {
+            m_stream->write( static_cast<const char*>( data ), (std::streamsize)size );
+            if( !*m_stream ){
+                THROW_RUNTIME_ERROR( "Writing a checkpoint failed." );
+            }
+        }
+
+        // 'T' must be a type that can be copied by memcpy.
+        template <typename T>
+        void Write( const T& value )
+        {
+            WriteBytes( &value, sizeof(T) );
+        }
+
+        void WriteString( const std::string& str )
+        {
+            Write( (u64)str.size() );
+            WriteBytes( str.data(), str.size() );
+        }
+
+        template <typename T>
+        void WriteVector( const std::vector<T>& vec )
+        {
+            Write( (u64)vec.size() );
+            if( !vec.empty() ){
+                WriteBytes( &vec[0], sizeof(T) * vec.size() );
+            }
+        }
+
+    protected:
+        std::ostream* m_stream;
+    };
+
+    class CheckpointReader
+    {
+    public:
+        explicit CheckpointReader( std::istream* stream ) : m_stream( stream )
+        {
+        }
+
+        void ReadBytes( void* data, size_t size )
+        {
+            m_stream->read( static_cast<char*>( data ), (std::streamsize)size );
+            if( !*m_stream ){
+                THROW_RUNTIME_ERROR( "A checkpoint file is broken or truncated." );
+            }
+        }
+
+        template <typename T>
+        T Read()
+        {
+            T value;
+            ReadBytes( &value, sizeof(T) );
+            return value;
+        }
+
+        template <typename T>
+        void Read( T* value )
+        {
+            ReadBytes( value, sizeof(T) );
+        }
+
+        String ReadString()
+        {
+            std::vector<char> buf( (size_t)Read<u64>() );
+            if( !buf.empty() ){
+                ReadBytes( &buf[0], buf.size() );
+            }
+            return String( std::string( buf.begin(), buf.end() ) );
+        }
+
+        template <typename T>
+        void ReadVector( std::vector<T>* vec )
+        {
+            vec->resize( (size_t)Read<u64>() );
+            if( !vec->empty() ){
+                ReadBytes( &(*vec)[0], sizeof(T) * vec->size() );
+            }
+        }
+
+    protected:
+        std::istream* m_stream;
+    };
+
+}   // namespace Onikiri
+
+#endif // #ifndef UTILITY_CHECKPOINT_STREAM_H
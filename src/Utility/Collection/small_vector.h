@@ -0,0 +1,148 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+
+
+#ifndef UTILITY_COLLECTION_SMALL_VECTOR_H
+#define UTILITY_COLLECTION_SMALL_VECTOR_H
+
+namespace Onikiri
+{
+    // A vector that holds up to INLINE_SIZE elements in itself.
+    // When the number of elements exceeds INLINE_SIZE, the elements are 
+    // moved to a buffer allocated in a heap.
+    // 'T' must be default constructible and assignable.
+    template < typename T, size_t INLINE_SIZE >
+    class small_vector
+    {
+    public:
+        typedef T*          iterator;
+        typedef const T*    const_iterator;
+        typedef T&          reference;
+        typedef const T&    const_reference;
+        typedef size_t      size_type;
+
+        small_vector() : 
+            m_begin( m_inline ),
+            m_size( 0 ),
+            m_capacity( INLINE_SIZE )
+        {
+        }
+
+        small_vector( const small_vector& rhs ) : 
+            m_begin( m_inline ),
+            m_size( 0 ),
+            m_capacity( INLINE_SIZE )
+        {
+            *this = rhs;
+        }
+
+        small_vector& operator= ( const small_vector& rhs )
+        {
+            if( this != &rhs ){
+                m_size = 0;
+                reserve( rhs.size() );
+                std::copy( rhs.begin(), rhs.end(), m_begin );
+                m_size = rhs.size();
+            }
+            return *this;
+        }
+
+        ~small_vector()
+        {
+            if( m_begin != m_inline ){
+                delete[] m_begin;
+            }
+        }
+
+        iterator begin()                { return m_begin;           }
+        iterator end()                  { return m_begin + m_size;  }
+        const_iterator begin() const    { return m_begin;           }
+        const_iterator end()   const    { return m_begin + m_size;  }
+
+        size_type size() const  { return m_size;       }
+        bool empty() const      { return m_size == 0;   }
+
+        reference front()               { return m_begin[0]; }
+        const_reference front() const   { return m_begin[0]; }
+        reference back()                { return m_begin[m_size - 1]; }
+        const_reference back() const    { return m_begin[m_size - 1]; }
+
+        reference operator[]( size_type i )             { return m_begin[i]; }
+        const_reference operator[]( size_type i ) const { return m_begin[i]; }
+
+        void push_back( const T& value )
+        {
+            if( m_size == m_capacity ){
+                reserve( m_capacity * 2 );
+            }
+            m_begin[ m_size ] = value;
+            m_size++;
+        }
+
+        // The order of the remaining elements is preserved.
+        iterator erase( iterator where )
+        {
+            std::copy( where + 1, end(), where );
+            m_size--;
+            return where;
+        }
+
+        // A heap buffer is not released for reuse.
+        void clear()
+        {
+            m_size = 0;
+        }
+
+        void reserve( size_type capacity )
+        {
+            if( capacity <= m_capacity ){
+                return;
+            }
+
+            T* buffer = new T[ capacity ];
+            std::copy( begin(), end(), buffer );
+            if( m_begin != m_inline ){
+                delete[] m_begin;
+            }
+            m_begin = buffer;
+            m_capacity = capacity;
+        }
+
+    protected:
+        T  m_inline[ INLINE_SIZE ];
+        T* m_begin;
+        size_type m_size;
+        size_type m_capacity;
+    };
+}
+
+#endif
@@ -0,0 +1,155 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+#include <pch.h>
+#include "Utility/HostThreadPool.h"
+
+using namespace std;
+using namespace Onikiri;
+
+// The number of polling iterations before a worker thread sleeps.
+// A worker yields in each iteration so that it does not occupy a host core
+// when there are fewer host cores than threads.
+static const int HOST_THREAD_POOL_SPIN_COUNT = 1024;
+
+HostThreadPool::HostThreadPool() :
+    m_generation( 0 ),
+    m_runningWorkers( 0 ),
+    m_exit( false ),
+    m_task( NULL ),
+    m_taskCount( 0 )
+{
+}
+
+HostThreadPool::~HostThreadPool()
+{
+    Stop();
+}
+
+void HostThreadPool::Start( int threads )
+{
+    Stop();
+    m_exit = false;
+    unsigned generation = m_generation.load();
+    for( int i = 1; i < threads; i++ ){
+        m_workers.push_back( thread( &HostThreadPool::WorkerMain, this, i, generation ) );
+    }
+}
+
+void HostThreadPool::Stop()
+{
+    if( m_workers.empty() ){
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock( m_mutex );
+        m_exit = true;
+    }
+    m_wakeUp.notify_all();
+
+    for( size_t i = 0; i < m_workers.size(); i++ ){
+        m_workers[i].join();
+    }
+    m_workers.clear();
+}
+
+void HostThreadPool::Run( const Task& task, int count )
+{
+    m_task = &task;
+    m_taskCount = count;
+    m_exception = exception_ptr();
+    m_runningWorkers = (int)m_workers.size();
+
+    {
+        lock_guard<mutex> lock( m_mutex );
+        ++m_generation;
+    }
+    m_wakeUp.notify_all();
+
+    RunTasks( 0 );
+
+    while( m_runningWorkers.load() != 0 ){
+        this_thread::yield();
+    }
+
+    m_task = NULL;
+    if( m_exception ){
+        rethrow_exception( m_exception );
+    }
+}
+
+// 'generation' is passed from Start() because Run() may be called 
+// before this thread starts.
+void HostThreadPool::WorkerMain( int index, unsigned generation )
+{
+    while( true ){
+
+        for( int i = 0; i < HOST_THREAD_POOL_SPIN_COUNT; i++ ){
+            if( m_generation.load() != generation || m_exit.load() ){
+                break;
+            }
+            this_thread::yield();
+        }
+
+        {
+            unique_lock<mutex> lock( m_mutex );
+            while( m_generation.load() == generation && !m_exit.load() ){
+                m_wakeUp.wait( lock );
+            }
+        }
+
+        if( m_exit.load() ){
+            return;
+        }
+
+        generation = m_generation.load();
+        RunTasks( index );
+        --m_runningWorkers;
+    }
+}
+
+void HostThreadPool::RunTasks( int index )
+{
+    int threads = GetThreadCount();
+    for( int i = index; i < m_taskCount; i += threads ){
+        try{
+            (*m_task)( i );
+        }
+        catch( ... ){
+            lock_guard<mutex> lock( m_exceptionMutex );
+            if( !m_exception ){
+                m_exception = current_exception();
+            }
+        }
+    }
+}
+
@@ -0,0 +1,95 @@
+// 
+// Copyright (c) 2005-2008 Kenichi Watanabe.
+// Copyright (c) 2005-2008 Yasuhiro Watari.
+// Copyright (c) 2005-2008 Hironori Ichibayashi.
+// Copyright (c) 2008-2009 Kazuo Horio.
+// Copyright (c) 2009-2015 Naruki Kurata.
+// Copyright (c) 2005-2015 Ryota Shioya.
+// Copyright (c) 2005-2015 Masahiro Goshima.
+// 
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// 
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 
+// 1. The origin of this software must not be misrepresented; you must not
+// claim that you wrote the original software. If you use this software
+// in a product, an acknowledgment in the product documentation would be
+// appreciated but is not required.
+// 
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+// 
+// 3. This notice may not be removed or altered from any source
+// distribution.
+// 
+// 
+
+
+//
+// A fixed size pool of host threads
+//
+
+#ifndef UTILITY_HOST_THREAD_POOL_H
+#define UTILITY_HOST_THREAD_POOL_H
+
+#include <vector>
+#include <functional>
+#include <exception>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace Onikiri
+{
+    // Runs a batch of tasks on host threads and waits for all of them.
+    // The pool is used for running simulation partitions every cycle, so 
+    // the workers spin for a while before sleeping to keep the cost of
+    // the barrier low. Tasks are statically assigned to threads, so a task
+    // with the same index always runs on the same host thread.
+    class HostThreadPool
+    {
+    public:
+        typedef std::function< void (int) > Task;
+
+        HostThreadPool();
+        ~HostThreadPool();
+
+        // Starts 'threads - 1' worker threads. The calling thread is also 
+        // used for running tasks.
+        void Start( int threads );
+        void Stop();
+
+        int GetThreadCount() const { return (int)m_workers.size() + 1; }
+
+        // Calls task( 0 ) ... task( count - 1 ) and returns after all the 
+        // calls finish. An exception thrown in a task is re-thrown here.
+        void Run( const Task& task, int count );
+
+    private:
+        std::vector< std::thread > m_workers;
+
+        std::mutex m_mutex;
+        std::condition_variable m_wakeUp;
+        std::atomic<unsigned> m_generation;
+        std::atomic<int>  m_runningWorkers;
+        std::atomic<bool> m_exit;
+
+        const Task* m_task;
+        int m_taskCount;
+
+        std::mutex m_exceptionMutex;
+        std::exception_ptr m_exception;
+
+        void WorkerMain( int index, unsigned generation );
+        void RunTasks( int index );
+    };
+
+}; // namespace Onikiri
+
+#endif // UTILITY_HOST_THREAD_POOL_H
+
@@ -89,6 +89,10 @@
 #include <limits>
 #include <iomanip>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 
 //
@@ -126,6 +130,7 @@
 #include "Utility/Collection/pool/pool_vector.h"
 #include "Utility/Collection/pool/pool_unordered_map.h"
 #include "Utility/Collection/fixed_size_buffer.h"
+#include "Utility/Collection/small_vector.h"
 
 
 